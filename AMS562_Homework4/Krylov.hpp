@@ -0,0 +1,258 @@
+#ifndef KRYLOV_HPP
+#define KRYLOV_HPP
+
+#include "Vector.hpp"
+#include <vector>
+#include <memory_resource>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @file Krylov.hpp
+ * @brief Matrix-free Krylov solvers (BiCGSTAB and restarted GMRES) for A x = b.
+ *
+ * The operator A is any callable `op(x, y)` that writes y = A x into an existing
+ * vector, so the solvers work with `Matrix<T>` or with any other mat-vec. Both
+ * solvers use right preconditioning with an optional diagonal (Jacobi) scaling,
+ * so the residual they monitor is the true residual ||b - A x||_2. All workspace,
+ * including the small dense GMRES arrays, comes from the allocator of the solution x.
+ */
+
+/**
+ * @brief Krylov method used by `pageRankKrylov()`.
+ */
+enum class KrylovMethod {
+    BiCGSTAB, ///< Stabilized bi-conjugate gradients: short recurrences, two mat-vecs per iteration.
+    GMRES     ///< Restarted GMRES(m): one mat-vec per iteration, monotone residual.
+};
+
+/**
+ * @brief Preconditioner used by `pageRankKrylov()`.
+ */
+enum class Preconditioner {
+    None,  ///< No preconditioning.
+    Jacobi ///< Scaling by the inverse of the diagonal of A.
+};
+
+/**
+ * @struct KrylovResult
+ * @brief Convergence information returned by the Krylov solvers.
+ * @tparam T The numeric type.
+ */
+template<typename T>
+struct KrylovResult {
+    size_t iterations = 0;  ///< Number of mat-vecs with A that were performed.
+    T residual = T(0);      ///< Final relative residual ||b - A x||_2 / ||b||_2.
+    bool converged = false; ///< Whether the residual dropped below the tolerance.
+};
+
+/**
+ * @brief Applies a diagonal preconditioner, y = D^{-1} x (or a copy when no diagonal is given).
+ * @tparam T The numeric type.
+ * @param inverseDiagonal The inverse diagonal, or nullptr for the identity.
+ * @param x The input vector.
+ * @param y The output vector.
+ */
+template<typename T>
+void applyPreconditioner(const Vector<T>* inverseDiagonal, const Vector<T>& x, Vector<T>& y) {
+    const T* in = x.getData();
+    T* out = y.getData();
+    if (inverseDiagonal == nullptr) {
+        for (size_t i = 0; i < x.getSize(); ++i) {
+            out[i] = in[i];
+        }
+    } else {
+        const T* d = inverseDiagonal->getData();
+        for (size_t i = 0; i < x.getSize(); ++i) {
+            out[i] = d[i] * in[i];
+        }
+    }
+}
+
+/**
+ * @brief Solves A x = b with right-preconditioned BiCGSTAB.
+ * @tparam T The numeric type.
+ * @tparam Operator Callable `void(const Vector<T>& x, Vector<T>& y)` computing y = A x.
+ * @param op The operator A.
+ * @param b The right-hand side.
+ * @param x The initial guess on input, the solution on output.
+ * @param inverseDiagonal Inverse of the Jacobi preconditioner diagonal, or nullptr.
+ * @param tolerance Relative residual at which to stop.
+ * @param maxIterations Maximum number of mat-vecs.
+ * @return The convergence information.
+ */
+template<typename T, typename Operator>
+KrylovResult<T> bicgstab(const Operator& op, const Vector<T>& b, Vector<T>& x,
+                         const Vector<T>* inverseDiagonal, T tolerance, size_t maxIterations) {
+    const size_t N = b.getSize();
+    const auto alloc = x.getAllocator();
+    KrylovResult<T> result;
+    const T bNorm = std::sqrt(dot_product(b, b));
+    if (bNorm == T(0)) {
+        x = Vector<T>(N, T(0), alloc);
+        result.converged = true;
+        return result;
+    }
+
+    Vector<T> r(N, alloc), rHat(N, alloc), p(N, T(0), alloc), v(N, T(0), alloc);
+    Vector<T> pHat(N, alloc), s(N, alloc), sHat(N, alloc), t(N, alloc);
+
+    // r = b - A x
+    op(x, r);
+    r.axpby(T(1), b, T(-1));
+    ++result.iterations;
+    rHat = r;
+
+    T rho = 1, alpha = 1, omega = 1;
+    result.residual = std::sqrt(dot_product(r, r)) / bNorm;
+    while (result.residual >= tolerance && result.iterations < maxIterations) {
+        T rhoNew = dot_product(rHat, r);
+        if (rhoNew == T(0)) break;  // breakdown
+        T beta = (rhoNew / rho) * (alpha / omega);
+
+        // p = r + beta * (p - omega * v)
+        p.axpy(-omega, v);
+        p.axpby(T(1), r, beta);
+        applyPreconditioner(inverseDiagonal, p, pHat);
+        op(pHat, v);
+        ++result.iterations;
+        alpha = rhoNew / dot_product(rHat, v);
+
+        // s = r - alpha * v
+        s = r;
+        s.axpy(-alpha, v);
+        T sNorm = std::sqrt(dot_product(s, s)) / bNorm;
+        if (sNorm < tolerance) {
+            x.axpy(alpha, pHat);
+            result.residual = sNorm;
+            break;
+        }
+
+        applyPreconditioner(inverseDiagonal, s, sHat);
+        op(sHat, t);
+        ++result.iterations;
+        T tt = dot_product(t, t);
+        if (tt == T(0)) break;  // breakdown
+        omega = dot_product(t, s) / tt;
+
+        x.axpy(alpha, pHat);
+        x.axpy(omega, sHat);
+        // r = s - omega * t
+        r.swap(s);
+        r.axpy(-omega, t);
+        result.residual = std::sqrt(dot_product(r, r)) / bNorm;
+        rho = rhoNew;
+        if (omega == T(0)) break;  // breakdown
+    }
+    result.converged = result.residual < tolerance;
+    return result;
+}
+
+/**
+ * @brief Solves A x = b with right-preconditioned, restarted GMRES(m).
+ * @tparam T The numeric type.
+ * @tparam Operator Callable `void(const Vector<T>& x, Vector<T>& y)` computing y = A x.
+ * @param op The operator A.
+ * @param b The right-hand side.
+ * @param x The initial guess on input, the solution on output.
+ * @param inverseDiagonal Inverse of the Jacobi preconditioner diagonal, or nullptr.
+ * @param tolerance Relative residual at which to stop.
+ * @param maxIterations Maximum number of mat-vecs.
+ * @param restart Krylov subspace dimension m before restarting.
+ * @return The convergence information.
+ */
+template<typename T, typename Operator>
+KrylovResult<T> gmres(const Operator& op, const Vector<T>& b, Vector<T>& x,
+                      const Vector<T>* inverseDiagonal, T tolerance, size_t maxIterations,
+                      size_t restart = 30) {
+    const size_t N = b.getSize();
+    const auto alloc = x.getAllocator();
+    KrylovResult<T> result;
+    const T bNorm = std::sqrt(dot_product(b, b));
+    if (bNorm == T(0)) {
+        x = Vector<T>(N, T(0), alloc);
+        result.converged = true;
+        return result;
+    }
+    if (restart == 0) restart = 1;
+
+    // The basis vectors get alloc through uses-allocator construction
+    std::pmr::vector<Vector<T>> V(alloc);
+    V.reserve(restart + 1);
+    for (size_t i = 0; i <= restart; ++i) {
+        V.emplace_back(N);
+    }
+    std::pmr::vector<std::pmr::vector<T>> H(restart + 1, std::pmr::vector<T>(restart, T(0), alloc), alloc);
+    std::pmr::vector<T> cs(restart, alloc), sn(restart, alloc), g(restart + 1, alloc), y(restart, alloc);
+    Vector<T> w(N, alloc), z(N, alloc);
+
+    while (result.iterations < maxIterations) {
+        // r = b - A x, first basis vector r / ||r||
+        op(x, V[0]);
+        V[0].axpby(T(1), b, T(-1));
+        ++result.iterations;
+        T beta = std::sqrt(dot_product(V[0], V[0]));
+        result.residual = beta / bNorm;
+        if (result.residual < tolerance) break;
+        V[0] *= T(1) / beta;
+        std::fill(g.begin(), g.end(), T(0));
+        g[0] = beta;
+
+        size_t k = 0;
+        while (k < restart && result.iterations < maxIterations) {
+            applyPreconditioner(inverseDiagonal, V[k], z);
+            op(z, w);
+            ++result.iterations;
+
+            // Modified Gram-Schmidt against the current basis
+            for (size_t i = 0; i <= k; ++i) {
+                H[i][k] = dot_product(w, V[i]);
+                w.axpy(-H[i][k], V[i]);
+            }
+            H[k + 1][k] = std::sqrt(dot_product(w, w));
+            if (H[k + 1][k] != T(0)) {
+                V[k + 1] = w;
+                V[k + 1] *= T(1) / H[k + 1][k];
+            }
+
+            // Apply the previous Givens rotations, then annihilate H[k + 1][k]
+            for (size_t i = 0; i < k; ++i) {
+                T temp = cs[i] * H[i][k] + sn[i] * H[i + 1][k];
+                H[i + 1][k] = -sn[i] * H[i][k] + cs[i] * H[i + 1][k];
+                H[i][k] = temp;
+            }
+            T denom = std::hypot(H[k][k], H[k + 1][k]);
+            cs[k] = H[k][k] / denom;
+            sn[k] = H[k + 1][k] / denom;
+            H[k][k] = denom;
+            H[k + 1][k] = T(0);
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+
+            ++k;
+            result.residual = std::abs(g[k]) / bNorm;
+            if (result.residual < tolerance) break;
+        }
+
+        // Solve the triangular least-squares system and update x += M^{-1} V y
+        for (size_t i = k; i-- > 0;) {
+            T sum = g[i];
+            for (size_t j = i + 1; j < k; ++j) {
+                sum -= H[i][j] * y[j];
+            }
+            y[i] = sum / H[i][i];
+        }
+        w *= T(0);
+        for (size_t i = 0; i < k; ++i) {
+            w.axpy(y[i], V[i]);
+        }
+        applyPreconditioner(inverseDiagonal, w, z);
+        x += z;
+
+        if (result.residual < tolerance) break;
+    }
+    result.converged = result.residual < tolerance;
+    return result;
+}
+
+#endif // KRYLOV_HPP
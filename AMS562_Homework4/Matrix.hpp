@@ -3,18 +3,27 @@
 
 #include "Vector.hpp"
 #include <vector>
+#include <memory_resource>
 #include <numeric>
 #include <stdexcept>
 
 /**
  * @class Matrix
  * @brief A templated class for representing a square matrix.
+ *
+ * Like `Vector<T>`, the rows are stored through a `std::pmr::polymorphic_allocator`
+ * so the whole matrix can live in a caller-supplied `std::pmr::memory_resource`.
+ *
  * @tparam T The numeric type of the matrix's elements (e.g., float, double).
  */
 template<typename T>
 class Matrix {
+public:
+    /// Allocator used for the row storage (propagated to every row).
+    using allocator_type = std::pmr::polymorphic_allocator<T>;
+
 private:
-    std::vector<std::vector<T>> matrix;
+    std::pmr::vector<std::pmr::vector<T>> matrix;
     size_t size;
 
 public:
@@ -22,21 +31,40 @@ public:
      * @brief Constructs a square matrix of a given size, initialized to zeros.
      * @param s The size of the matrix (s = number of pages).
      * @param initialValue The value to initialize all elements with.
+     * @param alloc The allocator (or memory resource) providing the storage.
      */
-    Matrix(size_t s, T initialValue = 0) : size(s), matrix(s, std::vector<T>(s, initialValue)) {}
+    Matrix(size_t s, T initialValue = 0, const allocator_type& alloc = {})
+        : matrix(s, std::pmr::vector<T>(s, initialValue, alloc), alloc), size(s) {}
 
     /**
      * @brief Constructs a matrix from a 2D vector.
      * @param initialData The initial data for the matrix.
+     * @param alloc The allocator (or memory resource) providing the storage.
      */
-    Matrix(const std::vector<std::vector<T>>& initialData) {
+    Matrix(const std::vector<std::vector<T>>& initialData, const allocator_type& alloc = {})
+        : matrix(alloc) {
         if (initialData.empty() || initialData.size() != initialData[0].size()) {
             throw std::invalid_argument("Matrix must be square.");
         }
         size = initialData.size();
-        matrix = initialData;
+        matrix.reserve(size);
+        for (const auto& row : initialData) {
+            matrix.emplace_back(row.begin(), row.end());
+        }
     }
 
+    /**
+     * @brief Copy-constructs a matrix into the storage of a given allocator.
+     * @param other The matrix to copy.
+     * @param alloc The allocator (or memory resource) providing the storage.
+     */
+    Matrix(const Matrix& other, const allocator_type& alloc) : matrix(other.matrix, alloc), size(other.size) {}
+
+    Matrix(const Matrix&) = default;
+    Matrix(Matrix&&) = default;
+    Matrix& operator=(const Matrix&) = default;
+    Matrix& operator=(Matrix&&) = default;
+
     /**
      * @brief Gets the size of the matrix (the number of pages).
      * @return The size of the matrix.
@@ -45,6 +73,14 @@ public:
         return size;
     }
 
+    /**
+     * @brief Gets the allocator used for the row storage.
+     * @return A copy of the matrix's allocator.
+     */
+    allocator_type getAllocator() const {
+        return matrix.get_allocator();
+    }
+
     /**
      * @brief Overloads the () operator for element access.
      * @param i The row index of the element.
@@ -102,23 +138,43 @@ public:
 };
 
 /**
- * @brief Overloads the * operator for matrix-vector multiplication.
+ * @brief Computes the matrix-vector product into an existing vector without allocating.
  * @tparam T The numeric type.
  * @param matrix The matrix.
  * @param vector The vector.
- * @return The resulting vector.
+ * @param result The output vector; must have the matrix size and must not alias @p vector.
  */
 template<typename T>
-Vector<T> operator*(const Matrix<T>& matrix, const Vector<T>& vector) {
-    if (matrix.getSize() != vector.getSize()) {
+void multiply(const Matrix<T>& matrix, const Vector<T>& vector, Vector<T>& result) {
+    if (matrix.getSize() != vector.getSize() || matrix.getSize() != result.getSize()) {
         throw std::invalid_argument("Matrix and vector dimensions must match for multiplication.");
     }
-    Vector<T> result(matrix.getSize());
+    if (&vector == &result) {
+        throw std::invalid_argument("Result vector must not alias the input vector.");
+    }
     for (size_t i = 0; i < matrix.getSize(); ++i) {
+        T sum = T(0);
         for (size_t j = 0; j < matrix.getSize(); ++j) {
-            result(i) += matrix(i, j) * vector(j);
+            sum += matrix(i, j) * vector(j);
         }
+        result(i) = sum;
+    }
+}
+
+/**
+ * @brief Overloads the * operator for matrix-vector multiplication.
+ * @tparam T The numeric type.
+ * @param matrix The matrix.
+ * @param vector The vector.
+ * @return The resulting vector.
+ */
+template<typename T>
+Vector<T> operator*(const Matrix<T>& matrix, const Vector<T>& vector) {
+    if (matrix.getSize() != vector.getSize()) {
+        throw std::invalid_argument("Matrix and vector dimensions must match for multiplication.");
     }
+    Vector<T> result(matrix.getSize(), vector.getAllocator());
+    multiply(matrix, vector, result);
     return result;
 }
 
@@ -3,14 +3,23 @@
 
 #include "Matrix.hpp"
 #include "Vector.hpp"
+#include "SCC.hpp"
+#include "Krylov.hpp"
 #include <iostream>
 #include <iomanip>
+#include <stdexcept>
 
 /**
  * @brief Computes the PageRank for a given transition matrix.
+ *
+ * Every vector used by the solve (the teleportation vector and all temporaries)
+ * is allocated from the allocator of @p r. Constructing @p r on a per-request
+ * `std::pmr::monotonic_buffer_resource` therefore keeps the whole solve off the
+ * global heap.
+ *
  * @tparam T The numeric type (e.g., float, double).
  * @param M The column-normalized transition probability matrix.
- * @param r The rank vector (output parameter).
+ * @param r The rank vector (output parameter); its allocator is used for all storage.
  * @param alpha The damping factor.
  * @param tolerance The convergence tolerance.
  */
@@ -19,24 +28,29 @@ void pageRank(const Matrix<T>& M, Vector<T>& r, T alpha = 0.85, T tolerance = 1e
     size_t N = M.getSize();
     if (N == 0) return;
 
+    const auto alloc = r.getAllocator();
+
     // Initialize rank vector r
-    r = Vector<T>(N, static_cast<T>(1.0) / N);
+    r = Vector<T>(N, static_cast<T>(1.0) / N, alloc);
     
     // Initialize teleportation vector s
-    Vector<T> s(N, static_cast<T>(1.0) / N);
+    Vector<T> s(N, static_cast<T>(1.0) / N, alloc);
 
-    Vector<T> r_new(N);
+    Vector<T> r_new(N, alloc);
     //int iteration = 0;
     
+    // All updates below are in place, so the loop performs no allocations
     while (true) {
         // r' = a * M * r + (1 - a) * s
-        r_new = alpha * (M * r) + (1 - alpha) * s;
+        multiply(M, r, r_new);
+        r_new.axpby(1 - alpha, s, alpha);
         
-        // Check for convergence
-        T diff = (r_new - r).norm1();
+        // Check for convergence: r becomes r - r', which is discarded by the swap
+        r -= r_new;
+        T diff = r.norm1();
         
         // Update r for the next iteration
-        r = r_new;
+        r.swap(r_new);
         
         //iteration++;
         
@@ -47,4 +61,147 @@ void pageRank(const Matrix<T>& M, Vector<T>& r, T alpha = 0.85, T tolerance = 1e
     }
 }
 
+/**
+ * @brief Computes the PageRank by solving the strongly connected components in topological order.
+ *
+ * PageRank is the solution of r = alpha * M * r + (1 - alpha) * s. Processing the
+ * components of the graph sources-first, the rank flowing into a component from
+ * earlier components is already final, so it is folded into a constant term once.
+ * Components with a single node are then solved in one step, and only non-trivial
+ * components are iterated, each with a mat-vec restricted to its own nodes.
+ *
+ * Produces the same vector as `pageRank()` (up to the tolerance) for 0 <= alpha < 1.
+ * Note that `normalizeColumns()` links dangling pages to every page, which merges
+ * everything they reach into one component.
+ *
+ * The decomposition and the per-component temporaries are allocated from the
+ * memory resource of @p r, like the vectors of `pageRank()`.
+ *
+ * @tparam T The numeric type (e.g., float, double).
+ * @param M The column-normalized transition probability matrix.
+ * @param r The rank vector (output parameter); its allocator is used for all storage.
+ * @param alpha The damping factor; must be smaller than 1.
+ * @param tolerance The convergence tolerance (1-norm change over the whole vector).
+ * @return The component decomposition that was used.
+ */
+template<typename T>
+ComponentDecomposition pageRankSCC(const Matrix<T>& M, Vector<T>& r, T alpha = 0.85, T tolerance = 1e-6) {
+    if (alpha < 0 || alpha >= 1) {
+        throw std::invalid_argument("pageRankSCC requires 0 <= alpha < 1.");
+    }
+    size_t N = M.getSize();
+    const auto alloc = r.getAllocator();
+    ComponentDecomposition scc = stronglyConnectedComponents(M, alloc.resource());
+    if (N == 0) return scc;
+
+    const T teleport = (1 - alpha) / static_cast<T>(N);
+    r = Vector<T>(N, T(0), alloc);
+    std::pmr::vector<T> base(alloc), next(alloc);
+
+    for (const auto& component : scc.components) {
+        const size_t size = component.size();
+        const size_t c = scc.componentOf[component[0]];
+
+        // Constant term: teleportation plus the final rank of upstream components
+        base.assign(size, teleport);
+        for (size_t k = 0; k < size; ++k) {
+            const size_t i = component[k];
+            T inflow = T(0);
+            for (size_t j = 0; j < N; ++j) {
+                if (scc.componentOf[j] != c) {
+                    inflow += M(i, j) * r(j);
+                }
+            }
+            base[k] += alpha * inflow;
+        }
+
+        if (size == 1) {
+            const size_t i = component[0];
+            r(i) = base[0] / (1 - alpha * M(i, i));
+            continue;
+        }
+
+        // Fixed-point iteration x = alpha * M_CC * x + base inside the component
+        const T componentTolerance = tolerance * static_cast<T>(size) / static_cast<T>(N);
+        for (size_t k = 0; k < size; ++k) {
+            r(component[k]) = static_cast<T>(1.0) / N;
+        }
+        next.resize(size);
+        while (true) {
+            T diff = T(0);
+            for (size_t k = 0; k < size; ++k) {
+                const size_t i = component[k];
+                T sum = T(0);
+                for (size_t j : component) {
+                    sum += M(i, j) * r(j);
+                }
+                next[k] = base[k] + alpha * sum;
+                diff += std::abs(next[k] - r(i));
+            }
+            for (size_t k = 0; k < size; ++k) {
+                r(component[k]) = next[k];
+            }
+            if (diff < componentTolerance) break;
+        }
+    }
+    return scc;
+}
+
+/**
+ * @brief Computes the PageRank by solving (I - alpha * M) r = (1 - alpha) * s with a Krylov method.
+ *
+ * Targets damping factors close to 1, where power iteration needs thousands of
+ * iterations. The mat-vec is delegated to `multiply()`, and the Jacobi
+ * preconditioner uses the diagonal 1 - alpha * M(i, i). The result is normalized
+ * to sum to 1, which the exact solution already does.
+ *
+ * @tparam T The numeric type (e.g., float, double).
+ * @param M The column-normalized transition probability matrix.
+ * @param r The rank vector (output parameter); its allocator is used for all storage.
+ * @param alpha The damping factor; must be smaller than 1.
+ * @param tolerance The relative residual at which to stop.
+ * @param method The Krylov method (BiCGSTAB or GMRES).
+ * @param preconditioner The preconditioner (None or Jacobi).
+ * @param maxIterations The maximum number of mat-vecs.
+ * @return The convergence information of the solver.
+ */
+template<typename T>
+KrylovResult<T> pageRankKrylov(const Matrix<T>& M, Vector<T>& r, T alpha = 0.85, T tolerance = 1e-10,
+                               KrylovMethod method = KrylovMethod::BiCGSTAB,
+                               Preconditioner preconditioner = Preconditioner::Jacobi,
+                               size_t maxIterations = 1000) {
+    if (alpha < 0 || alpha >= 1) {
+        throw std::invalid_argument("pageRankKrylov requires 0 <= alpha < 1.");
+    }
+    size_t N = M.getSize();
+    if (N == 0) return KrylovResult<T>{0, T(0), true};
+
+    const auto alloc = r.getAllocator();
+    Vector<T> b(N, (1 - alpha) / static_cast<T>(N), alloc);
+    r = Vector<T>(N, static_cast<T>(1.0) / N, alloc);
+
+    // y = (I - alpha * M) x
+    auto op = [&M, alpha](const Vector<T>& x, Vector<T>& y) {
+        multiply(M, x, y);
+        y.axpby(T(1), x, -alpha);
+    };
+
+    Vector<T> inverseDiagonal(N, alloc);
+    for (size_t i = 0; i < N; ++i) {
+        inverseDiagonal(i) = T(1) / (1 - alpha * M(i, i));
+    }
+    const Vector<T>* jacobi = preconditioner == Preconditioner::Jacobi ? &inverseDiagonal : nullptr;
+
+    KrylovResult<T> result = method == KrylovMethod::GMRES
+        ? gmres(op, b, r, jacobi, tolerance, maxIterations)
+        : bicgstab(op, b, r, jacobi, tolerance, maxIterations);
+
+    T sum = T(0);
+    for (size_t i = 0; i < N; ++i) {
+        sum += r(i);
+    }
+    r *= T(1) / sum;
+    return result;
+}
+
 #endif // PAGERANK_HPP
\ No newline at end of file
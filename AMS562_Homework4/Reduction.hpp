@@ -0,0 +1,230 @@
+#ifndef REDUCTION_HPP
+#define REDUCTION_HPP
+
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @file Reduction.hpp
+ * @brief Parallel summation kernels used by `Vector<T>::norm1()` and `dot_product()`.
+ *
+ * Every kernel accumulates into `ReductionLanes` independent partial sums so the
+ * compiler can keep them in SIMD registers without reassociating floating-point
+ * additions. The range is split into exactly `numThreads` contiguous chunks whose
+ * results are combined in chunk order, so for a fixed thread count the result is
+ * bitwise reproducible regardless of scheduling.
+ */
+
+/**
+ * @brief Accumulation strategy for a reduction.
+ */
+enum class Summation {
+    Naive,    ///< Plain running sums (fastest, error grows as O(n)).
+    Pairwise, ///< Recursive pairwise summation (error grows as O(log n)).
+    Kahan     ///< Kahan-Babuska (Neumaier) compensated summation (error independent of n).
+};
+
+/// Number of independent accumulators per kernel; 8 doubles fill an AVX-512 register.
+constexpr size_t ReductionLanes = 8;
+
+/// Ranges shorter than this are reduced on the calling thread only.
+constexpr size_t ReductionParallelCutoff = size_t(1) << 15;
+
+/**
+ * @brief A running sum together with its Neumaier compensation term.
+ * @tparam T The numeric type.
+ */
+template<typename T>
+struct CompensatedSum {
+    T sum = T(0);
+    T compensation = T(0);
+
+    /**
+     * @brief Adds a value, capturing the rounding error in the compensation term.
+     * @param value The value to add.
+     */
+    void add(T value) {
+        T t = sum + value;
+        if (std::abs(sum) >= std::abs(value)) {
+            compensation += (sum - t) + value;
+        } else {
+            compensation += (value - t) + sum;
+        }
+        sum = t;
+    }
+
+    /**
+     * @brief Adds another compensated sum.
+     * @param other The compensated sum to add.
+     */
+    void add(const CompensatedSum& other) {
+        add(other.sum);
+        compensation += other.compensation;
+    }
+
+    /**
+     * @brief Gets the compensated value of the sum.
+     * @return The sum corrected by the compensation term.
+     */
+    T value() const {
+        return sum + compensation;
+    }
+};
+
+/**
+ * @brief Naive lane-parallel sum of f(i) over [begin, end).
+ * @tparam T The numeric type.
+ * @tparam F Callable mapping an index to the term to accumulate.
+ */
+template<typename T, typename F>
+T naiveSum(const F& f, size_t begin, size_t end) {
+    T lanes[ReductionLanes] = {};
+    size_t i = begin;
+    for (; i + ReductionLanes <= end; i += ReductionLanes) {
+        for (size_t l = 0; l < ReductionLanes; ++l) {
+            lanes[l] += f(i + l);
+        }
+    }
+    for (size_t l = 0; i < end; ++i, ++l) {
+        lanes[l] += f(i);
+    }
+    for (size_t width = ReductionLanes / 2; width > 0; width /= 2) {
+        for (size_t l = 0; l < width; ++l) {
+            lanes[l] += lanes[l + width];
+        }
+    }
+    return lanes[0];
+}
+
+/**
+ * @brief Pairwise sum of f(i) over [begin, end); leaves of 256 terms use `naiveSum`.
+ * @tparam T The numeric type.
+ * @tparam F Callable mapping an index to the term to accumulate.
+ */
+template<typename T, typename F>
+T pairwiseSum(const F& f, size_t begin, size_t end) {
+    constexpr size_t leaf = 256;
+    if (end - begin <= leaf) {
+        return naiveSum<T>(f, begin, end);
+    }
+    // Split on a leaf boundary so the tree shape depends only on the range
+    size_t half = ((end - begin) / 2 + leaf - 1) / leaf * leaf;
+    return pairwiseSum<T>(f, begin, begin + half) + pairwiseSum<T>(f, begin + half, end);
+}
+
+/**
+ * @brief Compensated lane-parallel sum of f(i) over [begin, end).
+ * @tparam T The numeric type.
+ * @tparam F Callable mapping an index to the term to accumulate.
+ */
+template<typename T, typename F>
+CompensatedSum<T> kahanSum(const F& f, size_t begin, size_t end) {
+    T sums[ReductionLanes] = {};
+    T compensations[ReductionLanes] = {};
+    size_t i = begin;
+    // Classic Kahan update per lane: branch-free, so the lanes vectorize
+    for (; i + ReductionLanes <= end; i += ReductionLanes) {
+        for (size_t l = 0; l < ReductionLanes; ++l) {
+            T y = f(i + l) - compensations[l];
+            T t = sums[l] + y;
+            compensations[l] = (t - sums[l]) - y;
+            sums[l] = t;
+        }
+    }
+    CompensatedSum<T> result;
+    for (size_t l = 0; l < ReductionLanes; ++l) {
+        result.add(sums[l]);
+        result.compensation -= compensations[l];
+    }
+    for (; i < end; ++i) {
+        result.add(f(i));
+    }
+    return result;
+}
+
+/**
+ * @brief Reduces f(i) over [0, n) in parallel with the selected accumulation.
+ *
+ * The range is divided into @p numThreads equal chunks and the chunk results are
+ * combined in a fixed order (a pairwise tree for `Summation::Pairwise`, compensated
+ * addition for `Summation::Kahan`). Short ranges are reduced on the calling thread
+ * using the same chunking, so the result depends only on n and @p numThreads.
+ *
+ * @tparam T The numeric type.
+ * @tparam F Callable mapping an index to the term to accumulate.
+ * @param n The number of terms.
+ * @param f The term generator.
+ * @param mode The accumulation strategy.
+ * @param numThreads The number of chunks (and threads) to use.
+ * @return The reduced value.
+ */
+template<typename T, typename F>
+T parallelReduce(size_t n, const F& f, Summation mode, unsigned int numThreads) {
+    if (numThreads == 0) numThreads = 1;
+    if (numThreads > n) numThreads = n == 0 ? 1 : static_cast<unsigned int>(n);
+
+    size_t chunkSize = (n + numThreads - 1) / numThreads;
+    std::vector<CompensatedSum<T>> partials(numThreads);
+
+    auto reduceChunk = [&](unsigned int c) {
+        size_t begin = std::min(n, c * chunkSize);
+        size_t end = std::min(n, begin + chunkSize);
+        switch (mode) {
+            case Summation::Naive:
+                partials[c].sum = naiveSum<T>(f, begin, end);
+                break;
+            case Summation::Pairwise:
+                partials[c].sum = pairwiseSum<T>(f, begin, end);
+                break;
+            case Summation::Kahan:
+                partials[c] = kahanSum<T>(f, begin, end);
+                break;
+        }
+    };
+
+    if (numThreads == 1 || n < ReductionParallelCutoff) {
+        for (unsigned int c = 0; c < numThreads; ++c) {
+            reduceChunk(c);
+        }
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(numThreads - 1);
+        for (unsigned int c = 1; c < numThreads; ++c) {
+            workers.emplace_back(reduceChunk, c);
+        }
+        reduceChunk(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    switch (mode) {
+        case Summation::Kahan: {
+            CompensatedSum<T> total;
+            for (const auto& partial : partials) {
+                total.add(partial);
+            }
+            return total.value();
+        }
+        case Summation::Pairwise:
+            for (size_t width = 1; width < partials.size(); width *= 2) {
+                for (size_t c = 0; c + width < partials.size(); c += 2 * width) {
+                    partials[c].sum += partials[c + width].sum;
+                }
+            }
+            return partials[0].sum;
+        case Summation::Naive:
+        default: {
+            T total = T(0);
+            for (const auto& partial : partials) {
+                total += partial.sum;
+            }
+            return total;
+        }
+    }
+}
+
+#endif // REDUCTION_HPP
@@ -0,0 +1,130 @@
+#ifndef SCC_HPP
+#define SCC_HPP
+
+#include "Matrix.hpp"
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <utility>
+
+/**
+ * @struct ComponentDecomposition
+ * @brief The strongly connected components of a PageRank graph.
+ *
+ * Components are listed in topological order: every edge j -> i satisfies
+ * `componentOf[j] <= componentOf[i]`, so each component only receives rank from
+ * itself and from components listed before it.
+ */
+struct ComponentDecomposition {
+    std::pmr::vector<size_t> componentOf;                   ///< Component index of every node.
+    std::pmr::vector<std::pmr::vector<size_t>> components;  ///< Nodes of every component, sources first.
+
+    /**
+     * @brief Constructs an empty decomposition.
+     * @param resource The memory resource providing the storage.
+     */
+    explicit ComponentDecomposition(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : componentOf(resource), components(resource) {}
+
+    /**
+     * @brief Gets the number of components.
+     * @return The number of strongly connected components.
+     */
+    size_t getCount() const {
+        return components.size();
+    }
+};
+
+/**
+ * @brief Computes the strongly connected components of the graph of a transition matrix.
+ *
+ * The graph has an edge j -> i whenever M(i, j) is non-zero (column j holds the out-links
+ * of page j). Uses Tarjan's algorithm with an explicit stack, so deep graphs cannot
+ * overflow the call stack.
+ *
+ * @tparam T The numeric type.
+ * @param M The transition (or adjacency) matrix.
+ * @param resource The memory resource providing the result and all temporaries.
+ * @return The components in topological order.
+ */
+template<typename T>
+ComponentDecomposition stronglyConnectedComponents(const Matrix<T>& M,
+                                                   std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    const size_t N = M.getSize();
+    const size_t unvisited = static_cast<size_t>(-1);
+
+    // Out-link lists of every node
+    std::pmr::vector<std::pmr::vector<size_t>> outLinks(N, resource);
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            if (M(i, j) != T(0)) {
+                outLinks[j].push_back(i);
+            }
+        }
+    }
+
+    std::pmr::vector<size_t> index(N, unvisited, resource), lowLink(N, 0, resource);
+    std::pmr::vector<bool> onStack(N, false, resource);
+    std::pmr::vector<size_t> stack(resource);
+    std::pmr::vector<std::pair<size_t, size_t>> callStack(resource);  // (node, next out-link to visit)
+    size_t nextIndex = 0;
+
+    ComponentDecomposition result(resource);
+    result.componentOf.assign(N, 0);
+
+    for (size_t root = 0; root < N; ++root) {
+        if (index[root] != unvisited) continue;
+        callStack.emplace_back(root, 0);
+        index[root] = lowLink[root] = nextIndex++;
+        stack.push_back(root);
+        onStack[root] = true;
+
+        while (!callStack.empty()) {
+            size_t v = callStack.back().first;
+            size_t& edge = callStack.back().second;
+
+            if (edge < outLinks[v].size()) {
+                size_t w = outLinks[v][edge++];
+                if (index[w] == unvisited) {
+                    index[w] = lowLink[w] = nextIndex++;
+                    stack.push_back(w);
+                    onStack[w] = true;
+                    callStack.emplace_back(w, 0);
+                } else if (onStack[w]) {
+                    lowLink[v] = std::min(lowLink[v], index[w]);
+                }
+                continue;
+            }
+
+            // All out-links of v are done: pop v and close its component if it is a root
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                size_t parent = callStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[v]);
+            }
+            if (lowLink[v] == index[v]) {
+                std::pmr::vector<size_t> component(resource);
+                size_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = false;
+                    component.push_back(w);
+                } while (w != v);
+                std::sort(component.begin(), component.end());
+                result.components.push_back(std::move(component));
+            }
+        }
+    }
+
+    // Tarjan emits components in reverse topological order (sinks first)
+    std::reverse(result.components.begin(), result.components.end());
+    for (size_t c = 0; c < result.components.size(); ++c) {
+        for (size_t node : result.components[c]) {
+            result.componentOf[node] = c;
+        }
+    }
+    return result;
+}
+
+#endif // SCC_HPP
@@ -2,35 +2,63 @@
 #define VECTOR_HPP
 
 #include <vector>
+#include <memory_resource>
 #include <numeric>
 #include <cmath>
 #include <stdexcept>
 #include <iostream>
+#include <utility>
+#include <thread>
+#include "Reduction.hpp"
 
 /**
  * @class Vector
  * @brief A templated class for representing a mathematical vector.
+ *
+ * Storage is obtained through a `std::pmr::polymorphic_allocator`, so a vector
+ * can be placed in any `std::pmr::memory_resource` (for example a per-request
+ * `std::pmr::monotonic_buffer_resource`). Vectors produced by the arithmetic
+ * operators inherit the allocator of their left-hand operand.
+ *
  * @tparam T The numeric type of the vector's elements (e.g., float, double).
  */
 template<typename T>
 class Vector {
+public:
+    /// Allocator used for the element storage.
+    using allocator_type = std::pmr::polymorphic_allocator<T>;
+
 private:
-    std::vector<T> data;
+    std::pmr::vector<T> data;
     size_t size;
 
 public:
     /**
      * @brief Constructs a vector of a given size, initialized to zeros.
      * @param s The size of the vector.
+     * @param alloc The allocator (or memory resource) providing the storage.
      */
-    Vector(size_t s) : data(s, T(0)), size(s) {}
+    Vector(size_t s, const allocator_type& alloc = {}) : data(s, T(0), alloc), size(s) {}
 
     /**
      * @brief Constructs a vector of a given size with a specific initial value.
      * @param s The size of the vector.
      * @param initialValue The value to initialize all elements with.
+     * @param alloc The allocator (or memory resource) providing the storage.
+     */
+    Vector(size_t s, T initialValue, const allocator_type& alloc = {}) : data(s, initialValue, alloc), size(s) {}
+
+    /**
+     * @brief Copy-constructs a vector into the storage of a given allocator.
+     * @param other The vector to copy.
+     * @param alloc The allocator (or memory resource) providing the storage.
      */
-    Vector(size_t s, T initialValue) : data(s, initialValue), size(s) {}
+    Vector(const Vector& other, const allocator_type& alloc) : data(other.data, alloc), size(other.size) {}
+
+    Vector(const Vector&) = default;
+    Vector(Vector&&) = default;
+    Vector& operator=(const Vector&) = default;
+    Vector& operator=(Vector&&) = default;
 
     /**
      * @brief Gets the size of the vector.
@@ -40,6 +68,14 @@ public:
         return size;
     }
 
+    /**
+     * @brief Gets the allocator used for the element storage.
+     * @return A copy of the vector's allocator.
+     */
+    allocator_type getAllocator() const {
+        return data.get_allocator();
+    }
+
     /**
      * @brief Overloads the () operator for element access.
      * @param i The index of the element.
@@ -64,6 +100,100 @@ public:
         return data[i];
     }
 
+    /**
+     * @brief Adds another vector to this one in place.
+     * @param other The vector to add.
+     * @return A reference to this vector.
+     */
+    Vector& operator+=(const Vector& other) {
+        if (size != other.size) {
+            throw std::invalid_argument("Vector sizes must match for addition.");
+        }
+        for (size_t i = 0; i < size; ++i) {
+            data[i] += other.data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Subtracts another vector from this one in place.
+     * @param other The vector to subtract.
+     * @return A reference to this vector.
+     */
+    Vector& operator-=(const Vector& other) {
+        if (size != other.size) {
+            throw std::invalid_argument("Vector sizes must match for subtraction.");
+        }
+        for (size_t i = 0; i < size; ++i) {
+            data[i] -= other.data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Scales this vector in place.
+     * @param scalar The scalar value.
+     * @return A reference to this vector.
+     */
+    Vector& operator*=(T scalar) {
+        for (auto& val : data) {
+            val *= scalar;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Computes this = this + a * x in place (BLAS axpy).
+     * @param a The scalar multiplying @p x.
+     * @param x The vector to accumulate.
+     * @return A reference to this vector.
+     */
+    Vector& axpy(T a, const Vector& x) {
+        if (size != x.size) {
+            throw std::invalid_argument("Vector sizes must match for axpy.");
+        }
+        for (size_t i = 0; i < size; ++i) {
+            data[i] += a * x.data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Computes this = b * this + a * x in place (BLAS axpby).
+     * @param a The scalar multiplying @p x.
+     * @param x The vector to accumulate.
+     * @param b The scalar multiplying this vector.
+     * @return A reference to this vector.
+     */
+    Vector& axpby(T a, const Vector& x, T b) {
+        if (size != x.size) {
+            throw std::invalid_argument("Vector sizes must match for axpby.");
+        }
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = b * data[i] + a * x.data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Exchanges the contents of two vectors.
+     *
+     * With equal allocators the storage is exchanged without copying elements.
+     * Otherwise each vector keeps its allocator and the elements are copied
+     * across, which allocates and may throw.
+     * @param other The vector to swap with.
+     */
+    void swap(Vector& other) {
+        if (data.get_allocator() == other.data.get_allocator()) {
+            data.swap(other.data);
+        } else {
+            std::pmr::vector<T> copy(other.data, data.get_allocator());
+            other.data.assign(data.begin(), data.end());
+            data.swap(copy);
+        }
+        std::swap(size, other.size);
+    }
+
     /**
      * @brief Calculates the 1-norm of the vector.
      * @return The 1-norm value.
@@ -76,6 +206,33 @@ public:
         return sum;
     }
 
+    /**
+     * @brief Calculates the 1-norm of the vector in parallel with a selectable accumulation.
+     * @param mode The accumulation strategy (see `Summation`).
+     * @param numThreads Number of threads to use; the result is bitwise reproducible for a fixed value.
+     * @return The 1-norm value.
+     */
+    T norm1(Summation mode, unsigned int numThreads = std::thread::hardware_concurrency()) const {
+        const T* x = data.data();
+        return parallelReduce<T>(size, [x](size_t i) { return std::abs(x[i]); }, mode, numThreads);
+    }
+
+    /**
+     * @brief Gets a pointer to the contiguous element storage.
+     * @return A pointer to the first element.
+     */
+    T* getData() {
+        return data.data();
+    }
+
+    /**
+     * @brief Gets a const pointer to the contiguous element storage.
+     * @return A const pointer to the first element.
+     */
+    const T* getData() const {
+        return data.data();
+    }
+
     /**
      * @brief Prints the vector to the console.
      */
@@ -101,13 +258,57 @@ Vector<T> operator+(const Vector<T>& v1, const Vector<T>& v2) {
     if (v1.getSize() != v2.getSize()) {
         throw std::invalid_argument("Vector sizes must match for addition.");
     }
-    Vector<T> result(v1.getSize());
+    Vector<T> result(v1.getSize(), v1.getAllocator());
     for (size_t i = 0; i < v1.getSize(); ++i) {
         result(i) = v1(i) + v2(i);
     }
     return result;
 }
 
+/**
+ * @brief Overloads the + operator for vector addition, reusing the storage of a temporary.
+ * @tparam T The numeric type.
+ * @param v1 The first vector (an rvalue whose storage holds the result).
+ * @param v2 The second vector.
+ * @return The resulting vector from the addition.
+ */
+template<typename T>
+Vector<T> operator+(Vector<T>&& v1, const Vector<T>& v2) {
+    v1 += v2;
+    return std::move(v1);
+}
+
+/**
+ * @brief Overloads the + operator for vector addition, reusing the storage of a temporary.
+ * @tparam T The numeric type.
+ * @param v1 The first vector.
+ * @param v2 The second vector (an rvalue whose storage holds the result if
+ *        it uses the allocator of v1).
+ * @return The resulting vector from the addition.
+ */
+template<typename T>
+Vector<T> operator+(const Vector<T>& v1, Vector<T>&& v2) {
+    if (v1.getAllocator() != v2.getAllocator()) {
+        // The result takes the allocator of the left operand
+        return v1 + static_cast<const Vector<T>&>(v2);
+    }
+    v2 += v1;
+    return std::move(v2);
+}
+
+/**
+ * @brief Overloads the + operator for the addition of two temporaries.
+ * @tparam T The numeric type.
+ * @param v1 The first vector (an rvalue whose storage holds the result).
+ * @param v2 The second vector.
+ * @return The resulting vector from the addition.
+ */
+template<typename T>
+Vector<T> operator+(Vector<T>&& v1, Vector<T>&& v2) {
+    v1 += v2;
+    return std::move(v1);
+}
+
 /**
  * @brief Overloads the - operator for vector subtraction.
  * @tparam T The numeric type.
@@ -120,13 +321,26 @@ Vector<T> operator-(const Vector<T>& v1, const Vector<T>& v2) {
     if (v1.getSize() != v2.getSize()) {
         throw std::invalid_argument("Vector sizes must match for subtraction.");
     }
-    Vector<T> result(v1.getSize());
+    Vector<T> result(v1.getSize(), v1.getAllocator());
     for (size_t i = 0; i < v1.getSize(); ++i) {
         result(i) = v1(i) - v2(i);
     }
     return result;
 }
 
+/**
+ * @brief Overloads the - operator for vector subtraction, reusing the storage of a temporary.
+ * @tparam T The numeric type.
+ * @param v1 The first vector (an rvalue whose storage holds the result).
+ * @param v2 The second vector.
+ * @return The resulting vector from the subtraction.
+ */
+template<typename T>
+Vector<T> operator-(Vector<T>&& v1, const Vector<T>& v2) {
+    v1 -= v2;
+    return std::move(v1);
+}
+
 /**
  * @brief Overloads the * operator for scalar multiplication.
  * @tparam T The numeric type.
@@ -136,13 +350,36 @@ Vector<T> operator-(const Vector<T>& v1, const Vector<T>& v2) {
  */
 template<typename T>
 Vector<T> operator*(T scalar, const Vector<T>& vec) {
-    Vector<T> result(vec.getSize());
+    Vector<T> result(vec.getSize(), vec.getAllocator());
     for (size_t i = 0; i < vec.getSize(); ++i) {
         result(i) = scalar * vec(i);
     }
     return result;
 }
 
+/**
+ * @brief Overloads the * operator for scalar multiplication, reusing the storage of a temporary.
+ * @tparam T The numeric type.
+ * @param scalar The scalar value.
+ * @param vec The vector (an rvalue whose storage holds the result).
+ * @return The resulting vector.
+ */
+template<typename T>
+Vector<T> operator*(T scalar, Vector<T>&& vec) {
+    vec *= scalar;
+    return std::move(vec);
+}
+
+/**
+ * @brief Exchanges the contents of two vectors (see `Vector::swap`).
+ * @tparam T The numeric type.
+ * @param v1, v2 The vectors to swap.
+ */
+template<typename T>
+void swap(Vector<T>& v1, Vector<T>& v2) {
+    v1.swap(v2);
+}
+
 /**
  * @brief Overloads the * operator for dot product.
  * @tparam T The numeric type.
@@ -161,4 +398,23 @@ T dot_product(const Vector<T>& v1, const Vector<T>& v2) {
     return result;    
 }
 
+/**
+ * @brief Computes the dot product in parallel with a selectable accumulation.
+ * @tparam T The numeric type.
+ * @param v1, v2 the vectors.
+ * @param mode The accumulation strategy (see `Summation`).
+ * @param numThreads Number of threads to use; the result is bitwise reproducible for a fixed value.
+ * @return The resulting scalar.
+ */
+template<typename T>
+T dot_product(const Vector<T>& v1, const Vector<T>& v2, Summation mode,
+              unsigned int numThreads = std::thread::hardware_concurrency()) {
+    if (v1.getSize() != v2.getSize()) {
+        throw std::invalid_argument("Vector sizes must match for dot product.");
+    }
+    const T* x = v1.getData();
+    const T* y = v2.getData();
+    return parallelReduce<T>(v1.getSize(), [x, y](size_t i) { return x[i] * y[i]; }, mode, numThreads);
+}
+
 #endif // VECTOR_HPP
@@ -0,0 +1,96 @@
+#include "Vector.hpp"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * @file reduction_benchmark.cpp
+ * @brief Throughput and accuracy benchmark for the `Vector<T>` reductions.
+ *
+ * For each vector size, the serial `norm1()` / `dot_product()` baselines and every
+ * `Summation` mode at several thread counts are timed. Throughput is reported in
+ * GB/s of input streamed, and accuracy as the relative error against a long double
+ * reference sum.
+ */
+
+namespace {
+
+/// Average wall time of a callable over a number of runs, in seconds.
+template<typename Func>
+double measureTime(Func&& func, int numRuns) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < numRuns; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count() / numRuns;
+}
+
+const char* modeName(Summation mode) {
+    switch (mode) {
+        case Summation::Naive: return "naive";
+        case Summation::Pairwise: return "pairwise";
+        case Summation::Kahan: return "kahan";
+    }
+    return "?";
+}
+
+void printRow(const std::string& name, unsigned int threads, double bytes, double seconds,
+              double value, long double reference) {
+    double relativeError = static_cast<double>(std::abs((value - reference) / reference));
+    std::cout << std::left << std::setw(22) << name << std::right << std::setw(8) << threads
+              << std::setw(12) << std::fixed << std::setprecision(2) << bytes / seconds / 1e9
+              << std::setw(14) << std::scientific << std::setprecision(2) << relativeError
+              << std::defaultfloat << std::endl;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<size_t> sizes = {size_t(1) << 20, 10000000, size_t(1) << 25};
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> threadCounts = {1, 2, 4};
+    if (hardwareThreads > 4) threadCounts.push_back(hardwareThreads);
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    for (size_t n : sizes) {
+        Vector<double> x(n), y(n);
+        long double normReference = 0.0L, dotReference = 0.0L;
+        for (size_t i = 0; i < n; ++i) {
+            x(i) = dist(rng);
+            y(i) = dist(rng);
+            normReference += std::abs(static_cast<long double>(x(i)));
+            dotReference += static_cast<long double>(x(i)) * y(i);
+        }
+        const int runs = n > (size_t(1) << 22) ? 5 : 20;
+        const double normBytes = double(n) * sizeof(double);
+        const double dotBytes = 2.0 * normBytes;
+
+        std::cout << "\nn = " << n << "\n"
+                  << std::left << std::setw(22) << "kernel" << std::right << std::setw(8) << "threads"
+                  << std::setw(12) << "GB/s" << std::setw(14) << "rel. error" << std::endl;
+
+        double value = 0.0;
+        double seconds = measureTime([&]() { value = x.norm1(); }, runs);
+        printRow("norm1 serial", 1, normBytes, seconds, value, normReference);
+        seconds = measureTime([&]() { value = dot_product(x, y); }, runs);
+        printRow("dot serial", 1, dotBytes, seconds, value, dotReference);
+
+        for (Summation mode : {Summation::Naive, Summation::Pairwise, Summation::Kahan}) {
+            for (unsigned int threads : threadCounts) {
+                seconds = measureTime([&]() { value = x.norm1(mode, threads); }, runs);
+                printRow(std::string("norm1 ") + modeName(mode), threads, normBytes, seconds, value, normReference);
+            }
+            for (unsigned int threads : threadCounts) {
+                seconds = measureTime([&]() { value = dot_product(x, y, mode, threads); }, runs);
+                printRow(std::string("dot ") + modeName(mode), threads, dotBytes, seconds, value, dotReference);
+            }
+        }
+    }
+    return 0;
+}
@@ -1,9 +1,53 @@
 #include "Matrix.hpp"
 #include "Vector.hpp"
 #include "PageRank.hpp"
+#include "SCC.hpp"
+#include "Krylov.hpp"
 #include <iostream>
 #include <vector>
 #include <cassert>
+#include <memory_resource>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+// Number of allocations through the global operator new, which std::allocator and
+// the new/delete resource use; a solve in an arena must leave it unchanged
+static size_t globalAllocations = 0;
+
+void* operator new(size_t bytes) {
+    ++globalAllocations;
+    if (void* p = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Memory resource that counts the allocations forwarded to the default resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
 
 void runUnitTests() {
     std::cout << "-------------- Running Unit Tests --------------" << std::endl;
@@ -22,8 +66,60 @@ void runUnitTests() {
     assert(v_scaled(0) == 3.0 && v_scaled(1) == 6.0 && v_scaled(2) == 3.0);
     
     assert(abs(v1.norm1() - 4.0) < 1e-9);
+
+    // In-place and move-aware operations
+    Vector<double> v_acc(3, 1.0);
+    v_acc += v2;
+    v_acc -= v1;
+    v_acc *= 2.0;
+    assert(v_acc(0) == 4.0 && v_acc(1) == 2.0 && v_acc(2) == 4.0);
+    v_acc.axpy(0.5, v2);
+    assert(v_acc(0) == 5.0 && v_acc(1) == 3.0 && v_acc(2) == 5.0);
+    v_acc.axpby(1.0, v1, 2.0);
+    assert(v_acc(0) == 11.0 && v_acc(1) == 8.0 && v_acc(2) == 11.0);
+    swap(v_acc, v_sum);
+    assert(v_acc(0) == 3.0 && v_sum(0) == 11.0);
+
+    // A chained expression allocates only the first temporary
+    CountingResource counter;
+    Vector<double> c1(3, 1.0, &counter);
+    Vector<double> c2(3, 2.0, &counter);
+    counter.allocations = 0;
+    Vector<double> chained = 3.0 * (c1 + c2 - c1) + c2;
+    assert(counter.allocations == 1);
+    assert(chained(0) == 8.0 && chained(2) == 8.0);
     std::cout << "Vector tests passed." << std::endl;
 
+    // Reduction tests: every mode agrees on exact data
+    const size_t n_red = 100000;
+    Vector<double> ones(n_red, -1.0);
+    Vector<double> twos(n_red, 2.0);
+    for (Summation mode : {Summation::Naive, Summation::Pairwise, Summation::Kahan}) {
+        assert(ones.norm1(mode, 4) == double(n_red));
+        assert(dot_product(ones, twos, mode, 3) == -2.0 * n_red);
+    }
+
+    // Compensated summation recovers the small terms that a naive sum drops
+    Vector<double> ill(n_red, 1e-16);
+    for (size_t i = 0; i < ReductionLanes; ++i) {
+        ill(i) = 1.0;
+    }
+    assert(ill.norm1(Summation::Naive, 1) == double(ReductionLanes));
+    assert(abs(ill.norm1(Summation::Kahan, 4) - (ReductionLanes + (n_red - ReductionLanes) * 1e-16)) < 1e-14);
+
+    // Results are bitwise reproducible for a fixed thread count
+    Vector<double> noisy(n_red);
+    for (size_t i = 0; i < n_red; ++i) {
+        noisy(i) = std::sin(0.37 * i) * 1e3;
+    }
+    for (Summation mode : {Summation::Naive, Summation::Pairwise, Summation::Kahan}) {
+        double first = dot_product(noisy, twos, mode, 4);
+        for (int run = 0; run < 5; ++run) {
+            assert(dot_product(noisy, twos, mode, 4) == first);
+        }
+    }
+    std::cout << "Reduction tests passed." << std::endl;
+
     // Matrix tests
     std::vector<std::vector<double>> adj_data = {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}};
     Matrix<double> adj_matrix(adj_data);
@@ -65,6 +161,91 @@ void runUnitTests() {
     }
     assert(abs(rank_sum - 1.0) < 1e-6);
     std::cout << "PageRank test passed." << std::endl;
+
+    // Test arena allocation: with the default resource replaced by the null resource, any
+    // pmr allocation that escapes the arena throws std::bad_alloc, and any std::allocator
+    // allocation shows up in the global allocation count
+    {
+        Vector<double> scc_vec(6), krylov_vec(6);
+        pageRankSCC(A, scc_vec, 0.85, 1e-12);
+        pageRankKrylov(A, krylov_vec, 0.85, 1e-12);
+
+        std::byte buffer[1 << 15];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        Matrix<double> A_arena(adjacency_data, &arena);
+        A_arena.normalizeColumns();
+        Vector<double> rank_arena(6, &arena), scc_arena(6, &arena);
+        Vector<double> bicgstab_arena(6, &arena), gmres_arena(6, &arena);
+
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        const size_t allocationsBefore = globalAllocations;
+        pageRank(A_arena, rank_arena, 1.0, 1e-6);
+        ComponentDecomposition scc_parts = pageRankSCC(A_arena, scc_arena, 0.85, 1e-12);
+        pageRankKrylov(A_arena, bicgstab_arena, 0.85, 1e-12, KrylovMethod::BiCGSTAB);
+        pageRankKrylov(A_arena, gmres_arena, 0.85, 1e-12, KrylovMethod::GMRES);
+        const size_t escapedAllocations = globalAllocations - allocationsBefore;
+        std::pmr::set_default_resource(previous);
+
+        assert(escapedAllocations == 0);
+
+        assert(rank_arena.getAllocator().resource() == &arena);
+        assert(scc_arena.getAllocator().resource() == &arena);
+        assert(scc_parts.components.get_allocator().resource() == &arena);
+        for (size_t i = 0; i < 6; ++i) {
+            assert(abs(rank_arena(i) - rank_vec(i)) < 1e-12);
+            assert(abs(scc_arena(i) - scc_vec(i)) < 1e-12);
+            assert(abs(bicgstab_arena(i) - krylov_vec(i)) < 1e-12);
+            assert(abs(gmres_arena(i) - krylov_vec(i)) < 1e-9);
+        }
+    }
+    std::cout << "Arena allocation test passed." << std::endl;
+
+    // Test SCC decomposition: two terminal cycles {0, 1, 2} and {5, 6} fed by the chain 7 -> 4 -> 3
+    std::vector<std::vector<double>> periphery_data(8, std::vector<double>(8, 0.0));
+    auto link = [&](size_t from, size_t to) { periphery_data[to][from] = 1.0; };
+    link(0, 1); link(1, 2); link(2, 0);
+    link(5, 6); link(6, 5);
+    link(3, 0); link(4, 3); link(4, 5); link(7, 4); link(7, 2);
+    Matrix<double> P(periphery_data);
+    P.normalizeColumns();
+
+    ComponentDecomposition scc = stronglyConnectedComponents(P);
+    assert(scc.getCount() == 5);
+    assert(scc.componentOf[0] == scc.componentOf[1] && scc.componentOf[1] == scc.componentOf[2]);
+    assert(scc.componentOf[5] == scc.componentOf[6]);
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            if (P(i, j) != 0.0) {
+                assert(scc.componentOf[j] <= scc.componentOf[i]);  // topological order
+            }
+        }
+    }
+
+    Vector<double> power_ranks(8), scc_ranks(8);
+    pageRank(P, power_ranks, 0.85, 1e-12);
+    pageRankSCC(P, scc_ranks, 0.85, 1e-12);
+    for (size_t i = 0; i < 8; ++i) {
+        assert(abs(power_ranks(i) - scc_ranks(i)) < 1e-10);
+    }
+    assert(abs(scc_ranks.norm1() - 1.0) < 1e-10);
+    std::cout << "SCC PageRank test passed." << std::endl;
+
+    // Test Krylov solvers against the power method at a high damping factor
+    for (const Matrix<double>* graph : {&A, &P}) {
+        Vector<double> power(graph->getSize());
+        pageRank(*graph, power, 0.99, 1e-13);
+        for (KrylovMethod method : {KrylovMethod::BiCGSTAB, KrylovMethod::GMRES}) {
+            for (Preconditioner preconditioner : {Preconditioner::None, Preconditioner::Jacobi}) {
+                Vector<double> krylov(graph->getSize());
+                KrylovResult<double> info = pageRankKrylov(*graph, krylov, 0.99, 1e-12, method, preconditioner);
+                assert(info.converged);
+                for (size_t i = 0; i < graph->getSize(); ++i) {
+                    assert(abs(krylov(i) - power(i)) < 1e-9);
+                }
+            }
+        }
+    }
+    std::cout << "Krylov PageRank test passed." << std::endl;
     std::cout << "------------------------------------------------" << std::endl << std::endl;
 }
 
@@ -0,0 +1,826 @@
+// benchmarks/primitives_benchmark.cpp
+
+// Overview:
+// Google Benchmark harness for the inner product, the inclusive scan and the
+// scan-based algorithms (copy_if, partition, SpMV, radix sort). Every
+// variant (std, threads, OpenMP, work stealing, and their modes) is swept over element types,
+// input sizes from 1K elements up to AMS562_BENCH_MAX_ELEMENTS (default 1G)
+// and thread counts from 1 to the hardware concurrency. Each run reports the
+// bytes streamed per second (bytes_per_second) and elements per second
+// (items_per_second). The scan-based algorithms are also run with
+// std::execution::par when the parallel STL (TBB) is available. The
+// contended/ runs repeat the threads and work-stealing primitives while one
+// background thread per core spins, as on a shared machine. The
+// aggregate_slots/ runs have every worker accumulate into its own slot of a
+// packed std::vector or of PaddedSlots, which shows the cost of false sharing
+// at the swept thread counts. The numa/ runs compare the NUMA-aware inner
+// product and scan on first-touched buffers with the plain primitives on
+// buffers initialized by the main thread, at full machine width.
+//
+// Typical use (one command line):
+//   ./primitives_benchmark --benchmark_repetitions=10
+//       --benchmark_report_aggregates_only=true
+//       --benchmark_out=results.json --benchmark_out_format=json
+// Two JSON files can be compared with tools/compare.py of Google Benchmark.
+
+#include <benchmark/benchmark.h>
+#include <omp.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#if AMS562_PARALLEL_STL
+#include <execution>
+#endif
+
+#include "inclusive_scan_openmp.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inner_product_openmp.hpp"
+#include "inner_product_threads.hpp"
+#include "numa.hpp"
+#include "padded_slots.hpp"
+#include "radix_sort.hpp"
+#include "scan_algorithms.hpp"
+#include "stealing_primitives.hpp"
+
+namespace {
+
+// Largest input size of the sweep, from AMS562_BENCH_MAX_ELEMENTS
+int64_t max_elements() {
+  const char* value = std::getenv("AMS562_BENCH_MAX_ELEMENTS");
+  int64_t max = value ? std::atoll(value) : 0;
+  return max >= (1 << 10) ? max : int64_t(1) << 30;
+}
+
+// Largest working set a run may allocate: AMS562_BENCH_MAX_BYTES, or half of
+// the physical memory. Larger sizes are reported as skipped.
+size_t memory_budget() {
+  if (const char* value = std::getenv("AMS562_BENCH_MAX_BYTES")) {
+    return static_cast<size_t>(std::atoll(value));
+  }
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || page_size <= 0) return size_t(1) << 32;
+  return static_cast<size_t>(pages) * static_cast<size_t>(page_size) / 2;
+}
+
+// Storage of the input and output buffers, shared by every element type so
+// that the sweep keeps at most kBuffers large allocations alive
+constexpr size_t kBuffers = 3;
+
+struct Storage {
+  std::vector<uint64_t> words;
+  const std::type_info* type = nullptr;  // element type of the filled prefix
+  size_t filled = 0;                     // number of elements set to 1
+};
+
+Storage& storage(size_t id) {
+  static Storage buffers[kBuffers];
+  return buffers[id];
+}
+
+// Returns buffer id holding at least n elements of value 1. The storage only
+// grows and is refilled only when the type or size grows, so the sweep does
+// not reallocate (and first-touch) gigabytes for every run.
+template <typename T>
+T* buffer(size_t id, size_t n) {
+  static_assert(alignof(T) <= alignof(uint64_t), "unsupported element type");
+  Storage& data = storage(id);
+  size_t words = (n * sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  if (data.words.size() < words) {
+    data.words = std::vector<uint64_t>();  // release before allocating
+    data.words.resize(words);
+    data.type = nullptr;
+  }
+  T* elements = reinterpret_cast<T*>(data.words.data());
+  if (data.type != &typeid(T) || data.filled < n) {
+    std::fill(elements, elements + n, T(1));
+    data.type = &typeid(T);
+    data.filled = n;
+  }
+  return elements;
+}
+
+// Pool whose workers plus the calling thread make up the given thread count
+ThreadPool& pool_for(unsigned int threads) {
+  static std::map<unsigned int, std::unique_ptr<ThreadPool>> pools;
+  std::unique_ptr<ThreadPool>& pool = pools[threads];
+  if (!pool) pool = std::make_unique<ThreadPool>(std::max(1u, threads - 1));
+  return *pool;
+}
+
+// Work-stealing scheduler whose workers plus the calling thread make up the
+// given thread count
+WorkStealingScheduler& scheduler_for(unsigned int threads) {
+  static std::map<unsigned int, std::unique_ptr<WorkStealingScheduler>>
+      schedulers;
+  std::unique_ptr<WorkStealingScheduler>& scheduler = schedulers[threads];
+  if (!scheduler) {
+    scheduler =
+        std::make_unique<WorkStealingScheduler>(std::max(1u, threads - 1));
+  }
+  return *scheduler;
+}
+
+// Sets the OpenMP thread count for the lifetime of a benchmark run
+class OpenMPThreads {
+ public:
+  explicit OpenMPThreads(int threads) : saved_(omp_get_max_threads()) {
+    omp_set_num_threads(threads);
+  }
+  ~OpenMPThreads() { omp_set_num_threads(saved_); }
+
+ private:
+  int saved_;
+};
+
+// Checks the buffers a run may keep alive against the memory budget; returns
+// false if the run must be skipped
+bool prepare(benchmark::State& state, size_t element_size) {
+  size_t n = static_cast<size_t>(state.range(0));
+  if (n * kBuffers * element_size > memory_budget()) {
+    state.SkipWithError("working set exceeds the memory budget");
+    return false;
+  }
+  return true;
+}
+
+// Reports the elements and bytes streamed per second
+void report(benchmark::State& state, size_t bytes_per_element) {
+  int64_t n = state.range(0);
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n *
+                          static_cast<int64_t>(bytes_per_element));
+}
+
+enum class Backend { Std, Threads, OpenMP, Stealing };
+
+const char* backend_name(Backend backend) {
+  switch (backend) {
+    case Backend::Std: return "std";
+    case Backend::Threads: return "threads";
+    case Backend::OpenMP: return "openmp";
+    case Backend::Stealing: return "stealing";
+  }
+  return "?";
+}
+
+const char* mode_name(AccumulationMode mode) {
+  switch (mode) {
+    case AccumulationMode::Fast: return "fast";
+    case AccumulationMode::Compensated: return "compensated";
+    case AccumulationMode::Reproducible: return "reproducible";
+  }
+  return "?";
+}
+
+const char* mode_name(ScanMode mode) {
+  switch (mode) {
+    case ScanMode::ScanThenAdd: return "scan_then_add";
+    case ScanMode::DecoupledLookback: return "lookback";
+    case ScanMode::ReduceThenScan: return "reduce_then_scan";
+  }
+  return "?";
+}
+
+// Inner product of two vectors of state.range(0) elements on
+// state.range(1) threads; streams 2 elements per element
+template <typename T>
+void bm_inner_product(benchmark::State& state, Backend backend,
+                      AccumulationMode mode) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* a = buffer<T>(0, n);
+  const T* b = buffer<T>(1, n);
+  OpenMPThreads omp_threads(static_cast<int>(threads));
+
+  for (auto _ : state) {
+    T result = T(0);
+    switch (backend) {
+      case Backend::Std:
+        result = std::inner_product(a, a + n, b, T(0));
+        break;
+      case Backend::Threads:
+        result = parallel_inner_product_threads(pool_for(threads), a, a + n,
+                                                b, threads, mode);
+        break;
+      case Backend::OpenMP:
+        result = parallel_inner_product_openmp(a, a + n, b, mode);
+        break;
+      case Backend::Stealing:
+        result = parallel_inner_product_stealing(scheduler_for(threads), a,
+                                                 a + n, b, kAutoGrain, mode);
+        break;
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Inclusive scan of state.range(0) elements on state.range(1) threads; reads
+// and writes one element per element
+template <typename T>
+void bm_inclusive_scan(benchmark::State& state, Backend backend,
+                       ScanMode mode) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* input = buffer<T>(0, n);
+  T* output = buffer<T>(2, n);
+  OpenMPThreads omp_threads(static_cast<int>(threads));
+
+  for (auto _ : state) {
+    switch (backend) {
+      case Backend::Std:
+        std::inclusive_scan(input, input + n, output);
+        break;
+      case Backend::Threads:
+        parallel_inclusive_scan_threads(pool_for(threads), input, input + n,
+                                        output, threads, mode);
+        break;
+      case Backend::OpenMP:
+        parallel_inclusive_scan_openmp(input, input + n, output, mode);
+        break;
+      case Backend::Stealing:
+        // Always reduce-then-scan over stolen blocks
+        parallel_inclusive_scan_stealing(scheduler_for(threads), input,
+                                         input + n, output);
+        break;
+    }
+    benchmark::DoNotOptimize(output);
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Fused inner product of one vector with two others (two running sums per
+// chunk, the case where neighbouring chunks' sums would share a cache line);
+// streams 3 elements per element
+template <typename T>
+void bm_fused_inner_product(benchmark::State& state, Backend backend) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* a = buffer<T>(0, n);
+  std::vector<const T*> others = {buffer<T>(1, n), buffer<T>(2, n)};
+  OpenMPThreads omp_threads(static_cast<int>(threads));
+
+  for (auto _ : state) {
+    std::vector<T> result =
+        backend == Backend::OpenMP
+            ? parallel_fused_inner_product_openmp(a, a + n, others)
+            : parallel_fused_inner_product_threads(pool_for(threads), a, a + n,
+                                                   others, threads);
+    benchmark::DoNotOptimize(result.data());
+  }
+  report(state, 3 * sizeof(T));
+}
+
+// Per-worker accumulation into packed (std::vector) or padded (PaddedSlots)
+// slots: each of state.range(1) workers adds state.range(0) elements of its
+// own chunk into its slot one element at a time, the store pattern of a
+// chunk aggregate that is updated in place. Counts one element per element.
+template <typename Slots>
+void bm_aggregate_slots(benchmark::State& state) {
+  if (!prepare(state, sizeof(double))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const double* input = buffer<double>(0, n);
+  size_t chunk = (n + threads - 1) / threads;
+
+  for (auto _ : state) {
+    Slots slots(threads, 0.0);
+    pool_for(threads).parallel_for(threads, [&](size_t i) {
+      size_t end = std::min(n, (i + 1) * chunk);
+      for (size_t j = i * chunk; j < end; ++j) {
+        // DoNotOptimize keeps the slot in memory, so every element stores it
+        benchmark::DoNotOptimize(slots[i] += input[j]);
+      }
+    });
+    benchmark::DoNotOptimize(slots[0]);
+  }
+  report(state, sizeof(double));
+}
+
+// NUMA placement of the numa/ benchmarks: buffers written by the main thread
+// (all pages on its node) or first-touched by the node that reads them
+enum class Placement { MainThread, FirstTouch };
+
+const char* placement_name(Placement placement) {
+  return placement == Placement::MainThread ? "plain" : "numa";
+}
+
+// Checks that the NUMA buffers (extra elements of T per element) fit next to
+// the shared buffers in the memory budget
+bool prepare_numa(benchmark::State& state, size_t element_size,
+                  size_t extra_buffers) {
+  size_t n = static_cast<size_t>(state.range(0));
+  if (n * (kBuffers + extra_buffers) * element_size > memory_budget()) {
+    state.SkipWithError("working set exceeds the memory budget");
+    return false;
+  }
+  return true;
+}
+
+// Inner product of two vectors of state.range(0) elements on state.range(1)
+// threads (the whole machine), placed by the main thread and run by the plain
+// primitive, or first-touched per node and run by the NUMA-aware one
+template <typename T>
+void bm_numa_inner_product(benchmark::State& state, Backend backend,
+                           Placement placement) {
+  if (!prepare_numa(state, sizeof(T), 2)) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  OpenMPThreads omp_threads(static_cast<int>(threads));
+  NumaBuffer<T> numa_a, numa_b;
+  if (placement == Placement::FirstTouch) {
+    if (backend == Backend::OpenMP) {
+      numa_a = NumaBuffer<T>(n);
+      numa_b = NumaBuffer<T>(n);
+      numa_fill_openmp(numa_a.data(), n, T(1));
+      numa_fill_openmp(numa_b.data(), n, T(1));
+    } else {
+      numa_a = numa_allocate(n, T(1));
+      numa_b = numa_allocate(n, T(1));
+    }
+  }
+  const T* a = placement == Placement::FirstTouch ? numa_a.data()
+                                                  : buffer<T>(0, n);
+  const T* b = placement == Placement::FirstTouch ? numa_b.data()
+                                                  : buffer<T>(1, n);
+
+  for (auto _ : state) {
+    T result = T(0);
+    if (backend == Backend::OpenMP) {
+      result = placement == Placement::FirstTouch
+                   ? numa_inner_product_openmp(a, b, n)
+                   : parallel_inner_product_openmp(a, a + n, b);
+    } else {
+      result = placement == Placement::FirstTouch
+                   ? numa_inner_product(a, b, n)
+                   : parallel_inner_product_threads(pool_for(threads), a,
+                                                    a + n, b, threads);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Inclusive scan of state.range(0) elements on state.range(1) threads (the
+// whole machine); placement as in bm_numa_inner_product
+template <typename T>
+void bm_numa_inclusive_scan(benchmark::State& state, Placement placement) {
+  if (!prepare_numa(state, sizeof(T), 2)) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  NumaBuffer<T> numa_input, numa_output;
+  if (placement == Placement::FirstTouch) {
+    numa_input = numa_allocate(n, T(1));
+    numa_output = numa_allocate(n, T(0));
+  }
+
+  for (auto _ : state) {
+    if (placement == Placement::FirstTouch) {
+      numa_inclusive_scan(numa_input.data(), numa_output.data(), n);
+    } else {
+      const T* input = buffer<T>(0, n);
+      parallel_inclusive_scan_threads(pool_for(threads), input, input + n,
+                                      buffer<T>(2, n), threads);
+    }
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Threads that spin for their lifetime, so that the workers of a benchmark
+// have to share the cores with other load
+class BackgroundLoad {
+ public:
+  explicit BackgroundLoad(unsigned int threads) {
+    for (unsigned int t = 0; t < threads; ++t) {
+      threads_.emplace_back([this]() {
+        volatile uint64_t spin = 0;
+        while (!stop_.load(std::memory_order_relaxed)) spin = spin + 1;
+      });
+    }
+  }
+  ~BackgroundLoad() {
+    stop_.store(true);
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+// Inner product (scan = false) or inclusive scan (scan = true) of
+// state.range(0) elements on state.range(1) threads, while one background
+// thread per core spins. Static chunks wait for the slowest worker; stolen
+// leaves move to the workers that run.
+template <typename T>
+void bm_contended(benchmark::State& state, Backend backend, bool scan) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* input = buffer<T>(0, n);
+  const T* other = buffer<T>(1, n);
+  T* output = buffer<T>(2, n);
+  BackgroundLoad load(std::max(1u, std::thread::hardware_concurrency()));
+
+  for (auto _ : state) {
+    if (backend == Backend::Stealing) {
+      WorkStealingScheduler& scheduler = scheduler_for(threads);
+      if (scan) {
+        parallel_inclusive_scan_stealing(scheduler, input, input + n, output);
+      } else {
+        benchmark::DoNotOptimize(parallel_inner_product_stealing(
+            scheduler, input, input + n, other));
+      }
+    } else if (scan) {
+      parallel_inclusive_scan_threads(pool_for(threads), input, input + n,
+                                      output, threads);
+    } else {
+      benchmark::DoNotOptimize(parallel_inner_product_threads(
+          pool_for(threads), input, input + n, other, threads));
+    }
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Backends of the scan-based algorithms: serial std, std::execution::par and
+// the threads primitives
+enum class AlgorithmBackend { Std, StdPar, Threads };
+
+const char* backend_name(AlgorithmBackend backend) {
+  switch (backend) {
+    case AlgorithmBackend::Std: return "std";
+    case AlgorithmBackend::StdPar: return "std_par";
+    case AlgorithmBackend::Threads: return "threads";
+  }
+  return "?";
+}
+
+// Stream compaction of state.range(0) elements that keeps every element (the
+// largest output); reads and writes one element per element
+template <typename T>
+void bm_copy_if(benchmark::State& state, AlgorithmBackend backend) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* input = buffer<T>(0, n);
+  T* output = buffer<T>(2, n);
+  auto keep = [](const T& v) { return v > T(0); };
+
+  for (auto _ : state) {
+    T* end = output;
+    switch (backend) {
+      case AlgorithmBackend::Std:
+        end = std::copy_if(input, input + n, output, keep);
+        break;
+      case AlgorithmBackend::StdPar:
+#if AMS562_PARALLEL_STL
+        end = std::copy_if(std::execution::par, input, input + n, output, keep);
+#endif
+        break;
+      case AlgorithmBackend::Threads:
+        end = parallel_copy_if_threads(pool_for(threads), input, input + n,
+                                       output, keep, threads);
+        break;
+    }
+    benchmark::DoNotOptimize(end);
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Returns buffer id filled with n pseudo-random finite keys (splitmix64). The
+// storage is marked as unfilled, so the next buffer() call refills it.
+template <typename T>
+T* random_buffer(size_t id, size_t n) {
+  T* keys = buffer<T>(id, n);
+  uint64_t state = 562;
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    keys[i] = std::is_floating_point_v<T>
+                  ? static_cast<T>(static_cast<int64_t>(z) >> 20)
+                  : static_cast<T>(z);
+  }
+  storage(id).type = nullptr;
+  return keys;
+}
+
+// Stable partition of state.range(0) random keys by sign (about half go to
+// each side) into one output range; reads and writes one element per element
+template <typename T>
+void bm_partition(benchmark::State& state, AlgorithmBackend backend) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* input = random_buffer<T>(0, n);
+  T* output = buffer<T>(2, n);
+  // The predicate depends only on the value, so the parallel STL may call
+  // it on copies of the elements
+  auto negative = [](const T& v) { return v < T(0); };
+  const size_t num_negative =
+      static_cast<size_t>(std::count_if(input, input + n, negative));
+
+  for (auto _ : state) {
+    switch (backend) {
+      case AlgorithmBackend::Std:
+        std::partition_copy(input, input + n, output, output + num_negative,
+                            negative);
+        break;
+      case AlgorithmBackend::StdPar:
+#if AMS562_PARALLEL_STL
+        std::partition_copy(std::execution::par, input, input + n, output,
+                            output + num_negative, negative);
+#endif
+        break;
+      case AlgorithmBackend::Threads:
+        parallel_partition_threads(pool_for(threads), input, input + n,
+                                   output, negative, threads);
+        break;
+    }
+    benchmark::DoNotOptimize(output);
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Number of nonzeros per row of the SpMV benchmark matrix
+constexpr size_t kSpmvRowNonzeros = 8;
+
+// Banded CSR matrix of the SpMV benchmark with n nonzeros, kept between runs
+template <typename T>
+const CsrMatrix<T>& spmv_matrix(size_t n) {
+  static CsrMatrix<T> matrix;
+  if (matrix.nonzeros() != n) {
+    matrix = CsrMatrix<T>();
+    matrix.rows = matrix.cols = std::max<size_t>(1, n / kSpmvRowNonzeros);
+    matrix.row_offsets.resize(matrix.rows + 1);
+    matrix.col_indices.resize(n);
+    matrix.values.assign(n, T(1));
+    for (size_t i = 0; i <= matrix.rows; ++i) {
+      matrix.row_offsets[i] = std::min(n, i * kSpmvRowNonzeros);
+    }
+    matrix.row_offsets[matrix.rows] = n;
+    for (size_t k = 0; k < n; ++k) {
+      matrix.col_indices[k] = (k / kSpmvRowNonzeros + k % kSpmvRowNonzeros) %
+                              matrix.cols;
+    }
+  }
+  return matrix;
+}
+
+// Sparse matrix-vector product with state.range(0) nonzeros; streams a value
+// and a column index per nonzero
+template <typename T>
+void bm_spmv(benchmark::State& state, AlgorithmBackend backend) {
+  size_t n = static_cast<size_t>(state.range(0));
+  if (n * (sizeof(T) + sizeof(size_t)) * 2 > memory_budget()) {
+    state.SkipWithError("working set exceeds the memory budget");
+    return;
+  }
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const CsrMatrix<T>& matrix = spmv_matrix<T>(n);
+  std::vector<T> x(matrix.cols, T(1));
+  std::vector<T> y(matrix.rows);
+  std::vector<size_t> rows(backend == AlgorithmBackend::StdPar ? matrix.rows
+                                                               : 0);
+  std::iota(rows.begin(), rows.end(), size_t(0));
+
+  for (auto _ : state) {
+    switch (backend) {
+      case AlgorithmBackend::Std:
+        csr_rows_multiply(matrix, x.data(), y.data(), 0, matrix.rows);
+        break;
+      case AlgorithmBackend::StdPar:
+#if AMS562_PARALLEL_STL
+        std::for_each(std::execution::par, rows.begin(), rows.end(),
+                      [&](size_t i) {
+                        csr_rows_multiply(matrix, x.data(), y.data(), i,
+                                          i + 1);
+                      });
+#endif
+        break;
+      case AlgorithmBackend::Threads:
+        parallel_spmv_threads(pool_for(threads), matrix, x, y, threads);
+        break;
+    }
+    benchmark::DoNotOptimize(y.data());
+    benchmark::ClobberMemory();
+  }
+  report(state, sizeof(T) + sizeof(size_t));
+}
+
+// Sort of state.range(0) random keys. Every iteration first copies the
+// unsorted keys into the work buffer, for all backends alike; counts one
+// read and one write per element.
+template <typename T>
+void bm_sort(benchmark::State& state, AlgorithmBackend backend) {
+  if (!prepare(state, sizeof(T))) return;
+  size_t n = static_cast<size_t>(state.range(0));
+  unsigned int threads = static_cast<unsigned int>(state.range(1));
+  const T* keys = random_buffer<T>(0, n);
+  T* data = buffer<T>(2, n);
+
+  for (auto _ : state) {
+    std::copy(keys, keys + n, data);
+    switch (backend) {
+      case AlgorithmBackend::Std:
+        std::sort(data, data + n);
+        break;
+      case AlgorithmBackend::StdPar:
+#if AMS562_PARALLEL_STL
+        std::sort(std::execution::par, data, data + n);
+#endif
+        break;
+      case AlgorithmBackend::Threads:
+        parallel_radix_sort_threads(pool_for(threads), data, data + n,
+                                    threads);
+        break;
+    }
+    benchmark::DoNotOptimize(data);
+    benchmark::ClobberMemory();
+  }
+  report(state, 2 * sizeof(T));
+}
+
+// Sweep of sizes 1K, 8K, ..., max_elements() at the given thread counts
+void apply_sweep(benchmark::internal::Benchmark* bench,
+                 const std::vector<int64_t>& thread_counts) {
+  std::vector<int64_t> sizes;
+  for (int64_t n = 1 << 10; n < max_elements(); n *= 8) sizes.push_back(n);
+  sizes.push_back(max_elements());
+
+  bench->ArgsProduct({sizes, thread_counts})
+      ->ArgNames({"n", "threads"})
+      ->UseRealTime()
+      ->ComputeStatistics("min", [](const std::vector<double>& v) {
+        return *std::min_element(v.begin(), v.end());
+      });
+}
+
+// Sweep shared by most benchmarks: thread counts 1, 2, 4, ..., hardware
+// concurrency (serial and self-scheduled runs use 1)
+void apply_sweep(benchmark::internal::Benchmark* bench, bool parallel) {
+  std::vector<int64_t> thread_counts = {1};
+  if (parallel) {
+    int64_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (int64_t t = 2; t < hardware; t *= 2) thread_counts.push_back(t);
+    if (hardware > 1) thread_counts.push_back(hardware);
+  }
+  apply_sweep(bench, thread_counts);
+}
+
+template <typename T>
+void register_type(const std::string& type) {
+  for (Backend backend : {Backend::Std, Backend::Threads, Backend::OpenMP,
+                          Backend::Stealing}) {
+    std::vector<AccumulationMode> modes = {AccumulationMode::Fast};
+    if (backend != Backend::Std && std::is_floating_point_v<T>) {
+      modes.push_back(AccumulationMode::Compensated);
+      modes.push_back(AccumulationMode::Reproducible);
+    }
+    for (AccumulationMode mode : modes) {
+      std::string name = std::string("inner_product/") +
+                         backend_name(backend) + "/" + type;
+      if (backend != Backend::Std) name += std::string("/") + mode_name(mode);
+      apply_sweep(benchmark::RegisterBenchmark(name.c_str(),
+                                               bm_inner_product<T>, backend,
+                                               mode),
+                  backend != Backend::Std);
+    }
+  }
+
+  for (Backend backend : {Backend::Std, Backend::Threads, Backend::OpenMP,
+                          Backend::Stealing}) {
+    std::vector<ScanMode> modes = {ScanMode::ScanThenAdd};
+    if (backend == Backend::Stealing) {
+      modes = {ScanMode::ReduceThenScan};
+    } else if (backend != Backend::Std) {
+      modes.push_back(ScanMode::DecoupledLookback);
+      modes.push_back(ScanMode::ReduceThenScan);
+    }
+    for (ScanMode mode : modes) {
+      std::string name = std::string("inclusive_scan/") +
+                         backend_name(backend) + "/" + type;
+      if (backend != Backend::Std) name += std::string("/") + mode_name(mode);
+      apply_sweep(benchmark::RegisterBenchmark(name.c_str(),
+                                               bm_inclusive_scan<T>, backend,
+                                               mode),
+                  backend != Backend::Std);
+    }
+  }
+
+  for (Backend backend : {Backend::Threads, Backend::Stealing}) {
+    std::string suffix = std::string("/") + backend_name(backend) + "/" + type;
+    apply_sweep(
+        benchmark::RegisterBenchmark(("contended/inner_product" + suffix).c_str(),
+                                     bm_contended<T>, backend, false),
+        true);
+    apply_sweep(
+        benchmark::RegisterBenchmark(("contended/inclusive_scan" + suffix).c_str(),
+                                     bm_contended<T>, backend, true),
+        true);
+  }
+
+  for (Backend backend : {Backend::Threads, Backend::OpenMP}) {
+    std::string name = std::string("fused_inner_product/") +
+                       backend_name(backend) + "/" + type;
+    apply_sweep(benchmark::RegisterBenchmark(name.c_str(),
+                                             bm_fused_inner_product<T>,
+                                             backend),
+                true);
+  }
+
+  // The NUMA executor always uses every CPU of every node, so both
+  // placements run at full machine width
+  const std::vector<int64_t> machine = {
+      static_cast<int64_t>(std::max(1u, std::thread::hardware_concurrency()))};
+  for (Placement placement : {Placement::MainThread, Placement::FirstTouch}) {
+    for (Backend backend : {Backend::Threads, Backend::OpenMP}) {
+      std::string name = std::string("numa/inner_product/") +
+                         backend_name(backend) + "/" +
+                         placement_name(placement) + "/" + type;
+      apply_sweep(benchmark::RegisterBenchmark(name.c_str(),
+                                               bm_numa_inner_product<T>,
+                                               backend, placement),
+                  machine);
+    }
+    std::string name = std::string("numa/inclusive_scan/threads/") +
+                       placement_name(placement) + "/" + type;
+    apply_sweep(benchmark::RegisterBenchmark(name.c_str(),
+                                             bm_numa_inclusive_scan<T>,
+                                             placement),
+                machine);
+  }
+
+  std::vector<AlgorithmBackend> algorithm_backends = {AlgorithmBackend::Std};
+#if AMS562_PARALLEL_STL
+  algorithm_backends.push_back(AlgorithmBackend::StdPar);
+#endif
+  algorithm_backends.push_back(AlgorithmBackend::Threads);
+  for (AlgorithmBackend backend : algorithm_backends) {
+    // std::execution::par picks its own thread count, so like std it runs
+    // once per size
+    bool parallel = backend == AlgorithmBackend::Threads;
+    std::string suffix = std::string("/") + backend_name(backend) + "/" + type;
+    apply_sweep(benchmark::RegisterBenchmark(("copy_if" + suffix).c_str(),
+                                             bm_copy_if<T>, backend),
+                parallel);
+    apply_sweep(benchmark::RegisterBenchmark(("partition" + suffix).c_str(),
+                                             bm_partition<T>, backend),
+                parallel);
+    apply_sweep(benchmark::RegisterBenchmark(("spmv" + suffix).c_str(),
+                                             bm_spmv<T>, backend),
+                parallel);
+    apply_sweep(benchmark::RegisterBenchmark(("sort" + suffix).c_str(),
+                                             bm_sort<T>, backend),
+                parallel);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  apply_sweep(benchmark::RegisterBenchmark(
+                  "aggregate_slots/packed",
+                  bm_aggregate_slots<std::vector<double>>),
+              true);
+  apply_sweep(benchmark::RegisterBenchmark(
+                  "aggregate_slots/padded",
+                  bm_aggregate_slots<PaddedSlots<double>>),
+              true);
+  register_type<float>("float");
+  register_type<double>("double");
+  register_type<int32_t>("int32");
+  register_type<int64_t>("int64");
+
+  benchmark::AddCustomContext("max_elements", std::to_string(max_elements()));
+  benchmark::AddCustomContext("memory_budget_bytes",
+                              std::to_string(memory_budget()));
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
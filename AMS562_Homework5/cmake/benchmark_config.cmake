@@ -0,0 +1,23 @@
+# cmake/benchmark_config.cmake
+# ------------------------------------------------------------------
+# Find Google Benchmark, or download and build it using FetchContent
+# ------------------------------------------------------------------
+find_package(benchmark QUIET)
+
+if(benchmark_FOUND)
+    message(STATUS "Using installed Google Benchmark ${benchmark_VERSION}.")
+else()
+    include(FetchContent)
+
+    FetchContent_Declare(
+        googlebenchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG v1.8.3
+    )
+
+    # Only the library is needed, not its tests
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+    FetchContent_MakeAvailable(googlebenchmark)
+endif()
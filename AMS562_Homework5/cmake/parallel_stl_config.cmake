@@ -0,0 +1,16 @@
+# cmake/parallel_stl_config.cmake
+# ------------------------------------------------------------------
+# The std::execution parallel policies of libstdc++ run on TBB. Targets that
+# compare against them link parallel_stl, which defines AMS562_PARALLEL_STL=1
+# when TBB is found; without TBB the comparisons are compiled out.
+# ------------------------------------------------------------------
+find_package(TBB QUIET)
+
+add_library(parallel_stl INTERFACE)
+if(TBB_FOUND)
+    message(STATUS "Parallel STL (std::execution) enabled with TBB ${TBB_VERSION}.")
+    target_link_libraries(parallel_stl INTERFACE TBB::tbb)
+    target_compile_definitions(parallel_stl INTERFACE AMS562_PARALLEL_STL=1)
+else()
+    message(STATUS "TBB was not found; std::execution comparisons are disabled.")
+endif()
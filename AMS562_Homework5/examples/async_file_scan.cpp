@@ -0,0 +1,137 @@
+// examples/async_file_scan.cpp
+
+// Overview:
+// This demo computes the running sum of a binary file of int64 values in
+// chunks with the coroutine API of async_primitives.hpp. The pipelined
+// version reads chunk k + 1 on the pool while chunk k is being scanned; the
+// blocking version reads and scans one chunk after the other. Both carry the
+// running total from chunk to chunk.
+//
+// Usage: async_file_scan [file] [chunk_elements]
+// Without a file argument a temporary input file is written first.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "async_primitives.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// Reads up to chunk_elements values into buffer; returns the number read
+size_t read_chunk(std::ifstream& in, std::vector<int64_t>& buffer,
+                  size_t chunk_elements) {
+  buffer.resize(chunk_elements);
+  in.read(reinterpret_cast<char*>(buffer.data()),
+          static_cast<std::streamsize>(chunk_elements * sizeof(int64_t)));
+  buffer.resize(static_cast<size_t>(in.gcount()) / sizeof(int64_t));
+  return buffer.size();
+}
+
+// Adds carry to the first element, scans the chunk in place and returns the
+// new running total
+AsyncTask<int64_t> scan_chunk(ThreadPool& pool, std::vector<int64_t>& chunk,
+                              int64_t carry) {
+  chunk.front() += carry;
+  co_await async_inclusive_scan(pool, chunk);
+  co_return chunk.back();
+}
+
+// Scans the file chunk by chunk, reading the next chunk while the current one
+// is scanned (double buffering)
+AsyncTask<int64_t> pipelined_scan(ThreadPool& pool, const std::string& path,
+                                  size_t chunk_elements) {
+  std::ifstream in(path, std::ios::binary);
+  std::vector<int64_t> buffers[2];
+  AsyncResult<size_t> pending = async_run(pool, [&]() {
+    return read_chunk(in, buffers[0], chunk_elements);
+  });
+  int64_t total = 0;
+  for (size_t k = 0;; ++k) {
+    if (co_await pending == 0) break;
+    std::vector<int64_t>& next = buffers[(k + 1) % 2];
+    pending = async_run(pool, [&in, &next, chunk_elements]() {
+      return read_chunk(in, next, chunk_elements);
+    });
+    total = co_await scan_chunk(pool, buffers[k % 2], total);
+  }
+  co_return total;
+}
+
+// Reads and scans the file one chunk after the other
+int64_t blocking_scan(const std::string& path, size_t chunk_elements) {
+  std::ifstream in(path, std::ios::binary);
+  std::vector<int64_t> buffer;
+  int64_t total = 0;
+  while (read_chunk(in, buffer, chunk_elements) > 0) {
+    buffer.front() += total;
+    parallel_inclusive_scan_threads(buffer);
+    total = buffer.back();
+  }
+  return total;
+}
+
+// Writes count values to path; returns their sum
+int64_t write_input(const std::string& path, size_t count) {
+  std::ofstream out(path, std::ios::binary);
+  std::vector<int64_t> block(1 << 16);
+  int64_t sum = 0;
+  for (size_t written = 0; written < count; written += block.size()) {
+    size_t n = std::min(block.size(), count - written);
+    for (size_t i = 0; i < n; ++i) {
+      block[i] = static_cast<int64_t>((written + i) % 1000) - 500;
+      sum += block[i];
+    }
+    out.write(reinterpret_cast<const char*>(block.data()),
+              static_cast<std::streamsize>(n * sizeof(int64_t)));
+  }
+  return sum;
+}
+
+template <typename Func>
+double measure_ms(Func&& func) {
+  auto start = std::chrono::high_resolution_clock::now();
+  func();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string path = argc > 1 ? argv[1] : "async_file_scan_input.bin";
+  size_t chunk_elements = argc > 2 ? std::stoul(argv[2]) : (1u << 20);
+  bool temporary = argc <= 1;
+  if (chunk_elements == 0) {
+    std::cerr << "chunk_elements must be positive\n";
+    return 1;
+  }
+  if (temporary) {
+    std::cout << "Writing 32M values to " << path << "\n";
+    std::cout << "Expected total: " << write_input(path, size_t(1) << 25)
+              << "\n";
+  }
+
+  ThreadPool& pool = default_thread_pool();
+  int64_t pipelined_total = 0, blocking_total = 0;
+  double pipelined = measure_ms([&]() {
+    pipelined_total = sync_wait(pipelined_scan(pool, path, chunk_elements));
+  });
+  double blocking =
+      measure_ms([&]() { blocking_total = blocking_scan(path, chunk_elements); });
+
+  std::cout << "Chunk size: " << chunk_elements << " values, pool of "
+            << pool.size() << " workers\n"
+            << "Pipelined read + scan: " << pipelined << " ms (total "
+            << pipelined_total << ")\n"
+            << "Blocking read + scan:  " << blocking << " ms (total "
+            << blocking_total << ")\n";
+
+  if (temporary) std::remove(path.c_str());
+  return pipelined_total == blocking_total ? 0 : 1;
+}
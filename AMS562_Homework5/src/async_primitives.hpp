@@ -0,0 +1,417 @@
+// src/async_primitives.hpp
+
+#ifndef ASYNC_PRIMITIVES_HPP
+#define ASYNC_PRIMITIVES_HPP
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "async_primitives.hpp needs C++20 coroutines (compile with -std=c++20)"
+#endif
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "auto_tune.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inner_product_threads.hpp"
+#include "range_traits.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief This header file contains C++20 coroutine variants of the threads
+ * primitives, so that a caller can overlap a reduction or scan with other
+ * work (e.g. I/O) instead of blocking in the call.
+ *
+ * async_inner_product, async_inclusive_scan, async_exclusive_scan and the
+ * generic async_run start their work on a ThreadPool immediately and return
+ * an AsyncResult. A coroutine co_awaits the AsyncResult when it needs the
+ * value; if the work is still running, the coroutine is suspended and
+ * resumed by the pool worker that finishes it. Plain code can call get().
+ *
+ * AsyncTask<T> is the coroutine type for code that awaits these results. It
+ * starts when it is awaited (or passed to sync_wait), and can itself be
+ * awaited by another AsyncTask:
+ *
+ *   AsyncTask<double> norm2(ThreadPool& pool, const std::vector<double>& v) {
+ *     AsyncResult<double> dot = async_inner_product(pool, v, v);
+ *     do_other_work();
+ *     co_return co_await dot;
+ *   }
+ *   double n = sync_wait(norm2(pool, v));
+ *
+ * The inputs of an asynchronous call must stay alive (and unchanged) until
+ * its result has been awaited. This header must be compiled as C++20; the
+ * rest of the library remains C++17.
+ */
+
+namespace async_detail {
+
+// Value slot of a result; void results store std::monostate
+template <typename T>
+using stored_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// State shared by an AsyncResult and the pool task that completes it
+template <typename T>
+struct ResultState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  std::optional<stored_t<T>> value;
+  std::exception_ptr error;
+  std::coroutine_handle<> continuation;
+
+  // Stores the outcome and resumes the awaiting coroutine, if any, on the
+  // calling (pool) thread
+  void complete() {
+    std::coroutine_handle<> resume;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done = true;
+      resume = std::exchange(continuation, nullptr);
+    }
+    cv.notify_all();
+    if (resume) resume.resume();
+  }
+};
+
+}  // namespace async_detail
+
+/**
+ * @brief Result of work started on a thread pool; co_await it in a
+ * coroutine, or call get() to block
+ */
+template <typename T>
+class [[nodiscard]] AsyncResult {
+ public:
+  using State = async_detail::ResultState<T>;
+
+  AsyncResult() = default;
+  explicit AsyncResult(std::shared_ptr<State> state)
+      : state_(std::move(state)) {}
+
+  /**
+   * @brief Whether the result holds started work that has not been consumed
+   */
+  bool valid() const { return state_ != nullptr; }
+
+  /**
+   * @brief Whether the work has finished
+   */
+  bool ready() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->done;
+  }
+
+  /**
+   * @brief Blocks until the work has finished and returns its result (or
+   * rethrows its exception)
+   */
+  T get() {
+    {
+      std::unique_lock<std::mutex> lock(state_->mutex);
+      state_->cv.wait(lock, [&]() { return state_->done; });
+    }
+    return take();
+  }
+
+  bool await_ready() const { return ready(); }
+
+  // Suspends the awaiting coroutine unless the work finished meanwhile
+  bool await_suspend(std::coroutine_handle<> awaiting) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->done) return false;
+    state_->continuation = awaiting;
+    return true;
+  }
+
+  T await_resume() { return take(); }
+
+ private:
+  T take() {
+    std::shared_ptr<State> state = std::move(state_);
+    if (state->error) std::rethrow_exception(state->error);
+    if constexpr (!std::is_void_v<T>) return std::move(*state->value);
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Starts f() on the pool and returns its result as an AsyncResult
+ */
+template <typename F>
+AsyncResult<std::invoke_result_t<std::decay_t<F>>> async_run(ThreadPool& pool,
+                                                             F&& f) {
+  using T = std::invoke_result_t<std::decay_t<F>>;
+  auto state = std::make_shared<async_detail::ResultState<T>>();
+  pool.submit([state, f = std::forward<F>(f)]() mutable {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        f();
+        state->value.emplace();
+      } else {
+        state->value.emplace(f());
+      }
+    } catch (...) {
+      state->error = std::current_exception();
+    }
+    state->complete();
+  });
+  return AsyncResult<T>(std::move(state));
+}
+
+/**
+ * @brief Starts f() on the process-wide thread pool
+ */
+template <typename F>
+AsyncResult<std::invoke_result_t<std::decay_t<F>>> async_run(F&& f) {
+  return async_run(default_thread_pool(), std::forward<F>(f));
+}
+
+namespace async_detail {
+
+// Return-value half of an AsyncTask promise
+template <typename T>
+struct TaskValue {
+  std::optional<T> value;
+  template <typename U>
+  void return_value(U&& v) {
+    value.emplace(std::forward<U>(v));
+  }
+  T take() { return std::move(*value); }
+};
+
+template <>
+struct TaskValue<void> {
+  void return_void() {}
+  void take() {}
+};
+
+}  // namespace async_detail
+
+/**
+ * @brief Lazily started coroutine that returns T; co_await it from another
+ * AsyncTask, or run it with sync_wait
+ */
+template <typename T = void>
+class [[nodiscard]] AsyncTask {
+ public:
+  struct promise_type;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  struct promise_type : async_detail::TaskValue<T> {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    AsyncTask get_return_object() {
+      return AsyncTask(handle_type::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Transfers control to the awaiting coroutine when the body finishes
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(handle_type finished) noexcept {
+        return finished.promise().continuation;
+      }
+      void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+  AsyncTask(AsyncTask&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  AsyncTask& operator=(AsyncTask&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  AsyncTask(const AsyncTask&) = delete;
+  AsyncTask& operator=(const AsyncTask&) = delete;
+  ~AsyncTask() {
+    if (handle_) handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  // Starts the task; it resumes the awaiting coroutine when it finishes
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+
+  T await_resume() {
+    promise_type& promise = handle_.promise();
+    if (promise.error) std::rethrow_exception(promise.error);
+    return promise.take();
+  }
+
+ private:
+  explicit AsyncTask(handle_type handle) : handle_(handle) {}
+
+  handle_type handle_;
+};
+
+namespace async_detail {
+
+// Coroutine that starts immediately and destroys itself when it finishes
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Awaits task and completes state with its outcome
+template <typename T>
+DetachedTask sync_wait_body(AsyncTask<T>& task, ResultState<T>& state) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await task;
+      state.value.emplace();
+    } else {
+      state.value.emplace(co_await task);
+    }
+  } catch (...) {
+    state.error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.done = true;
+  state.cv.notify_all();
+}
+
+}  // namespace async_detail
+
+/**
+ * @brief Runs an AsyncTask to completion, blocking the calling thread, and
+ * returns its result (or rethrows its exception)
+ *
+ * The task starts on the calling thread; after its first suspension it
+ * continues on the pool workers that complete the awaited results.
+ */
+template <typename T>
+T sync_wait(AsyncTask<T> task) {
+  async_detail::ResultState<T> state;
+  async_detail::sync_wait_body(task, state);
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.cv.wait(lock, [&]() { return state.done; });
+  if (state.error) std::rethrow_exception(state.error);
+  if constexpr (!std::is_void_v<T>) return std::move(*state.value);
+}
+
+/**
+ * @brief Starts the inner product of two iterator ranges on a thread pool
+ * (see parallel_inner_product_threads); the ranges must outlive the result
+ */
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+AsyncResult<iter_value_t<It1>> async_inner_product(
+    ThreadPool& pool, It1 first1, It1 last1, It2 first2,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  return async_run(pool, [&pool, first1, last1, first2, num_threads, mode]() {
+    return parallel_inner_product_threads(pool, first1, last1, first2,
+                                          num_threads, mode);
+  });
+}
+
+/**
+ * @brief Starts the inner product of two vectors on a thread pool; the
+ * vectors must outlive the result
+ * @throws std::invalid_argument (immediately) if the sizes differ
+ */
+template <typename T>
+AsyncResult<T> async_inner_product(
+    ThreadPool& pool, const std::vector<T>& a, const std::vector<T>& b,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return async_inner_product(pool, a.begin(), a.end(), b.begin(), num_threads,
+                             mode);
+}
+
+/**
+ * @brief Starts the inner product of two vectors on the process-wide pool
+ */
+template <typename T>
+AsyncResult<T> async_inner_product(
+    const std::vector<T>& a, const std::vector<T>& b,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  return async_inner_product(default_thread_pool(), a, b, num_threads, mode);
+}
+
+/**
+ * @brief Starts an inclusive scan of an iterator range on a thread pool (see
+ * parallel_inclusive_scan_threads); d_first may equal first
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+AsyncResult<void> async_inclusive_scan(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  return async_run(pool,
+                   [&pool, first, last, d_first, num_threads, mode]() {
+                     parallel_inclusive_scan_threads(pool, first, last,
+                                                     d_first, num_threads,
+                                                     mode);
+                   });
+}
+
+/**
+ * @brief Starts an in-place inclusive scan of a vector on a thread pool
+ */
+template <typename T>
+AsyncResult<void> async_inclusive_scan(
+    ThreadPool& pool, std::vector<T>& data,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  return async_inclusive_scan(pool, data.begin(), data.end(), data.begin(),
+                              num_threads, mode);
+}
+
+/**
+ * @brief Starts an in-place inclusive scan of a vector on the process-wide
+ * pool
+ */
+template <typename T>
+AsyncResult<void> async_inclusive_scan(
+    std::vector<T>& data, unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  return async_inclusive_scan(default_thread_pool(), data, num_threads, mode);
+}
+
+/**
+ * @brief Starts an exclusive scan of an iterator range on a thread pool (see
+ * parallel_exclusive_scan_threads); d_first may equal first
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+AsyncResult<void> async_exclusive_scan(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  return async_run(pool,
+                   [&pool, first, last, d_first, num_threads, mode]() {
+                     parallel_exclusive_scan_threads(pool, first, last,
+                                                     d_first, num_threads,
+                                                     mode);
+                   });
+}
+
+#endif  // ASYNC_PRIMITIVES_HPP
@@ -0,0 +1,422 @@
+// src/auto_tune.hpp
+
+#ifndef AUTO_TUNE_HPP
+#define AUTO_TUNE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "thread_pool.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief This header file implements the auto-tuning layer that decides, per
+ * primitive and element type, whether a call runs serially and into how many
+ * chunks a parallel call is split.
+ *
+ * A profile is calibrated the first time a primitive is called with a given
+ * element type: the serial cost per element and the cost of one parallel
+ * dispatch are measured (a few milliseconds in total), and a cost model turns
+ * them into a serial cutoff and a grain size. Profiles can be persisted to a
+ * file named by the AMS562_TUNING_PROFILE environment variable, so later runs
+ * skip the calibration.
+ *
+ * The primitives tune themselves when their num_threads argument is
+ * kAutoThreads (the default); an explicit thread count bypasses the tuner.
+ */
+
+/**
+ * @brief num_threads value that lets the auto-tuner pick the chunk count
+ */
+constexpr unsigned int kAutoThreads = 0;
+
+/**
+ * @brief Tuned parameters of one primitive for one element type
+ */
+struct TuningProfile {
+  /// Inputs with fewer elements run serially on the calling thread
+  size_t serial_cutoff = 0;
+  /// Minimum number of elements per parallel chunk
+  size_t grain_size = 1;
+};
+
+/**
+ * @brief Splits n elements into chunks according to a profile
+ * @param profile The tuned parameters
+ * @param n Number of elements
+ * @param max_chunks Number of workers available (the upper bound)
+ * @return 1 for a serial run, otherwise the number of chunks
+ */
+inline unsigned int plan_chunks(const TuningProfile& profile, size_t n,
+                                unsigned int max_chunks) {
+  if (n < profile.serial_cutoff || max_chunks <= 1) return 1;
+  size_t chunks = n / std::max<size_t>(1, profile.grain_size);
+  return static_cast<unsigned int>(
+      std::clamp<size_t>(chunks, 1, max_chunks));
+}
+
+/**
+ * @brief Turns the measured costs into a profile
+ * @param element_seconds Serial cost of one element
+ * @param dispatch_seconds Cost of one parallel call with empty tasks
+ * @param workers Number of workers a parallel call runs on
+ *
+ * A chunk must do at least 20 times the dispatch cost in useful work, and a
+ * parallel call must save more than its dispatch cost:
+ * n * element_seconds * (1 - 1 / workers) > dispatch_seconds.
+ */
+inline TuningProfile model_profile(double element_seconds,
+                                   double dispatch_seconds,
+                                   unsigned int workers) {
+  constexpr size_t kMinGrain = 1024;
+  constexpr size_t kMaxGrain = size_t(1) << 22;
+  TuningProfile profile;
+  element_seconds = std::max(element_seconds, 1e-12);
+  double grain = 20.0 * dispatch_seconds / element_seconds;
+  profile.grain_size = static_cast<size_t>(
+      std::clamp(grain, double(kMinGrain), double(kMaxGrain)));
+  if (workers <= 1) {
+    profile.serial_cutoff = std::numeric_limits<size_t>::max();
+  } else {
+    double cutoff = dispatch_seconds / (element_seconds * (1.0 - 1.0 / workers));
+    profile.serial_cutoff = std::max<size_t>(
+        2 * kMinGrain,
+        static_cast<size_t>(std::min(cutoff, double(kMaxGrain) * workers)));
+  }
+  return profile;
+}
+
+/**
+ * @brief Keeps the compiler from optimizing away a calibration result (and
+ * any stores to memory before it)
+ */
+template <typename T>
+inline void keep_result(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * @brief Returns the fastest of several runs of f, in seconds
+ */
+template <typename F>
+double measure_seconds(F&& f, int runs = 5) {
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < runs; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+/**
+ * @brief Number of threads that can run a parallel_for of a pool at once: its
+ * workers plus the calling thread, bounded by the hardware concurrency
+ */
+inline unsigned int pool_workers(const ThreadPool& pool) {
+  // hardware_concurrency() may read sysfs on every call, so it is cached
+  static const unsigned int hardware =
+      std::max(1u, std::thread::hardware_concurrency());
+  return std::min(pool.size() + 1, hardware);
+}
+
+/**
+ * @brief Measures the cost of one parallel_for over every worker of a pool
+ */
+inline double measure_pool_dispatch(ThreadPool& pool) {
+  size_t tasks = pool_workers(pool);
+  return measure_seconds([&]() { pool.parallel_for(tasks, [](size_t) {}); },
+                         20);
+}
+
+#ifdef _OPENMP
+/**
+ * @brief Measures the cost of one OpenMP parallel region running a taskloop
+ * with one empty task per thread
+ */
+inline double measure_openmp_dispatch() {
+  int threads = omp_get_max_threads();
+  return measure_seconds(
+      [&]() {
+#pragma omp parallel
+#pragma omp single nowait
+        {
+#pragma omp taskloop grainsize(1)
+          for (int t = 0; t < threads; ++t) {
+          }
+        }
+      },
+      20);
+}
+#endif  // _OPENMP
+
+/**
+ * @brief Call-site copy of a profile, valid while the tuner's generation is
+ * unchanged
+ */
+struct CachedProfile {
+  uint64_t generation = 0;  ///< 0 never matches a tuner generation
+  unsigned int workers = 0;  ///< worker count the profile was looked up for
+  TuningProfile profile;
+};
+
+/**
+ * @brief Returns the key under which the profile of a primitive calibrated
+ * for a given number of workers is stored, e.g. "scan_threads:l:St4plusIlE@4"
+ */
+inline std::string worker_profile_key(const std::string& key,
+                                      unsigned int workers) {
+  return key + '@' + std::to_string(workers);
+}
+
+/**
+ * @brief Process-wide table of tuning profiles keyed by primitive and type
+ */
+class AutoTuner {
+ public:
+  /**
+   * @brief Creates an empty tuner; the default tuner loads the file named by
+   * AMS562_TUNING_PROFILE, if any
+   */
+  explicit AutoTuner(std::string path = std::string()) : path_(std::move(path)) {
+    if (!path_.empty()) load(path_);
+  }
+
+  /**
+   * @brief Returns the profile stored under key, calibrating it on first use
+   * @param key Primitive and element type, e.g. profile_key<T>("scan_threads")
+   * @param calibrate Callable returning a TuningProfile
+   *
+   * Calibration runs without holding the table lock, so concurrent first
+   * calls may calibrate twice; the first stored profile wins.
+   */
+  template <typename Calibrate>
+  TuningProfile profile(const std::string& key, Calibrate&& calibrate) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = profiles_.find(key);
+      if (it != profiles_.end()) return it->second;
+    }
+    TuningProfile calibrated = calibrate();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = profiles_.emplace(key, calibrated);
+    if (inserted.second && !path_.empty()) save_locked(path_);
+    return inserted.first->second;
+  }
+
+  /**
+   * @brief Returns the profile stored under key through a call-site cache, so
+   * repeated calls skip the table lock and the key lookup
+   * @param key Primitive and element type
+   * @param cache Cache owned by the call site (one per thread and key)
+   * @param calibrate Callable returning a TuningProfile
+   */
+  template <typename Calibrate>
+  TuningProfile profile(const std::string& key, CachedProfile& cache,
+                        Calibrate&& calibrate) {
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (cache.generation != generation) {
+      cache.profile = profile(key, calibrate);
+      cache.generation = generation;
+    }
+    return cache.profile;
+  }
+
+  /**
+   * @brief Returns the profile of a primitive for a given number of workers
+   * through a call-site cache
+   * @param key Primitive and element type
+   * @param workers Number of workers the primitive runs on
+   * @param cache Cache owned by the call site (one per thread and key)
+   * @param calibrate Callable returning a TuningProfile for that many workers
+   *
+   * A profile stored under key itself (set by hand or loaded) applies to
+   * every worker count. Otherwise the profile is calibrated and stored per
+   * worker count, under worker_profile_key(key, workers), so pools of
+   * different sizes do not share a cutoff and grain.
+   */
+  template <typename Calibrate>
+  TuningProfile profile(const std::string& key, unsigned int workers,
+                        CachedProfile& cache, Calibrate&& calibrate) {
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (cache.generation == generation && cache.workers == workers) {
+      return cache.profile;
+    }
+    bool found = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = profiles_.find(key);
+      if (it != profiles_.end()) {
+        cache.profile = it->second;
+        found = true;
+      }
+    }
+    if (!found) {
+      cache.profile = profile(worker_profile_key(key, workers), calibrate);
+    }
+    cache.generation = generation;
+    cache.workers = workers;
+    return cache.profile;
+  }
+
+  /**
+   * @brief Stores a profile, replacing any calibrated one
+   */
+  void set(const std::string& key, const TuningProfile& profile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    profiles_[key] = profile;
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Returns whether a profile is stored under key
+   */
+  bool contains(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return profiles_.count(key) != 0;
+  }
+
+  /**
+   * @brief Drops every profile, so the next calls calibrate again
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    profiles_.clear();
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Adds the profiles of a file written by save()
+   * @return false if the file cannot be read
+   *
+   * Every line holds "key serial_cutoff grain_size"; malformed lines are
+   * skipped.
+   */
+  bool load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      std::string key;
+      TuningProfile profile;
+      if (fields >> key >> profile.serial_cutoff >> profile.grain_size) {
+        profiles_[key] = profile;
+      }
+    }
+    generation_.fetch_add(1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Writes every profile to a file
+   * @return false if the file cannot be written
+   */
+  bool save(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return save_locked(path);
+  }
+
+ private:
+  bool save_locked(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    for (const auto& entry : profiles_) {
+      out << entry.first << ' ' << entry.second.serial_cutoff << ' '
+          << entry.second.grain_size << '\n';
+    }
+    return static_cast<bool>(out);
+  }
+
+  std::string path_;
+  std::atomic<uint64_t> generation_{1};  // bumped whenever profiles change
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, TuningProfile> profiles_;
+};
+
+/**
+ * @brief Returns the process-wide tuner used by the primitives
+ */
+inline AutoTuner& auto_tuner() {
+  static AutoTuner tuner([]() {
+    const char* path = std::getenv("AMS562_TUNING_PROFILE");
+    return path ? std::string(path) : std::string();
+  }());
+  return tuner;
+}
+
+/**
+ * @brief Builds the profile key of a primitive for the given types (element
+ * type first, then e.g. the binary operation)
+ */
+template <typename... Types>
+std::string profile_key(const char* primitive) {
+  std::string key(primitive);
+  ((key += ':', key += typeid(Types).name()), ...);
+  return key;
+}
+
+/**
+ * @brief Returns the calibrated profile of a threads-based primitive; each
+ * pool size is calibrated separately
+ * @param pool The pool the primitive runs on
+ * @param key Profile key (see profile_key)
+ * @param cache Call-site cache (see CachedProfile)
+ * @param serial_kernel Callable that processes kernel_elements elements
+ * serially
+ * @param kernel_elements Number of elements serial_kernel processes
+ */
+template <typename Kernel>
+TuningProfile pool_profile(ThreadPool& pool, const std::string& key,
+                           CachedProfile& cache, Kernel&& serial_kernel,
+                           size_t kernel_elements) {
+  return auto_tuner().profile(key, pool.size(), cache, [&]() {
+    double element = measure_seconds(serial_kernel) / kernel_elements;
+    return model_profile(element, measure_pool_dispatch(pool),
+                         pool_workers(pool));
+  });
+}
+
+#ifdef _OPENMP
+/**
+ * @brief Returns the calibrated profile of an OpenMP primitive (see
+ * pool_profile); each omp_get_max_threads() value is calibrated separately
+ */
+template <typename Kernel>
+TuningProfile openmp_profile(const std::string& key, CachedProfile& cache,
+                             Kernel&& serial_kernel, size_t kernel_elements) {
+  const unsigned int threads =
+      static_cast<unsigned int>(omp_get_max_threads());
+  return auto_tuner().profile(key, threads, cache, [&]() {
+    double element = measure_seconds(serial_kernel) / kernel_elements;
+    return model_profile(element, measure_openmp_dispatch(), threads);
+  });
+}
+#endif  // _OPENMP
+
+/**
+ * @brief Number of elements the calibration kernels run on
+ */
+constexpr size_t kCalibrationElements = size_t(1) << 14;
+
+#endif  // AUTO_TUNE_HPP
@@ -0,0 +1,375 @@
+// src/execution_policy.hpp
+
+#ifndef EXECUTION_POLICY_HPP
+#define EXECUTION_POLICY_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
+#include "auto_tune.hpp"
+#include "inclusive_scan_openmp.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inner_product_openmp.hpp"
+#include "inner_product_threads.hpp"
+#include "range_traits.hpp"
+#include "stealing_primitives.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief This header file contains a policy-dispatched front end for the
+ * primitives, modelled on the std::execution overloads of <numeric>:
+ *
+ *   ams562::inner_product(ams562::execution::openmp, a.begin(), a.end(),
+ *                         b.begin(), 0.0);
+ *   ams562::inclusive_scan(ams562::execution::runtime, in.begin(), in.end(),
+ *                          out.begin());
+ *
+ * The policies are seq (calling thread), threads (process-wide pool),
+ * on(pool) (a given ThreadPool), openmp, stealing (the process-wide
+ * work-stealing scheduler), and runtime, whose backend is read from the
+ * AMS562_BACKEND environment variable ("seq", "threads", "openmp" or
+ * "stealing") so that deployments can switch backends without recompiling.
+ * Every policy carries the chunk count and the scan and accumulation modes
+ * of the backend functions. The standard policies are accepted as well:
+ * std::execution::seq runs sequentially, and par and par_unseq use the
+ * runtime backend.
+ *
+ * The front end lives in namespace ams562, so its std-like names do not
+ * collide with std::inner_product and std::inclusive_scan.
+ */
+
+namespace ams562 {
+namespace execution {
+
+/**
+ * @brief Backends a policy can dispatch to
+ */
+enum class Backend { Sequential, Threads, OpenMP, Stealing };
+
+/**
+ * @brief Name of a backend, as accepted by parse_backend
+ */
+inline const char* backend_name(Backend backend) {
+  switch (backend) {
+    case Backend::Sequential: return "seq";
+    case Backend::Threads: return "threads";
+    case Backend::OpenMP: return "openmp";
+    case Backend::Stealing: return "stealing";
+  }
+  return "?";
+}
+
+/**
+ * @brief Parses a backend name ("seq"/"sequential", "threads", "openmp"/"omp",
+ * "stealing")
+ * @return The backend, or nothing if the name is unknown
+ */
+inline std::optional<Backend> parse_backend(std::string_view name) {
+  if (name == "seq" || name == "sequential") return Backend::Sequential;
+  if (name == "threads") return Backend::Threads;
+  if (name == "openmp" || name == "omp") return Backend::OpenMP;
+  if (name == "stealing") return Backend::Stealing;
+  return std::nullopt;
+}
+
+/**
+ * @brief Backend named by the AMS562_BACKEND environment variable; Threads if
+ * the variable is unset or names no backend
+ */
+inline Backend backend_from_env() {
+  const char* value = std::getenv("AMS562_BACKEND");
+  if (value == nullptr) return Backend::Threads;
+  return parse_backend(value).value_or(Backend::Threads);
+}
+
+namespace detail {
+// Backend of the runtime policy; -1 until it is first read from the
+// environment or set explicitly
+inline std::atomic<int>& runtime_backend_slot() {
+  static std::atomic<int> slot{-1};
+  return slot;
+}
+}  // namespace detail
+
+/**
+ * @brief Backend the runtime policy dispatches to: the last value passed to
+ * set_runtime_backend, otherwise backend_from_env() read on first use
+ */
+inline Backend runtime_backend() {
+  std::atomic<int>& slot = detail::runtime_backend_slot();
+  int value = slot.load(std::memory_order_relaxed);
+  if (value < 0) {
+    int expected = -1;
+    slot.compare_exchange_strong(expected,
+                                 static_cast<int>(backend_from_env()));
+    value = slot.load(std::memory_order_relaxed);
+  }
+  return static_cast<Backend>(value);
+}
+
+/**
+ * @brief Overrides the backend of the runtime policy for the whole process
+ */
+inline void set_runtime_backend(Backend backend) {
+  detail::runtime_backend_slot().store(static_cast<int>(backend),
+                                       std::memory_order_relaxed);
+}
+
+/**
+ * @brief Options every policy carries; they are forwarded to the backend
+ * functions and ignored where a backend has no such parameter
+ */
+struct PolicyOptions {
+  /// Number of chunks (kAutoThreads lets the auto-tuner choose); threads only
+  unsigned int num_threads = kAutoThreads;
+  /// Scan algorithm of the parallel scans
+  ScanMode scan_mode = ScanMode::ScanThenAdd;
+  /// Accumulation of floating-point inner products (every backend)
+  AccumulationMode accumulation = AccumulationMode::Fast;
+};
+
+/**
+ * @brief Base of the policies: the options and copy-and-modify setters
+ */
+template <typename Policy>
+struct PolicyBase {
+  PolicyOptions options;
+
+  Policy with_threads(unsigned int num_threads) const {
+    Policy copy = static_cast<const Policy&>(*this);
+    copy.options.num_threads = num_threads;
+    return copy;
+  }
+  Policy with_mode(ScanMode mode) const {
+    Policy copy = static_cast<const Policy&>(*this);
+    copy.options.scan_mode = mode;
+    return copy;
+  }
+  Policy with_mode(AccumulationMode mode) const {
+    Policy copy = static_cast<const Policy&>(*this);
+    copy.options.accumulation = mode;
+    return copy;
+  }
+};
+
+/// Runs on the calling thread
+struct SequencedPolicy : PolicyBase<SequencedPolicy> {};
+/// Runs on the process-wide thread pool
+struct ThreadsPolicy : PolicyBase<ThreadsPolicy> {};
+/// Runs on the given thread pool
+struct PoolPolicy : PolicyBase<PoolPolicy> {
+  ThreadPool* pool = nullptr;
+};
+/// Runs with OpenMP tasks
+struct OpenMPPolicy : PolicyBase<OpenMPPolicy> {};
+/// Runs on the process-wide work-stealing scheduler
+struct StealingPolicy : PolicyBase<StealingPolicy> {};
+/// Runs on runtime_backend(), chosen at every call
+struct RuntimePolicy : PolicyBase<RuntimePolicy> {};
+
+inline const SequencedPolicy seq{};
+inline const ThreadsPolicy threads{};
+inline const OpenMPPolicy openmp{};
+inline const StealingPolicy stealing{};
+inline const RuntimePolicy runtime{};
+
+/**
+ * @brief Policy that runs on the given pool
+ */
+inline PoolPolicy on(ThreadPool& pool) {
+  PoolPolicy policy;
+  policy.pool = &pool;
+  return policy;
+}
+
+/**
+ * @brief True for the policies of this header and the std::execution
+ * policies
+ */
+template <typename T>
+struct is_execution_policy
+    : std::bool_constant<std::is_same_v<T, SequencedPolicy> ||
+                         std::is_same_v<T, ThreadsPolicy> ||
+                         std::is_same_v<T, PoolPolicy> ||
+                         std::is_same_v<T, OpenMPPolicy> ||
+                         std::is_same_v<T, StealingPolicy> ||
+                         std::is_same_v<T, RuntimePolicy>
+#if __cpp_lib_execution
+                         || std::is_execution_policy_v<T>
+#endif
+                         > {
+};
+
+template <typename T>
+constexpr bool is_execution_policy_v =
+    is_execution_policy<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+template <typename T>
+using enable_if_execution_policy_t =
+    std::enable_if_t<is_execution_policy_v<T>, int>;
+
+/**
+ * @brief A policy reduced to what the dispatch needs
+ */
+struct ResolvedPolicy {
+  Backend backend = Backend::Threads;
+  ThreadPool* pool = nullptr;  // set for Backend::Threads
+  PolicyOptions options;
+};
+
+inline ResolvedPolicy resolve(const SequencedPolicy& policy) {
+  return {Backend::Sequential, nullptr, policy.options};
+}
+inline ResolvedPolicy resolve(const ThreadsPolicy& policy) {
+  return {Backend::Threads, &default_thread_pool(), policy.options};
+}
+inline ResolvedPolicy resolve(const PoolPolicy& policy) {
+  if (policy.pool == nullptr) {
+    throw std::invalid_argument("Pool policy without a thread pool");
+  }
+  return {Backend::Threads, policy.pool, policy.options};
+}
+inline ResolvedPolicy resolve(const OpenMPPolicy& policy) {
+  return {Backend::OpenMP, nullptr, policy.options};
+}
+inline ResolvedPolicy resolve(const StealingPolicy& policy) {
+  return {Backend::Stealing, nullptr, policy.options};
+}
+inline ResolvedPolicy resolve(const RuntimePolicy& policy) {
+  Backend backend = runtime_backend();
+  return {backend,
+          backend == Backend::Threads ? &default_thread_pool() : nullptr,
+          policy.options};
+}
+#if __cpp_lib_execution
+inline ResolvedPolicy resolve(const std::execution::sequenced_policy&) {
+  return resolve(seq);
+}
+inline ResolvedPolicy resolve(const std::execution::parallel_policy&) {
+  return resolve(runtime);
+}
+inline ResolvedPolicy resolve(
+    const std::execution::parallel_unsequenced_policy&) {
+  return resolve(runtime);
+}
+#endif  // __cpp_lib_execution
+
+}  // namespace execution
+
+/**
+ * @brief Computes init + the inner product of [first1, last1) and the range
+ * starting at first2 with the backend of policy (see std::inner_product)
+ *
+ * Every backend accumulates in the value type of It1 and adds init at the
+ * end, so the result does not depend on the backend when the type of init
+ * differs from the element type. The sequential backend honours the
+ * accumulation mode on the calling thread (see sequential_inner_product) and
+ * never starts a thread pool.
+ */
+template <typename Policy, typename It1, typename It2, typename T,
+          execution::enable_if_execution_policy_t<Policy> = 0,
+          enable_if_random_access_t<It1> = 0>
+T inner_product(const Policy& policy, It1 first1, It1 last1, It2 first2,
+                T init) {
+  const execution::ResolvedPolicy resolved = execution::resolve(policy);
+  const execution::PolicyOptions& options = resolved.options;
+  switch (resolved.backend) {
+    case execution::Backend::Sequential:
+      return init + sequential_inner_product(first1, last1, first2,
+                                             options.accumulation);
+    case execution::Backend::Threads:
+      return init + parallel_inner_product_threads(*resolved.pool, first1,
+                                                   last1, first2,
+                                                   options.num_threads,
+                                                   options.accumulation);
+    case execution::Backend::OpenMP:
+      return init + parallel_inner_product_openmp(first1, last1, first2,
+                                                  options.accumulation);
+    case execution::Backend::Stealing:
+      return init + parallel_inner_product_stealing(
+                        default_work_stealing_scheduler(), first1, last1,
+                        first2, kAutoGrain, options.accumulation);
+  }
+  return init;
+}
+
+/**
+ * @brief Computes the inner product of two vectors with the backend of
+ * policy
+ * @throws std::invalid_argument if the vectors differ in size
+ */
+template <typename Policy, typename T,
+          execution::enable_if_execution_policy_t<Policy> = 0>
+T inner_product(const Policy& policy, const std::vector<T>& a,
+                const std::vector<T>& b) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return inner_product(policy, a.begin(), a.end(), b.begin(), T(0));
+}
+
+/**
+ * @brief Inclusive prefix sums of [first, last) into d_first with the
+ * backend of policy (see std::inclusive_scan); d_first may equal first
+ * @return Iterator past the last element written
+ */
+template <typename Policy, typename InIt, typename OutIt,
+          execution::enable_if_execution_policy_t<Policy> = 0,
+          enable_if_random_access_t<InIt> = 0>
+OutIt inclusive_scan(const Policy& policy, InIt first, InIt last,
+                     OutIt d_first) {
+  const execution::ResolvedPolicy resolved = execution::resolve(policy);
+  const execution::PolicyOptions& options = resolved.options;
+  switch (resolved.backend) {
+    case execution::Backend::Sequential:
+      return std::inclusive_scan(first, last, d_first);
+    case execution::Backend::Threads:
+      parallel_inclusive_scan_threads(*resolved.pool, first, last, d_first,
+                                      options.num_threads, options.scan_mode);
+      break;
+    case execution::Backend::OpenMP:
+      parallel_inclusive_scan_openmp(first, last, d_first, options.scan_mode);
+      break;
+    case execution::Backend::Stealing:
+      parallel_inclusive_scan_stealing(default_work_stealing_scheduler(),
+                                       first, last, d_first);
+      break;
+  }
+  return d_first + (last - first);
+}
+
+/**
+ * @brief Inclusive prefix sums of input into output (resized to match) with
+ * the backend of policy
+ */
+template <typename Policy, typename T,
+          execution::enable_if_execution_policy_t<Policy> = 0>
+void inclusive_scan(const Policy& policy, const std::vector<T>& input,
+                    std::vector<T>& output) {
+  output.resize(input.size());
+  inclusive_scan(policy, input.begin(), input.end(), output.begin());
+}
+
+/**
+ * @brief In-place inclusive prefix sums of a vector with the backend of
+ * policy
+ */
+template <typename Policy, typename T,
+          execution::enable_if_execution_policy_t<Policy> = 0>
+void inclusive_scan(const Policy& policy, std::vector<T>& data) {
+  inclusive_scan(policy, data.begin(), data.end(), data.begin());
+}
+
+}  // namespace ams562
+
+#endif  // EXECUTION_POLICY_HPP
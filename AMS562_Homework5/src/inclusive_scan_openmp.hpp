@@ -4,67 +4,367 @@
 #define INCLUSIVE_SCAN_OPENMP_HPP
 
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include <omp.h>
 
+#include "auto_tune.hpp"
+#include "instrumentation.hpp"
+#include "padded_slots.hpp"
+#include "range_traits.hpp"
+#include "scan_common.hpp"
+
 /**
- * @brief Performs parallel inclusive scan using OpenMP tasks
- * @param input The input vector to scan
- * @param output The output vector to store results
+ * @brief Performs parallel scan with an arbitrary associative operation using
+ * OpenMP tasks
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param d_first Iterator to the first output element; may equal first for an
+ * in-place scan, and the output range must hold last - first elements
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param mode Scan algorithm (see ScanMode)
  *
- * Implementation details:
+ * Implementation details (ScanMode::ScanThenAdd):
  * 1. Uses OpenMP taskloop for dynamic task-based parallelism
  * 2. First performs local scans in parallel
  * 3. Then adjusts results using partial sums
+ *
+ * With ScanMode::DecoupledLookback, the threads of a parallel region claim
+ * fixed-size blocks in order and scan them in a single pass (see
+ * LookbackScan).
+ *
+ * With ScanMode::ReduceThenScan, the chunks are first only reduced (read
+ * only), and each chunk is then scanned once, seeded with its prefix.
  */
-template <typename T>
-void parallel_inclusive_scan_openmp(const std::vector<T>& input,
-                                    std::vector<T>& output) {
-  size_t n = input.size();
+template <typename InIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_scan_openmp(InIt first, InIt last, OutIt d_first, BinaryOp op,
+                          iter_value_t<InIt> identity, ScanType type,
+                          ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
   if (n == 0) return;
-  output.resize(n);
+  AMS562_TRACE_REGION("scan_openmp", n);
 
-  unsigned int num_threads = omp_get_max_threads();
-  size_t chunk_size =
-      (n + num_threads - 1) / num_threads;  // Same chunk size calculation
-  std::vector<T> partial_sums(num_threads, T(0));
+  // Let the tuned profile choose between a serial run and a chunk count
+  static const std::string key = profile_key<T, BinaryOp>("scan_openmp");
+  static thread_local CachedProfile cache;
+  std::vector<T> sample;  // allocated only if a calibration runs
+  TuningProfile tuned = openmp_profile(
+      key, cache,
+      [&]() {
+        sample.resize(kCalibrationElements, identity);
+        keep_result(seeded_scan(sample.data(), sample.data(), 0,
+                                sample.size(), identity, op,
+                                ScanType::Inclusive));
+      },
+      kCalibrationElements);
+  unsigned int num_chunks = plan_chunks(
+      tuned, n, static_cast<unsigned int>(omp_get_max_threads()));
+  if (num_chunks == 1) {
+    seeded_scan(first, d_first, 0, n, identity, op, type);
+    return;
+  }
+
+  if (mode == ScanMode::DecoupledLookback) {
+    LookbackScan<InIt, OutIt, T, BinaryOp> scan(first, d_first, n, op,
+                                                identity, type);
+    int workers = static_cast<int>(
+        std::min<size_t>(num_chunks, scan.num_blocks()));
+#pragma omp parallel num_threads(workers)
+    {
+      AMS562_TRACE_CHUNK("scan_openmp/lookback", -1, 0);
+      scan.run();
+    }
+    return;
+  }
+
+  size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  num_chunks = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+  PaddedSlots<T> chunk_sums(num_chunks, identity);
 
-// First phase: Local scans using taskloop
+  if (mode == ScanMode::ReduceThenScan) {
+#pragma omp parallel
+#pragma omp single nowait
+    {
+      // Phase 1: read-only reduction of every chunk but the last
+#pragma omp taskloop grainsize(1)
+      for (unsigned int tid = 0; tid < num_chunks - 1; ++tid) {
+        AMS562_TRACE_CHUNK("scan_openmp/reduce", tid, chunk_size);
+        chunk_sums[tid] = chunk_reduce(first, tid * chunk_size,
+                                       (tid + 1) * chunk_size, op);
+      }
+
+      for (unsigned int i = 1; i + 1 < num_chunks; ++i) {
+        chunk_sums[i] = op(chunk_sums[i - 1], chunk_sums[i]);
+      }
+
+      // Phase 2: scan every chunk once, seeded with the preceding chunk sums
+#pragma omp taskloop grainsize(1)
+      for (unsigned int tid = 0; tid < num_chunks; ++tid) {
+        size_t start_idx = tid * chunk_size;
+        size_t end_idx = std::min(start_idx + chunk_size, n);
+        AMS562_TRACE_CHUNK("scan_openmp/scan", tid, end_idx - start_idx);
+        seeded_scan(first, d_first, start_idx, end_idx,
+                    tid == 0 ? identity : chunk_sums[tid - 1], op, type);
+      }
+    }
+    return;
+  }
+
+// First phase: Local scans using taskloop, one task per chunk
 #pragma omp parallel
 #pragma omp single nowait
   {
-#pragma omp taskloop grainsize(chunk_size)
-    for (unsigned int tid = 0; tid < num_threads; ++tid) {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int tid = 0; tid < num_chunks; ++tid) {
       size_t start_idx = tid * chunk_size;
       size_t end_idx = std::min(start_idx + chunk_size, n);
-
-      if (start_idx < n) {
-        output[start_idx] = input[start_idx];
-        for (size_t i = start_idx + 1; i < end_idx; ++i) {
-          output[i] = output[i - 1] + input[i];
-        }
-        partial_sums[tid] = output[end_idx - 1];
-      }
+      AMS562_TRACE_CHUNK("scan_openmp/scan", tid, end_idx - start_idx);
+      chunk_sums[tid] = seeded_scan(first, d_first, start_idx, end_idx,
+                                    identity, op, type);
     }
-#pragma omp taskwait
 
     // Accumulate partial sums in the single thread
-    for (unsigned int i = 1; i < num_threads; ++i) {
-      partial_sums[i] += partial_sums[i - 1];
+    for (unsigned int i = 1; i < num_chunks; ++i) {
+      chunk_sums[i] = op(chunk_sums[i - 1], chunk_sums[i]);
     }
 
 // Final phase: Adjust values using taskloop by reusing the same parallel region
-#pragma omp taskloop grainsize(chunk_size)
-    for (unsigned int tid = 1; tid < num_threads; ++tid) {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int tid = 1; tid < num_chunks; ++tid) {
       size_t start_idx = tid * chunk_size;
       size_t end_idx = std::min(start_idx + chunk_size, n);
-      T add_value = partial_sums[tid - 1];
+      AMS562_TRACE_CHUNK("scan_openmp/add", tid, end_idx - start_idx);
+      chunk_prepend(d_first, start_idx, end_idx, chunk_sums[tid - 1], op);
+    }
+  }
+}
 
-      for (size_t i = start_idx; i < end_idx; ++i) {
-        output[i] += add_value;
-      }
+/**
+ * @brief Performs parallel scan of a vector with an arbitrary associative
+ * operation using OpenMP tasks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (resized to the input
+ * size; may be the input vector itself)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T, typename BinaryOp>
+void parallel_scan_openmp(const std::vector<T>& input, std::vector<T>& output,
+                          BinaryOp op,
+                          typename std::vector<T>::value_type identity,
+                          ScanType type,
+                          ScanMode mode = ScanMode::ScanThenAdd) {
+  output.resize(input.size());
+  parallel_scan_openmp(input.data(), input.data() + input.size(),
+                       output.data(), op, identity, type, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan using OpenMP tasks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (may be input itself)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_inclusive_scan_openmp(const std::vector<T>& input,
+                                    std::vector<T>& output,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_openmp(input, output, std::plus<T>(), T(0),
+                       ScanType::Inclusive, mode);
+}
+
+/**
+ * @brief Performs parallel in-place inclusive scan of a vector using OpenMP
+ * tasks
+ * @param data The vector to scan; overwritten by its prefix sums
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_inclusive_scan_openmp(std::vector<T>& data,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_inclusive_scan_openmp(data, data, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan of an iterator range using OpenMP
+ * tasks; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_inclusive_scan_openmp(InIt first, InIt last, OutIt d_first,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_openmp(first, last, d_first, std::plus<T>(), T(0),
+                       ScanType::Inclusive, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan (output[0] = 0) using OpenMP tasks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (may be input itself)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_exclusive_scan_openmp(const std::vector<T>& input,
+                                    std::vector<T>& output,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_openmp(input, output, std::plus<T>(), T(0),
+                       ScanType::Exclusive, mode);
+}
+
+/**
+ * @brief Performs parallel in-place exclusive scan of a vector using OpenMP
+ * tasks
+ * @param data The vector to scan; overwritten by its exclusive prefix sums
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_exclusive_scan_openmp(std::vector<T>& data,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_exclusive_scan_openmp(data, data, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan of an iterator range using OpenMP
+ * tasks; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_exclusive_scan_openmp(InIt first, InIt last, OutIt d_first,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_openmp(first, last, d_first, std::plus<T>(), T(0),
+                       ScanType::Exclusive, mode);
+}
+
+#ifdef __cpp_lib_span
+/**
+ * @brief Performs parallel inclusive scan of a span using OpenMP tasks;
+ * output must be at least as long as input and may be the same span
+ */
+template <typename In, size_t InExtent, typename Out, size_t OutExtent>
+void parallel_inclusive_scan_openmp(std::span<In, InExtent> input,
+                                    std::span<Out, OutExtent> output,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("Output span is shorter than the input");
+  }
+  parallel_inclusive_scan_openmp(input.data(), input.data() + input.size(),
+                                  output.data(), mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan of a span using OpenMP tasks;
+ * output must be at least as long as input and may be the same span
+ */
+template <typename In, size_t InExtent, typename Out, size_t OutExtent>
+void parallel_exclusive_scan_openmp(std::span<In, InExtent> input,
+                                    std::span<Out, OutExtent> output,
+                                    ScanMode mode = ScanMode::ScanThenAdd) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("Output span is shorter than the input");
+  }
+  parallel_exclusive_scan_openmp(input.data(), input.data() + input.size(),
+                                 output.data(), mode);
+}
+#endif  // __cpp_lib_span
+
+/**
+ * @brief Performs parallel segmented inclusive scan using OpenMP tasks: a
+ * non-zero flag starts a new segment, so the output there equals the input
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param flags Iterator to the segment head flags, one per input element
+ * @param d_first Iterator to the first output element (may equal first)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ *
+ * Uses reduce-then-scan over SegmentCarry values (see
+ * parallel_segmented_scan_threads).
+ */
+template <typename InIt, typename FlagIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_segmented_scan_openmp(InIt first, InIt last, FlagIt flags,
+                                    OutIt d_first, BinaryOp op,
+                                    iter_value_t<InIt> identity) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  if (n == 0) return;
+
+  static const std::string key =
+      profile_key<T, BinaryOp>("segmented_scan_openmp");
+
+  static thread_local CachedProfile cache;
+  std::vector<T> sample;  // allocated only if a calibration runs
+  std::vector<unsigned char> sample_flags;
+  TuningProfile tuned = openmp_profile(
+      key, cache,
+      [&]() {
+        sample.resize(kCalibrationElements, identity);
+        sample_flags.resize(kCalibrationElements, 0);
+        segmented_seeded_scan(sample.data(), sample_flags.data(), sample.data(),
+                              0, sample.size(), identity, op);
+        keep_result(sample.back());
+      },
+      kCalibrationElements);
+  unsigned int num_chunks = plan_chunks(
+      tuned, n, static_cast<unsigned int>(omp_get_max_threads()));
+  size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  num_chunks = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+  std::vector<SegmentCarry<T>> carries(num_chunks);
+
+#pragma omp parallel
+#pragma omp single nowait
+  {
+    // Phase 1: read-only reduction of every chunk but the last
+#pragma omp taskloop grainsize(1)
+    for (unsigned int tid = 0; tid < num_chunks - 1; ++tid) {
+      carries[tid] = segmented_chunk_reduce(first, flags, tid * chunk_size,
+                                            (tid + 1) * chunk_size, identity,
+                                            op);
     }
+
+    for (unsigned int i = 1; i + 1 < num_chunks; ++i) {
+      carries[i] = combine_segment_carries(carries[i - 1], carries[i], op);
+    }
+
+    // Phase 2: scan every chunk once, seeded with the preceding running value
+#pragma omp taskloop grainsize(1)
+    for (unsigned int tid = 0; tid < num_chunks; ++tid) {
+      size_t start_idx = tid * chunk_size;
+      size_t end_idx = std::min(start_idx + chunk_size, n);
+      segmented_seeded_scan(first, flags, d_first, start_idx, end_idx,
+                            tid == 0 ? identity : carries[tid - 1].value, op);
+    }
+  }
+}
+
+/**
+ * @brief Performs parallel segmented inclusive scan of vectors using OpenMP
+ * tasks (see the iterator overload)
+ * @param input The input vector to scan
+ * @param flags Segment head flags, one per input element
+ * @param output The output vector to store results (may be input itself)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ */
+template <typename T, typename F, typename BinaryOp>
+void parallel_segmented_scan_openmp(const std::vector<T>& input,
+                                    const std::vector<F>& flags,
+                                    std::vector<T>& output, BinaryOp op,
+                                    typename std::vector<T>::value_type identity) {
+  if (flags.size() != input.size()) {
+    throw std::invalid_argument("Flags must have the size of the input");
   }
-#pragma omp taskwait
+  output.resize(input.size());
+  parallel_segmented_scan_openmp(input.data(), input.data() + input.size(),
+                                 flags.begin(), output.data(), op, identity);
 }
 
 #endif  // INCLUSIVE_SCAN_OPENMP_HPP
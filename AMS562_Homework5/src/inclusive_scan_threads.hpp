@@ -4,20 +4,34 @@
 
 #include <vector>
 #include <thread>
-#include <future>
 #include <numeric>
 #include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "auto_tune.hpp"
+#include "instrumentation.hpp"
+#include "padded_slots.hpp"
+#include "range_traits.hpp"
+#include "scan_common.hpp"
+#include "thread_pool.hpp"
 
 /**
  * @brief This header file implements a parallel inclusive scan (prefix sum)
- * algorithm using C++ threads and futures. An inclusive scan computes the
- * running sum of elements where each output element includes its corresponding
- * input element.
+ * algorithm using C++ threads from a persistent thread pool. An inclusive scan
+ * computes the running sum of elements where each output element includes its
+ * corresponding input element.
+ *
+ * The same chunked machinery also provides exclusive scans, scans with any
+ * associative operation (e.g. scan_maximum) and segmented scans. Every scan
+ * takes std::vector arguments or random-access iterator ranges (and std::span
+ * in C++20 builds); the output may alias the input for an in-place scan.
  */
 
 /**
  * @brief Helper function that performs inclusive scan on a portion of the input
- * vector
+ * vector with the vectorized kernel of simd_scan.hpp
  * @param input The input vector to scan
  * @param output The output vector to store results
  * @param start_idx Starting index of the chunk to process
@@ -26,87 +40,548 @@
 template <typename T>
 void partial_inclusive_scan(const std::vector<T>& input, std::vector<T>& output,
                             size_t start_idx, size_t end_idx) {
-  std::partial_sum(input.begin() + start_idx, input.begin() + end_idx,
-                   output.begin() + start_idx, std::plus<T>());
+  seeded_inclusive_scan(input.data(), output.data(), start_idx, end_idx, T(0));
 }
 
 /**
- * @brief Performs parallel inclusive scan using C++ threads and futures
- * @param input The input vector to scan
- * @param output The output vector to store results
- * @param num_threads Number of threads to use (defaults to hardware
- * concurrency)
+ * @brief Performs a parallel scan with an arbitrary associative operation on a
+ * persistent thread pool, continuing from a seed
+ * @param pool The thread pool that executes the chunks
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param d_first Iterator to the first output element; may equal first for an
+ * in-place scan, and the output range must hold last - first elements
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param seed Running value the scan continues from (identity for a plain
+ * scan); folded in front of every output
+ * @param type Inclusive or exclusive scan
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ * @return seed folded with every input element, i.e. the seed of the scan
+ * that continues after last
  *
- * Implementation details:
+ * Implementation details (ScanMode::ScanThenAdd):
  * 1. Divides the input into chunks and processes each chunk in parallel
- * 2. Performs local inclusive scan on each chunk
- * 3. Adjusts results by adding the sum from previous chunks
+ * 2. Performs local scan on each chunk
+ * 3. Adjusts results by folding in the reduction of the previous chunks
+ *
+ * With ScanMode::DecoupledLookback, num_threads pool tasks claim fixed-size
+ * blocks in order and scan them in a single pass (see LookbackScan).
+ *
+ * With ScanMode::ReduceThenScan, the chunks are first only reduced (read
+ * only), and each chunk is then scanned once, seeded with its prefix.
+ *
+ * Every mode reads input element i before it writes output element i, so the
+ * in-place scan needs no extra memory beyond one value per chunk.
  */
-template <typename T>
-void parallel_inclusive_scan_threads(
-    const std::vector<T>& input, std::vector<T>& output,
-    unsigned int num_threads = std::thread::hardware_concurrency()) {
-  // TODO: Implement parallel inclusive scan using C++ threads and futures
-  size_t n = input.size();
-  if (n == 0) return;
+template <typename InIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+iter_value_t<InIt> parallel_seeded_scan_threads(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first, BinaryOp op,
+    iter_value_t<InIt> identity, iter_value_t<InIt> seed, ScanType type,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  if (n == 0) return seed;
+  AMS562_TRACE_REGION("scan_threads", n);
 
-  // Resize output vector to match input size
-  output.resize(n);
+  // Let the tuned profile choose between a serial run and a chunk count
+  if (num_threads == kAutoThreads) {
+    static const std::string key = profile_key<T, BinaryOp>("scan_threads");
+    static thread_local CachedProfile cache;
+    std::vector<T> sample;  // allocated only if a calibration runs
+    TuningProfile tuned = pool_profile(
+        pool, key, cache,
+        [&]() {
+          sample.resize(kCalibrationElements, identity);
+          keep_result(seeded_scan(sample.data(), sample.data(), 0,
+                                  sample.size(), identity, op,
+                                  ScanType::Inclusive));
+        },
+        kCalibrationElements);
+    num_threads = plan_chunks(tuned, n, pool_workers(pool));
+  }
+  if (num_threads == 1) {
+    return seeded_scan(first, d_first, 0, n, seed, op, type);
+  }
   
-  // Ensure num_threads is at least 1 and does not exceed input size
-  if (num_threads == 0) num_threads = 1;  
+  // Ensure num_threads does not exceed input size
   if (num_threads > n) num_threads = n;  
 
-  // Step 1: Calculate chunk size with better load balancing
+  // Step 1: Calculate chunk size with better load balancing, dropping the
+  // trailing chunks that ceiling division leaves empty
   size_t chunk_size = (n + num_threads - 1) / num_threads;  // Ceiling division
-  
-  std::vector<std::future<void>> futures;
-  std::vector<T> partial_sums(num_threads);
-
-  // Step 2: Create threads and futures to process each chunk by calling
-  // partial_inclusive_scan
-  for (unsigned int i = 0; i < num_threads; ++i) {
-    size_t start_idx = i * chunk_size;
-    size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+  num_threads = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
 
-    futures.emplace_back(std::async(std::launch::async, [&, start_idx, end_idx, i]() {
-                                      partial_inclusive_scan(input, output,
-                                                             start_idx, end_idx);
-                                      if (start_idx < end_idx ) {
-                                        partial_sums[i] = output[end_idx - 1];
-                                      }
-                                    }));
+  if (mode == ScanMode::DecoupledLookback) {
+    LookbackScan<InIt, OutIt, T, BinaryOp> scan(first, d_first, n, op, seed,
+                                                type);
+    size_t workers = std::min<size_t>(num_threads, scan.num_blocks());
+    pool.parallel_for(workers, [&](size_t) {
+      AMS562_TRACE_CHUNK("scan_threads/lookback", -1, 0);
+      scan.run();
+    });
+    return scan.total();
   }
 
-  // Step 3: Wait for all partial scans to complete
-  for (auto& f : futures) {
-    f.get();
+  if (mode == ScanMode::ReduceThenScan) {
+    PaddedSlots<T> chunk_sums(num_threads, identity);
+
+    // Phase 1: read-only reduction of every chunk but the last
+    pool.parallel_for(num_threads - 1, [&](size_t i) {
+      AMS562_TRACE_CHUNK("scan_threads/reduce", i, chunk_size);
+      chunk_sums[i] = chunk_reduce(first, i * chunk_size,
+                                   (i + 1) * chunk_size, op);
+    });
+
+    // Phase 2: scan every chunk once, seeded with the preceding chunk sums
+    chunk_sums[0] = op(seed, chunk_sums[0]);
+    for (unsigned int i = 1; i + 1 < num_threads; ++i) {
+      chunk_sums[i] = op(chunk_sums[i - 1], chunk_sums[i]);
+    }
+    pool.parallel_for(num_threads, [&](size_t i) {
+      size_t start_idx = i * chunk_size;
+      size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+      AMS562_TRACE_CHUNK("scan_threads/scan", i, end_idx - start_idx);
+      T end_value = seeded_scan(first, d_first, start_idx, end_idx,
+                                i == 0 ? seed : chunk_sums[i - 1], op, type);
+      if (i == num_threads - 1) chunk_sums[i] = end_value;
+    });
+    return chunk_sums[num_threads - 1];
   }
-  futures.clear();
+
+  PaddedSlots<T> partial_sums(num_threads, identity);
+
+  // Step 2: Scan each chunk on the pool, keeping its reduction
+  pool.parallel_for(num_threads, [&](size_t i) {
+    size_t start_idx = i * chunk_size;
+    size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+    AMS562_TRACE_CHUNK("scan_threads/scan", i, end_idx - start_idx);
+
+    partial_sums[i] = seeded_scan(first, d_first, start_idx, end_idx,
+                                  i == 0 ? seed : identity, op, type);
+  });
   
   // Compute the total sums for each chunk
   for (unsigned int i = 1; i < num_threads; ++i) {
-    partial_sums[i] += partial_sums[i - 1];
+    partial_sums[i] = op(partial_sums[i - 1], partial_sums[i]);
   }
 
-  // Step 4: Adjust the results to account for the sums from previous chunks
-  for (unsigned int i = 1; i < num_threads; ++i) {
+  // Step 3: Adjust the results to account for the sums from previous chunks
+  pool.parallel_for(num_threads - 1, [&](size_t k) {
+    size_t i = k + 1;
     size_t start_idx = i * chunk_size;
     size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
-    
-    // Value to add to each element in the current chunk
-    T add_value = partial_sums[i - 1];
-
-    futures.emplace_back(std::async(std::launch::async, [&, start_idx, end_idx, add_value]() {                                 
-                                      for (size_t j = start_idx; j < end_idx; ++j) {
-                                        output[j] += add_value;
-                                      }
-                                    }));
+    AMS562_TRACE_CHUNK("scan_threads/add", i, end_idx - start_idx);
+    chunk_prepend(d_first, start_idx, end_idx, partial_sums[i - 1], op);
+  });
+  return partial_sums[num_threads - 1];
+}
+
+/**
+ * @brief Performs a parallel scan with an arbitrary associative operation on a
+ * persistent thread pool
+ * @param pool The thread pool that executes the chunks
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param d_first Iterator to the first output element; may equal first for an
+ * in-place scan, and the output range must hold last - first elements
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode and parallel_seeded_scan_threads)
+ */
+template <typename InIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_scan_threads(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first, BinaryOp op,
+    iter_value_t<InIt> identity, ScanType type,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_seeded_scan_threads(pool, first, last, d_first, op, identity,
+                               identity, type, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel scan of an iterator range with an arbitrary
+ * associative operation using the process-wide thread pool (see the pool
+ * overload)
+ */
+template <typename InIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_scan_threads(
+    InIt first, InIt last, OutIt d_first, BinaryOp op,
+    iter_value_t<InIt> identity, ScanType type,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_threads(default_thread_pool(), first, last, d_first, op,
+                        identity, type, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel scan of a vector with an arbitrary associative
+ * operation on a persistent thread pool
+ * @param pool The thread pool that executes the chunks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (resized to the input
+ * size; may be the input vector itself)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T, typename BinaryOp>
+void parallel_scan_threads(
+    ThreadPool& pool, const std::vector<T>& input, std::vector<T>& output,
+    BinaryOp op, typename std::vector<T>::value_type identity, ScanType type,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  // Resize output vector to match input size
+  output.resize(input.size());
+  parallel_scan_threads(pool, input.data(), input.data() + input.size(),
+                        output.data(), op, identity, type, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel scan with an arbitrary associative operation using
+ * the process-wide thread pool
+ * @param input The input vector to scan
+ * @param output The output vector to store results
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T, typename BinaryOp>
+void parallel_scan_threads(
+    const std::vector<T>& input, std::vector<T>& output, BinaryOp op,
+    typename std::vector<T>::value_type identity, ScanType type,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_threads(default_thread_pool(), input, output, op, identity,
+                        type, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan on a persistent thread pool
+ * @param pool The thread pool that executes the chunks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (may be input itself)
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_inclusive_scan_threads(
+    ThreadPool& pool, const std::vector<T>& input, std::vector<T>& output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_threads(pool, input, output, std::plus<T>(), T(0),
+                        ScanType::Inclusive, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan using the process-wide thread pool
+ * @param input The input vector to scan
+ * @param output The output vector to store results
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_inclusive_scan_threads(
+    const std::vector<T>& input, std::vector<T>& output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_inclusive_scan_threads(default_thread_pool(), input, output,
+                                  num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel in-place inclusive scan of a vector using the
+ * process-wide thread pool
+ * @param data The vector to scan; overwritten by its prefix sums
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_inclusive_scan_threads(
+    std::vector<T>& data,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_inclusive_scan_threads(default_thread_pool(), data, data,
+                                  num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan of an iterator range on a
+ * persistent thread pool; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_inclusive_scan_threads(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_threads(pool, first, last, d_first, std::plus<T>(), T(0),
+                        ScanType::Inclusive, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel inclusive scan of an iterator range using the
+ * process-wide thread pool; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_inclusive_scan_threads(
+    InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_inclusive_scan_threads(default_thread_pool(), first, last, d_first,
+                                  num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan (output[0] = 0) on a persistent
+ * thread pool
+ * @param pool The thread pool that executes the chunks
+ * @param input The input vector to scan
+ * @param output The output vector to store results (may be input itself)
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_exclusive_scan_threads(
+    ThreadPool& pool, const std::vector<T>& input, std::vector<T>& output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_scan_threads(pool, input, output, std::plus<T>(), T(0),
+                        ScanType::Exclusive, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan (output[0] = 0) using the
+ * process-wide thread pool
+ * @param input The input vector to scan
+ * @param output The output vector to store results
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_exclusive_scan_threads(
+    const std::vector<T>& input, std::vector<T>& output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_exclusive_scan_threads(default_thread_pool(), input, output,
+                                  num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel in-place exclusive scan of a vector using the
+ * process-wide thread pool
+ * @param data The vector to scan; overwritten by its exclusive prefix sums
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ * @param mode Scan algorithm (see ScanMode)
+ */
+template <typename T>
+void parallel_exclusive_scan_threads(
+    std::vector<T>& data,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_exclusive_scan_threads(default_thread_pool(), data, data,
+                                  num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan of an iterator range on a
+ * persistent thread pool; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_exclusive_scan_threads(
+    ThreadPool& pool, InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_threads(pool, first, last, d_first, std::plus<T>(), T(0),
+                        ScanType::Exclusive, num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan of an iterator range using the
+ * process-wide thread pool; d_first may equal first for an in-place scan
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_exclusive_scan_threads(
+    InIt first, InIt last, OutIt d_first,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  parallel_exclusive_scan_threads(default_thread_pool(), first, last, d_first,
+                                  num_threads, mode);
+}
+
+#ifdef __cpp_lib_span
+/**
+ * @brief Performs parallel inclusive scan of a span using the process-wide
+ * thread pool; output must be at least as long as input and may be the same
+ * span for an in-place scan
+ */
+template <typename In, size_t InExtent, typename Out, size_t OutExtent>
+void parallel_inclusive_scan_threads(
+    std::span<In, InExtent> input, std::span<Out, OutExtent> output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("Output span is shorter than the input");
+  }
+  parallel_inclusive_scan_threads(input.data(), input.data() + input.size(),
+                                  output.data(), num_threads, mode);
+}
+
+/**
+ * @brief Performs parallel exclusive scan of a span using the process-wide
+ * thread pool; output must be at least as long as input and may be the same
+ * span for an in-place scan
+ */
+template <typename In, size_t InExtent, typename Out, size_t OutExtent>
+void parallel_exclusive_scan_threads(
+    std::span<In, InExtent> input, std::span<Out, OutExtent> output,
+    unsigned int num_threads = kAutoThreads,
+    ScanMode mode = ScanMode::ScanThenAdd) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("Output span is shorter than the input");
   }
-  // Wait for all adjustment operations to complete
-  for (auto& f : futures) {
-    f.get();
+  parallel_exclusive_scan_threads(input.data(), input.data() + input.size(),
+                                  output.data(), num_threads, mode);
+}
+#endif  // __cpp_lib_span
+
+/**
+ * @brief Performs parallel segmented inclusive scan on a persistent thread
+ * pool: a non-zero flag starts a new segment, so the output there equals the
+ * input and the running value of the previous segment is dropped
+ * @param pool The thread pool that executes the chunks
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param flags Iterator to the segment head flags, one per input element
+ * @param d_first Iterator to the first output element (may equal first)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ *
+ * Uses reduce-then-scan: every chunk but the last is reduced to a
+ * SegmentCarry, the carries are combined in order, and every chunk is then
+ * scanned once, seeded with the running value at its start.
+ */
+template <typename InIt, typename FlagIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_segmented_scan_threads(
+    ThreadPool& pool, InIt first, InIt last, FlagIt flags, OutIt d_first,
+    BinaryOp op, iter_value_t<InIt> identity,
+    unsigned int num_threads = kAutoThreads) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  if (n == 0) return;
+
+  if (num_threads == kAutoThreads) {
+    static const std::string key =
+        profile_key<T, BinaryOp>("segmented_scan_threads");
+    static thread_local CachedProfile cache;
+    std::vector<T> sample;  // allocated only if a calibration runs
+    std::vector<unsigned char> sample_flags;
+    TuningProfile tuned = pool_profile(
+        pool, key, cache,
+        [&]() {
+          sample.resize(kCalibrationElements, identity);
+          sample_flags.resize(kCalibrationElements, 0);
+          segmented_seeded_scan(sample.data(), sample_flags.data(),
+                                sample.data(), 0, sample.size(), identity, op);
+          keep_result(sample.back());
+        },
+        kCalibrationElements);
+    num_threads = plan_chunks(tuned, n, pool_workers(pool));
   }
+  if (num_threads > n) num_threads = n;
+  size_t chunk_size = (n + num_threads - 1) / num_threads;  // Ceiling division
+  num_threads = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+
+  // Phase 1: read-only reduction of every chunk but the last
+  std::vector<SegmentCarry<T>> carries(num_threads);
+  pool.parallel_for(num_threads - 1, [&](size_t i) {
+    carries[i] = segmented_chunk_reduce(first, flags, i * chunk_size,
+                                        (i + 1) * chunk_size, identity, op);
+  });
+  for (unsigned int i = 1; i + 1 < num_threads; ++i) {
+    carries[i] = combine_segment_carries(carries[i - 1], carries[i], op);
+  }
+
+  // Phase 2: scan every chunk once, seeded with the preceding running value
+  pool.parallel_for(num_threads, [&](size_t i) {
+    size_t start_idx = i * chunk_size;
+    size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+    segmented_seeded_scan(first, flags, d_first, start_idx, end_idx,
+                          i == 0 ? identity : carries[i - 1].value, op);
+  });
+}
+
+/**
+ * @brief Performs parallel segmented inclusive scan of vectors on a
+ * persistent thread pool (see the iterator overload)
+ * @param pool The thread pool that executes the chunks
+ * @param input The input vector to scan
+ * @param flags Segment head flags, one per input element
+ * @param output The output vector to store results (may be input itself)
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ */
+template <typename T, typename F, typename BinaryOp>
+void parallel_segmented_scan_threads(
+    ThreadPool& pool, const std::vector<T>& input, const std::vector<F>& flags,
+    std::vector<T>& output, BinaryOp op,
+    typename std::vector<T>::value_type identity,
+    unsigned int num_threads = kAutoThreads) {
+  if (flags.size() != input.size()) {
+    throw std::invalid_argument("Flags must have the size of the input");
+  }
+  output.resize(input.size());
+  parallel_segmented_scan_threads(pool, input.data(),
+                                  input.data() + input.size(), flags.begin(),
+                                  output.data(), op, identity, num_threads);
+}
+
+/**
+ * @brief Performs parallel segmented inclusive scan using the process-wide
+ * thread pool (see the pool overload)
+ * @param input The input vector to scan
+ * @param flags Segment head flags, one per input element
+ * @param output The output vector to store results
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param num_threads Number of threads to use (kAutoThreads, the default,
+ * lets the auto-tuner choose)
+ */
+template <typename T, typename F, typename BinaryOp>
+void parallel_segmented_scan_threads(
+    const std::vector<T>& input, const std::vector<F>& flags,
+    std::vector<T>& output, BinaryOp op,
+    typename std::vector<T>::value_type identity,
+    unsigned int num_threads = kAutoThreads) {
+  parallel_segmented_scan_threads(default_thread_pool(), input, flags, output,
+                                  op, identity, num_threads);
 }
 
 #endif  // INCLUSIVE_SCAN_THREADS_HPP
@@ -0,0 +1,489 @@
+// src/inner_product_common.hpp
+
+#ifndef INNER_PRODUCT_COMMON_HPP
+#define INNER_PRODUCT_COMMON_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief This header file contains the pieces shared by the threads and
+ * OpenMP inner products: the accumulation modes and the fused and batched
+ * kernels.
+ *
+ * A fused inner product computes a . b_0, ..., a . b_{k-1} in one pass over
+ * a: the input is walked in L1-sized tiles, and every tile of a is reused for
+ * all k operands while it is cached. A bandwidth-bound caller that used k
+ * separate calls streams 2k vectors; the fused call streams k + 1.
+ *
+ * A batched inner product computes many independent (usually small) pairs in
+ * one parallel call. The pairs are split into chunks of roughly equal element
+ * counts, so one long pair does not leave the other workers idle.
+ *
+ * The plain inner products take an AccumulationMode that trades speed for
+ * accuracy or for results that do not depend on the thread count.
+ *
+ * The matrix inner products work on row-major MatrixViews in place: row .
+ * row and column . column products of two matrices, and the Gram matrix of
+ * all row pairs. Columns are read through StridedIterator, which also lets
+ * the plain inner products take a column (or any strided vector) without
+ * copying it.
+ */
+
+/**
+ * @brief How the parallel inner products accumulate floating-point products
+ *
+ * Integer inner products are exact, so every mode gives the same result.
+ */
+enum class AccumulationMode {
+  /// Plain sums per chunk, combined in chunk order. The rounding (and so the
+  /// last bits of the result) depends on the number of chunks.
+  Fast,
+  /// Neumaier-compensated sums per chunk, combined with compensation. The
+  /// error no longer grows with n, but can still differ in the last bit
+  /// between chunk counts.
+  Compensated,
+  /// Plain sums of fixed-size blocks, combined by a fixed pairwise tree.
+  /// Bitwise identical for every thread count, schedule and backend.
+  Reproducible
+};
+
+/**
+ * @brief Running sum with Neumaier compensation: compensation collects the
+ * low-order bits that sum loses to rounding
+ */
+template <typename T>
+struct CompensatedSum {
+  T sum{};
+  T compensation{};
+
+  void add(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      T t = sum + value;
+      if (std::abs(sum) >= std::abs(value)) {
+        compensation += (sum - t) + value;
+      } else {
+        compensation += (value - t) + sum;
+      }
+      sum = t;
+    } else {
+      sum += value;
+    }
+  }
+
+  void add(const CompensatedSum& other) {
+    add(other.sum);
+    add(other.compensation);
+  }
+
+  T value() const { return sum + compensation; }
+};
+
+/**
+ * @brief Compensated inner product of [first1, last1) and the range starting
+ * at first2
+ */
+template <typename It1, typename It2, typename T>
+CompensatedSum<T> compensated_inner_product(It1 first1, It1 last1, It2 first2,
+                                            CompensatedSum<T> init) {
+  for (; first1 != last1; ++first1, ++first2) {
+    init.add(static_cast<T>(*first1 * *first2));
+  }
+  return init;
+}
+
+/**
+ * @brief Number of elements per block of a reproducible inner product; it is
+ * fixed so that the summation tree does not depend on the thread count
+ */
+constexpr size_t kReproducibleBlockSize = 4096;
+
+/**
+ * @brief Number of blocks a reproducible inner product of n elements uses
+ */
+inline size_t reproducible_block_count(size_t n) {
+  return (n + kReproducibleBlockSize - 1) / kReproducibleBlockSize;
+}
+
+/**
+ * @brief Stores the inner product of every block in [first_block, last_block)
+ * into block_sums
+ */
+template <typename It1, typename It2, typename T>
+void reproducible_block_sums(It1 first1, It2 first2, size_t n,
+                             size_t first_block, size_t last_block,
+                             T* block_sums) {
+  for (size_t blk = first_block; blk < last_block; ++blk) {
+    size_t start_idx = blk * kReproducibleBlockSize;
+    size_t end_idx = std::min(n, start_idx + kReproducibleBlockSize);
+    block_sums[blk] = std::inner_product(first1 + start_idx, first1 + end_idx,
+                                         first2 + start_idx, T(0));
+  }
+}
+
+/**
+ * @brief Sums values by a fixed pairwise tree (neighbours first), consuming
+ * the vector; the result depends only on the values
+ */
+template <typename T>
+T pairwise_sum(std::vector<T>& values) {
+  if (values.empty()) return T(0);
+  for (size_t width = values.size(); width > 1; width = (width + 1) / 2) {
+    for (size_t i = 0; i < width / 2; ++i) {
+      values[i] = values[2 * i] + values[2 * i + 1];
+    }
+    if (width % 2 == 1) values[width / 2] = values[width - 1];
+  }
+  return values[0];
+}
+
+/**
+ * @brief Inner product of [first1, last1) and the range starting at first2
+ * on the calling thread, accumulated as mode requires; Reproducible gives the
+ * same result as the parallel backends
+ */
+template <typename It1, typename It2>
+typename std::iterator_traits<It1>::value_type sequential_inner_product(
+    It1 first1, It1 last1, It2 first2, AccumulationMode mode) {
+  using T = typename std::iterator_traits<It1>::value_type;
+  const size_t n = static_cast<size_t>(std::distance(first1, last1));
+  if (mode == AccumulationMode::Compensated) {
+    return compensated_inner_product(first1, last1, first2,
+                                     CompensatedSum<T>())
+        .value();
+  }
+  if (mode == AccumulationMode::Reproducible) {
+    std::vector<T> block_sums(reproducible_block_count(n));
+    reproducible_block_sums(first1, first2, n, 0, block_sums.size(),
+                            block_sums.data());
+    return pairwise_sum(block_sums);
+  }
+  return std::inner_product(first1, last1, first2, T(0));
+}
+
+/**
+ * @brief Number of elements of a per fused tile; a tile of a stays in the L1
+ * cache while it is multiplied with every operand
+ */
+template <typename T>
+constexpr size_t fused_tile_size() {
+  return std::max<size_t>(256, (size_t(8) * 1024) / sizeof(T));
+}
+
+/**
+ * @brief Adds a[start_idx, end_idx) . others[k][start_idx, end_idx) to
+ * sums[k] for every operand k
+ *
+ * Within a chunk every sum is accumulated in index order, so each result
+ * matches std::inner_product over the chunk.
+ */
+template <typename It1, typename It2, typename T>
+void fused_chunk_inner_products(It1 first1, const std::vector<It2>& others,
+                                size_t start_idx, size_t end_idx, T* sums) {
+  const size_t tile = fused_tile_size<T>();
+  for (size_t t = start_idx; t < end_idx; t += tile) {
+    const size_t t_end = std::min(end_idx, t + tile);
+    for (size_t k = 0; k < others.size(); ++k) {
+      sums[k] = std::inner_product(first1 + t, first1 + t_end,
+                                   others[k] + t, sums[k]);
+    }
+  }
+}
+
+/**
+ * @brief Checks that every operand of a fused inner product is as long as a
+ * and returns the operands as iterators
+ */
+template <typename T>
+std::vector<typename std::vector<T>::const_iterator> fused_operands(
+    const std::vector<T>& a, const std::vector<const std::vector<T>*>& others) {
+  std::vector<typename std::vector<T>::const_iterator> operands;
+  operands.reserve(others.size());
+  for (const std::vector<T>* b : others) {
+    if (b == nullptr || b->size() != a.size()) {
+      throw std::invalid_argument("Vectors must be of the same size");
+    }
+    operands.push_back(b->begin());
+  }
+  return operands;
+}
+
+/**
+ * @brief Checks the pairs of a batched inner product and returns the running
+ * element counts: offsets[i] is the number of elements before pair i, and
+ * offsets.back() the total
+ */
+template <typename T>
+std::vector<size_t> batch_offsets(const std::vector<std::vector<T>>& a,
+                                  const std::vector<std::vector<T>>& b) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Batches must hold the same number of vectors");
+  }
+  std::vector<size_t> offsets(a.size() + 1, 0);
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].size() != b[i].size()) {
+      throw std::invalid_argument("Vectors must be of the same size");
+    }
+    offsets[i + 1] = offsets[i] + a[i].size();
+  }
+  return offsets;
+}
+
+/**
+ * @brief Splits the pairs of a batch into num_chunks chunks of roughly equal
+ * element counts
+ * @return num_chunks + 1 pair indices; chunk c holds the pairs
+ * [bounds[c], bounds[c + 1]), and may be empty
+ */
+inline std::vector<size_t> batch_bounds(const std::vector<size_t>& offsets,
+                                        unsigned int num_chunks) {
+  const size_t count = offsets.size() - 1;
+  const size_t total = offsets.back();
+  std::vector<size_t> bounds(num_chunks + 1, count);
+  bounds[0] = 0;
+  for (unsigned int c = 1; c < num_chunks; ++c) {
+    size_t target = total / num_chunks * c + total % num_chunks * c / num_chunks;
+    bounds[c] = static_cast<size_t>(
+        std::lower_bound(offsets.begin(), offsets.end() - 1, target) -
+        offsets.begin());
+  }
+  return bounds;
+}
+
+/**
+ * @brief Computes the inner products of the pairs [first, last) of a batch
+ */
+template <typename T>
+void batch_chunk_inner_products(const std::vector<std::vector<T>>& a,
+                                const std::vector<std::vector<T>>& b,
+                                size_t first, size_t last, T* results) {
+  for (size_t i = first; i < last; ++i) {
+    results[i] = std::inner_product(a[i].begin(), a[i].end(), b[i].begin(),
+                                    T(0));
+  }
+}
+
+/**
+ * @brief Random-access iterator over every stride-th element of an array
+ * (e.g. a column of a row-major matrix); the stride may be negative
+ *
+ * The iterator keeps the base pointer and an index, so an end iterator never
+ * forms a pointer past the array.
+ */
+template <typename T>
+class StridedIterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::remove_cv_t<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using reference = T&;
+
+  StridedIterator() = default;
+  StridedIterator(T* base, difference_type stride, difference_type index = 0)
+      : base_(base), stride_(stride), index_(index) {}
+
+  reference operator*() const { return base_[index_ * stride_]; }
+  pointer operator->() const { return base_ + index_ * stride_; }
+  reference operator[](difference_type i) const {
+    return base_[(index_ + i) * stride_];
+  }
+
+  StridedIterator& operator++() { ++index_; return *this; }
+  StridedIterator operator++(int) { StridedIterator old = *this; ++index_; return old; }
+  StridedIterator& operator--() { --index_; return *this; }
+  StridedIterator operator--(int) { StridedIterator old = *this; --index_; return old; }
+  StridedIterator& operator+=(difference_type i) { index_ += i; return *this; }
+  StridedIterator& operator-=(difference_type i) { index_ -= i; return *this; }
+
+  friend StridedIterator operator+(StridedIterator it, difference_type i) {
+    return it += i;
+  }
+  friend StridedIterator operator+(difference_type i, StridedIterator it) {
+    return it += i;
+  }
+  friend StridedIterator operator-(StridedIterator it, difference_type i) {
+    return it -= i;
+  }
+  friend difference_type operator-(const StridedIterator& a,
+                                   const StridedIterator& b) {
+    return a.index_ - b.index_;
+  }
+  friend bool operator==(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ == b.index_;
+  }
+  friend bool operator!=(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ != b.index_;
+  }
+  friend bool operator<(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ < b.index_;
+  }
+  friend bool operator>(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ > b.index_;
+  }
+  friend bool operator<=(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ <= b.index_;
+  }
+  friend bool operator>=(const StridedIterator& a, const StridedIterator& b) {
+    return a.index_ >= b.index_;
+  }
+
+ private:
+  T* base_ = nullptr;
+  difference_type stride_ = 1;
+  difference_type index_ = 0;
+};
+
+/**
+ * @brief Row-major matrix stored elsewhere: element (i, j) is
+ * data[i * row_stride + j]
+ */
+template <typename T>
+struct MatrixView {
+  const T* data = nullptr;
+  size_t rows = 0;
+  size_t cols = 0;
+  /// Elements between the starts of consecutive rows (at least cols)
+  size_t row_stride = 0;
+
+  const T* row(size_t i) const { return data + i * row_stride; }
+
+  /// Start of column j; the column ends at column(j) + rows
+  StridedIterator<const T> column(size_t j) const {
+    return StridedIterator<const T>(data + j,
+                                    static_cast<std::ptrdiff_t>(row_stride));
+  }
+};
+
+/**
+ * @brief Views a vector as a dense rows x cols row-major matrix
+ * @throws std::invalid_argument if the vector holds fewer than rows * cols
+ * elements
+ */
+template <typename T>
+MatrixView<T> matrix_view(const std::vector<T>& data, size_t rows,
+                          size_t cols) {
+  if (data.size() < rows * cols) {
+    throw std::invalid_argument("Matrix does not fit in its storage");
+  }
+  return MatrixView<T>{data.data(), rows, cols, cols};
+}
+
+/**
+ * @brief Checks that the operands of a row or column product have the same
+ * shape
+ */
+template <typename T>
+void check_same_shape(const MatrixView<T>& a, const MatrixView<T>& b) {
+  if (a.rows != b.rows || a.cols != b.cols) {
+    throw std::invalid_argument("Matrices must have the same shape");
+  }
+}
+
+/**
+ * @brief Computes the row products a.row(i) . b.row(i) of the rows
+ * [first, last)
+ */
+template <typename T>
+void row_chunk_inner_products(const MatrixView<T>& a, const MatrixView<T>& b,
+                              size_t first, size_t last, T* results) {
+  for (size_t i = first; i < last; ++i) {
+    results[i] = std::inner_product(a.row(i), a.row(i) + a.cols, b.row(i),
+                                    T(0));
+  }
+}
+
+/**
+ * @brief Adds the products of the rows [first, last) to the column sums:
+ * sums[j] += a(i, j) * b(i, j)
+ *
+ * The rows are read contiguously, one tile of columns at a time, so the
+ * tile of sums stays in the L1 cache while the rows stream past it. Every
+ * sum is accumulated in row order, so each result matches
+ * std::inner_product over the column.
+ */
+template <typename T>
+void column_chunk_inner_products(const MatrixView<T>& a,
+                                 const MatrixView<T>& b, size_t first,
+                                 size_t last, T* sums) {
+  const size_t tile = fused_tile_size<T>();
+  for (size_t t = 0; t < a.cols; t += tile) {
+    const size_t t_end = std::min(a.cols, t + tile);
+    for (size_t i = first; i < last; ++i) {
+      const T* x = a.row(i);
+      const T* y = b.row(i);
+      for (size_t j = t; j < t_end; ++j) {
+        sums[j] += x[j] * y[j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Number of rows per tile of a Gram matrix
+ */
+constexpr size_t kGramTileRows = 32;
+
+/**
+ * @brief Number of columns per depth block of a Gram tile; the two row tiles
+ * of a block (about 128 KB) stay in the L2 cache while every row pair of the
+ * tile is multiplied
+ */
+template <typename T>
+constexpr size_t gram_depth_block() {
+  return std::max<size_t>(256,
+                          (size_t(128) * 1024) / (2 * kGramTileRows * sizeof(T)));
+}
+
+/**
+ * @brief Tiles (ti, tj), ti <= tj, of the upper triangle of the Gram matrix
+ * of rows rows, in row-major order
+ */
+inline std::vector<std::pair<size_t, size_t>> gram_tile_pairs(size_t rows) {
+  const size_t tiles = (rows + kGramTileRows - 1) / kGramTileRows;
+  std::vector<std::pair<size_t, size_t>> pairs;
+  pairs.reserve(tiles * (tiles + 1) / 2);
+  for (size_t ti = 0; ti < tiles; ++ti) {
+    for (size_t tj = ti; tj < tiles; ++tj) pairs.emplace_back(ti, tj);
+  }
+  return pairs;
+}
+
+/**
+ * @brief Computes the entries of tile (ti, tj) of the Gram matrix of a
+ * (gram[i * a.rows + j] = a.row(i) . a.row(j)) and their mirror images
+ *
+ * gram must be zero on entry. Every entry is accumulated in column order, so
+ * it matches std::inner_product over the two rows.
+ */
+template <typename T>
+void gram_tile(const MatrixView<T>& a, size_t ti, size_t tj, T* gram) {
+  const size_t n = a.rows;
+  const size_t i0 = ti * kGramTileRows, i1 = std::min(n, i0 + kGramTileRows);
+  const size_t j0 = tj * kGramTileRows, j1 = std::min(n, j0 + kGramTileRows);
+  const size_t depth = gram_depth_block<T>();
+  for (size_t k = 0; k < a.cols; k += depth) {
+    const size_t k_end = std::min(a.cols, k + depth);
+    for (size_t i = i0; i < i1; ++i) {
+      const T* x = a.row(i);
+      for (size_t j = std::max(i, j0); j < j1; ++j) {
+        gram[i * n + j] = std::inner_product(x + k, x + k_end, a.row(j) + k,
+                                             gram[i * n + j]);
+      }
+    }
+  }
+  for (size_t i = i0; i < i1; ++i) {
+    for (size_t j = std::max(i + 1, j0); j < j1; ++j) {
+      gram[j * n + i] = gram[i * n + j];
+    }
+  }
+}
+
+#endif  // INNER_PRODUCT_COMMON_HPP
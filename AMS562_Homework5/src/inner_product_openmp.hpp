@@ -4,24 +4,117 @@
 #define INNER_PRODUCT_OPENMP_HPP
 
 #include <vector>
+#include <algorithm>
 #include <omp.h>
+#include <numeric>
 #include <stdexcept>
+#include <string>
 
+#include "auto_tune.hpp"
+#include "instrumentation.hpp"
+#include "inner_product_common.hpp"
+#include "padded_slots.hpp"
+#include "range_traits.hpp"
 
-// Function to compute the inner product using OpenMP
+// Function to look up the tuned profile of the OpenMP inner products for
+// element type T, calibrating it on first use
 template <typename T>
-T parallel_inner_product_openmp(const std::vector<T>& a,
-                                const std::vector<T>& b) {
-  if (a.size() != b.size()) {
-    throw std::invalid_argument("Vectors must be of the same size");
-  }
+TuningProfile inner_product_openmp_profile() {
+  static const std::string key = profile_key<T>("inner_product_openmp");
+  static thread_local CachedProfile cache;
+  std::vector<T> sample;  // allocated only if a calibration runs
+  return openmp_profile(
+      key, cache,
+      [&]() {
+        sample.resize(kCalibrationElements, T(1));
+        keep_result(std::inner_product(sample.begin(), sample.end(),
+                                       sample.begin(), T(0)));
+      },
+      kCalibrationElements);
+}
 
+// Function to compute the inner product of two iterator ranges using OpenMP.
+// first2 must start a range at least last1 - first1 long; mode selects how
+// floating-point products are accumulated (see AccumulationMode).
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+iter_value_t<It1> parallel_inner_product_openmp(
+    It1 first1, It1 last1, It2 first2,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  using T = iter_value_t<It1>;
   T result = T(0);
-  const size_t n = a.size();
-  const unsigned int num_threads = omp_get_max_threads();
-  size_t chunk_size = (n + num_threads - 1) / num_threads;  // Ceiling division
-
+  const size_t n = static_cast<size_t>(last1 - first1);
   if (n == 0) return result; // Handle empty vectors
+  AMS562_TRACE_REGION("inner_product_openmp", n);
+
+  // Let the tuned profile choose between a serial run and the grain size
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), n,
+      static_cast<unsigned int>(omp_get_max_threads()));
+
+  if (mode == AccumulationMode::Reproducible) {
+    // Fixed blocks summed by a fixed tree; the tasks only decide who sums
+    // which blocks, so the result matches the threads version bit for bit
+    const size_t num_blocks = reproducible_block_count(n);
+    std::vector<T> block_sums(num_blocks);
+    if (num_chunks == 1) {
+      reproducible_block_sums(first1, first2, n, 0, num_blocks,
+                              block_sums.data());
+    } else {
+      const size_t blocks_per_chunk = (num_blocks + num_chunks - 1) / num_chunks;
+      #pragma omp parallel
+      #pragma omp single nowait
+      {
+        #pragma omp taskloop grainsize(1)
+        for (size_t first_block = 0; first_block < num_blocks;
+             first_block += blocks_per_chunk) {
+          AMS562_TRACE_CHUNK("inner_product_openmp/reproducible",
+                             first_block / blocks_per_chunk,
+                             blocks_per_chunk * kReproducibleBlockSize);
+          reproducible_block_sums(
+              first1, first2, n, first_block,
+              std::min(num_blocks, first_block + blocks_per_chunk),
+              block_sums.data());
+        }
+      }
+    }
+    return pairwise_sum(block_sums);
+  }
+
+  if (mode == AccumulationMode::Compensated) {
+    if (num_chunks == 1) {
+      return compensated_inner_product(first1, last1, first2,
+                                       CompensatedSum<T>())
+          .value();
+    }
+    const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+    num_chunks = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+    PaddedSlots<CompensatedSum<T>> partial_sums(num_chunks);
+    #pragma omp parallel
+    #pragma omp single nowait
+    {
+      #pragma omp taskloop grainsize(1)
+      for (unsigned int c = 0; c < num_chunks; ++c) {
+        size_t start_idx = c * chunk_size;
+        size_t end_idx = std::min(n, start_idx + chunk_size);
+        AMS562_TRACE_CHUNK("inner_product_openmp/compensated", c,
+                           end_idx - start_idx);
+        partial_sums[c] = compensated_inner_product(
+            first1 + start_idx, first1 + end_idx, first2 + start_idx,
+            CompensatedSum<T>());
+      }
+    }
+    // Combine results from all chunks in order, keeping their compensation
+    CompensatedSum<T> total;
+    for (size_t c = 0; c < partial_sums.size(); ++c) {
+      total.add(partial_sums[c]);
+    }
+    return total.value();
+  }
+
+  if (num_chunks == 1) {
+    return std::inner_product(first1, last1, first2, result);
+  }
+  size_t chunk_size = (n + num_chunks - 1) / num_chunks;  // Ceiling division
 
   // Create a parallel region
   #pragma omp parallel
@@ -35,7 +128,7 @@ T parallel_inner_product_openmp(const std::vector<T>& a,
             // Divide the work using taskloop  
             #pragma omp taskloop reduction(+ : result) grainsize(chunk_size)
             for (size_t i = 0; i < n; ++i) {
-              result += a[i] * b[i];
+              result += first1[i] * first2[i];
             }
         } 
      }
@@ -45,4 +138,229 @@ T parallel_inner_product_openmp(const std::vector<T>& a,
   return result;
 }
 
+// Function to compute the inner product using OpenMP
+template <typename T>
+T parallel_inner_product_openmp(const std::vector<T>& a,
+                                const std::vector<T>& b,
+                                AccumulationMode mode = AccumulationMode::Fast) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return parallel_inner_product_openmp(a.begin(), a.end(), b.begin(), mode);
+}
+
+#ifdef __cpp_lib_span
+// Function to compute the inner product of two spans of the same size using
+// OpenMP
+template <typename A, size_t ExtentA, typename B, size_t ExtentB>
+std::remove_cv_t<A> parallel_inner_product_openmp(
+    std::span<A, ExtentA> a, std::span<B, ExtentB> b,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return parallel_inner_product_openmp(a.data(), a.data() + a.size(),
+                                       b.data(), mode);
+}
+#endif  // __cpp_lib_span
+
+// Function to compute several inner products that share the operand a in one
+// pass using OpenMP. others holds the start of every other operand (each at
+// least last1 - first1 long); returns result[k] = a . others[k].
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+std::vector<iter_value_t<It1>> parallel_fused_inner_product_openmp(
+    It1 first1, It1 last1, const std::vector<It2>& others) {
+  using T = iter_value_t<It1>;
+  const size_t n = static_cast<size_t>(last1 - first1);
+  const size_t k = others.size();
+  std::vector<T> results(k, T(0));
+  if (n == 0 || k == 0) return results;
+
+  // One element of a costs k multiply-adds
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), n * k,
+      static_cast<unsigned int>(omp_get_max_threads()));
+  if (num_chunks == 1) {
+    fused_chunk_inner_products(first1, others, 0, n, results.data());
+    return results;
+  }
+  num_chunks = static_cast<unsigned int>(std::min<size_t>(num_chunks, n));
+  const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  num_chunks = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+  PaddedRows<T> partial_results(num_chunks, k, T(0));
+
+#pragma omp parallel
+#pragma omp single nowait
+  {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int c = 0; c < num_chunks; ++c) {
+      size_t start_idx = c * chunk_size;
+      size_t end_idx = std::min(n, start_idx + chunk_size);
+      fused_chunk_inner_products(first1, others, start_idx, end_idx,
+                                 partial_results.row(c));
+    }
+  }
+
+  // Combine results from all chunks in order
+  for (unsigned int c = 0; c < num_chunks; ++c) {
+    for (size_t j = 0; j < k; ++j) {
+      results[j] += partial_results.row(c)[j];
+    }
+  }
+  return results;
+}
+
+// Function to compute several inner products that share the vector a in one
+// pass using OpenMP; every operand must have the size of a (e.g. {&b, &c, &a})
+template <typename T>
+std::vector<T> parallel_fused_inner_product_openmp(
+    const std::vector<T>& a, const std::vector<const std::vector<T>*>& others) {
+  return parallel_fused_inner_product_openmp(a.begin(), a.end(),
+                                             fused_operands(a, others));
+}
+
+// Function to compute the inner products of a batch of independent vector
+// pairs using OpenMP; returns result[i] = a[i] . b[i]
+template <typename T>
+std::vector<T> parallel_batched_inner_product_openmp(
+    const std::vector<std::vector<T>>& a,
+    const std::vector<std::vector<T>>& b) {
+  std::vector<size_t> offsets = batch_offsets(a, b);
+  std::vector<T> results(a.size(), T(0));
+
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), offsets.back(),
+      static_cast<unsigned int>(omp_get_max_threads()));
+  num_chunks = static_cast<unsigned int>(std::min<size_t>(num_chunks, a.size()));
+  if (num_chunks <= 1) {
+    batch_chunk_inner_products(a, b, 0, a.size(), results.data());
+    return results;
+  }
+
+  // Chunks hold whole pairs and roughly the same number of elements
+  std::vector<size_t> bounds = batch_bounds(offsets, num_chunks);
+#pragma omp parallel
+#pragma omp single nowait
+  {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int c = 0; c < num_chunks; ++c) {
+      batch_chunk_inner_products(a, b, bounds[c], bounds[c + 1],
+                                 results.data());
+    }
+  }
+  return results;
+}
+
+// Function to compute the row products a.row(i) . b.row(i) of two matrices
+// of the same shape using OpenMP, reading the rows in place
+template <typename T>
+std::vector<T> parallel_row_inner_products_openmp(const MatrixView<T>& a,
+                                                  const MatrixView<T>& b) {
+  check_same_shape(a, b);
+  std::vector<T> results(a.rows, T(0));
+  if (a.rows == 0) return results;
+
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), a.rows * a.cols,
+      static_cast<unsigned int>(omp_get_max_threads()));
+  if (num_chunks == 1) {
+    row_chunk_inner_products(a, b, 0, a.rows, results.data());
+    return results;
+  }
+  if (a.rows < num_chunks) {
+    // Too few rows to share out: split every row product instead
+    for (size_t i = 0; i < a.rows; ++i) {
+      results[i] = parallel_inner_product_openmp(a.row(i), a.row(i) + a.cols,
+                                                 b.row(i));
+    }
+    return results;
+  }
+
+  const size_t chunk_size = (a.rows + num_chunks - 1) / num_chunks;
+  num_chunks = static_cast<unsigned int>((a.rows + chunk_size - 1) / chunk_size);
+#pragma omp parallel
+#pragma omp single nowait
+  {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int c = 0; c < num_chunks; ++c) {
+      row_chunk_inner_products(a, b, c * chunk_size,
+                               std::min(a.rows, (c + 1) * chunk_size),
+                               results.data());
+    }
+  }
+  return results;
+}
+
+// Function to compute the column products of two matrices of the same shape
+// using OpenMP without copying the columns (see
+// parallel_column_inner_products_threads)
+template <typename T>
+std::vector<T> parallel_column_inner_products_openmp(const MatrixView<T>& a,
+                                                     const MatrixView<T>& b) {
+  check_same_shape(a, b);
+  std::vector<T> results(a.cols, T(0));
+  if (a.rows == 0 || a.cols == 0) return results;
+
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), a.rows * a.cols,
+      static_cast<unsigned int>(omp_get_max_threads()));
+  num_chunks = static_cast<unsigned int>(std::min<size_t>(num_chunks, a.rows));
+  if (num_chunks == 1) {
+    column_chunk_inner_products(a, b, 0, a.rows, results.data());
+    return results;
+  }
+
+  const size_t chunk_size = (a.rows + num_chunks - 1) / num_chunks;
+  num_chunks = static_cast<unsigned int>((a.rows + chunk_size - 1) / chunk_size);
+  PaddedRows<T> partial_results(num_chunks, a.cols, T(0));
+#pragma omp parallel
+#pragma omp single nowait
+  {
+#pragma omp taskloop grainsize(1)
+    for (unsigned int c = 0; c < num_chunks; ++c) {
+      column_chunk_inner_products(a, b, c * chunk_size,
+                                  std::min(a.rows, (c + 1) * chunk_size),
+                                  partial_results.row(c));
+    }
+  }
+
+  // Combine results from all chunks in order
+  for (unsigned int c = 0; c < num_chunks; ++c) {
+    for (size_t j = 0; j < a.cols; ++j) {
+      results[j] += partial_results.row(c)[j];
+    }
+  }
+  return results;
+}
+
+// Function to compute the Gram matrix g[i * a.rows + j] = a.row(i) . a.row(j)
+// of all row pairs of a matrix using OpenMP, one task per cache-blocked tile
+// of the upper triangle (see gram_tile)
+template <typename T>
+std::vector<T> parallel_gram_matrix_openmp(const MatrixView<T>& a) {
+  std::vector<T> gram(a.rows * a.rows, T(0));
+  if (a.rows == 0) return gram;
+  std::vector<std::pair<size_t, size_t>> tiles = gram_tile_pairs(a.rows);
+
+  // The upper triangle costs rows * (rows + 1) / 2 * cols multiply-adds
+  unsigned int num_chunks = plan_chunks(
+      inner_product_openmp_profile<T>(), a.rows * (a.rows + 1) / 2 * a.cols,
+      static_cast<unsigned int>(omp_get_max_threads()));
+  if (num_chunks == 1 || tiles.size() == 1) {
+    for (const auto& tile : tiles) gram_tile(a, tile.first, tile.second, gram.data());
+    return gram;
+  }
+
+  // Every tile writes its own entries, so the tasks need no combining
+#pragma omp parallel
+#pragma omp single nowait
+  {
+#pragma omp taskloop grainsize(1)
+    for (size_t t = 0; t < tiles.size(); ++t) {
+      gram_tile(a, tiles[t].first, tiles[t].second, gram.data());
+    }
+  }
+  return gram;
+}
+
 #endif  // INNER_PRODUCT_OPENMP_HPP
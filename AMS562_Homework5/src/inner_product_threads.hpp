@@ -4,57 +4,542 @@
 #define INNER_PRODUCT_THREADS_HPP
 
 #include <vector>
+#include <algorithm>
 #include <thread>
-#include <future>
 #include <numeric>
+#include <stdexcept>
+#include <string>
 
-// Function to compute the inner product of two vectors in parallel using C++
-// threads Parameters:
+#include "auto_tune.hpp"
+#include "instrumentation.hpp"
+#include "inner_product_common.hpp"
+#include "padded_slots.hpp"
+#include "range_traits.hpp"
+#include "thread_pool.hpp"
+
+// Function to look up the tuned profile of the threads inner products for
+// element type T, calibrating it on first use. Parameters:
+//   pool: thread pool the inner products run on
+// Returns: serial cutoff and grain size, in multiply-adds
+template <typename T>
+TuningProfile inner_product_threads_profile(ThreadPool& pool) {
+  static const std::string key = profile_key<T>("inner_product_threads");
+  static thread_local CachedProfile cache;
+  std::vector<T> sample;  // allocated only if a calibration runs
+  return pool_profile(
+      pool, key, cache,
+      [&]() {
+        sample.resize(kCalibrationElements, T(1));
+        keep_result(std::inner_product(sample.begin(), sample.end(),
+                                       sample.begin(), T(0)));
+      },
+      kCalibrationElements);
+}
+
+// Function to compute the inner product of two iterator ranges in parallel on
+// a persistent thread pool. Parameters:
+//   pool: thread pool that executes the chunks
+//   first1, last1: first input range
+//   first2: start of the second input range (at least last1 - first1 long)
+//   num_threads: number of chunks to split the work into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+//   mode: how floating-point products are accumulated (see AccumulationMode)
+// Returns: inner product of the two ranges
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+iter_value_t<It1> parallel_inner_product_threads(
+    ThreadPool& pool, It1 first1, It1 last1, It2 first2,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  using T = iter_value_t<It1>;
+
+  size_t n = static_cast<size_t>(last1 - first1);
+  AMS562_TRACE_REGION("inner_product_threads", n);
+
+  // Let the tuned profile choose between a serial run and a chunk count
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool), n,
+                              pool_workers(pool));
+  }
+  if (mode == AccumulationMode::Reproducible) {
+    // Fixed blocks summed by a fixed tree; chunks only decide who sums which
+    // blocks
+    size_t num_blocks = reproducible_block_count(n);
+    std::vector<T> block_sums(num_blocks);
+    if (num_threads > num_blocks) {
+      num_threads = static_cast<unsigned int>(num_blocks);
+    }
+    if (num_threads <= 1) {
+      reproducible_block_sums(first1, first2, n, 0, num_blocks,
+                              block_sums.data());
+    } else {
+      size_t blocks_per_chunk = (num_blocks + num_threads - 1) / num_threads;
+      num_threads = static_cast<unsigned int>(
+          (num_blocks + blocks_per_chunk - 1) / blocks_per_chunk);
+      pool.parallel_for(num_threads, [&](size_t i) {
+        size_t first_block = i * blocks_per_chunk;
+        AMS562_TRACE_CHUNK("inner_product_threads/reproducible", i,
+                           blocks_per_chunk * kReproducibleBlockSize);
+        reproducible_block_sums(
+            first1, first2, n, first_block,
+            std::min(num_blocks, first_block + blocks_per_chunk),
+            block_sums.data());
+      });
+    }
+    return pairwise_sum(block_sums);
+  }
+  if (num_threads <= 1) {
+    if (mode == AccumulationMode::Compensated) {
+      return compensated_inner_product(first1, last1, first2,
+                                       CompensatedSum<T>())
+          .value();
+    }
+    return std::inner_product(first1, last1, first2, T(0));
+  }
+
+  // Calculate work distribution using ceiling division for better load
+  // balancing
+  if (num_threads > n) num_threads = n == 0 ? 1 : static_cast<unsigned int>(n);
+  size_t chunk_size = (n + num_threads - 1) / num_threads;  // Ceiling division
+  // Drop the trailing chunks that ceiling division leaves empty
+  if (n > 0) {
+    num_threads = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+  }
+  if (mode == AccumulationMode::Compensated) {
+    PaddedSlots<CompensatedSum<T>> partial_sums(num_threads);
+    pool.parallel_for(num_threads, [&](size_t i) {
+      size_t start_idx = i * chunk_size;
+      size_t end_idx = std::min(n, start_idx + chunk_size);
+      AMS562_TRACE_CHUNK("inner_product_threads/compensated", i,
+                         end_idx - start_idx);
+      partial_sums[i] = compensated_inner_product(
+          first1 + start_idx, first1 + end_idx, first2 + start_idx,
+          CompensatedSum<T>());
+    });
+    // Combine results from all chunks in order, keeping their compensation
+    CompensatedSum<T> total;
+    for (size_t i = 0; i < partial_sums.size(); ++i) {
+      total.add(partial_sums[i]);
+    }
+    return total.value();
+  }
+  PaddedSlots<T> partial_results(num_threads, T(0));
+
+  // Each pool task computes the inner product for its assigned portion
+  pool.parallel_for(num_threads, [&](size_t i) {
+    // Calculate start and end indices for this chunk
+    size_t start_idx = i * chunk_size;
+    // For last chunk, process remaining elements
+    size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+    AMS562_TRACE_CHUNK("inner_product_threads/fast", i, end_idx - start_idx);
+
+    partial_results[i] = std::inner_product(
+        first1 + start_idx,  // Start of first range chunk
+        first1 + end_idx,    // End of first range chunk
+        first2 + start_idx,  // Start of second range chunk
+        T(0)                 // Initial sum value
+    );
+  });
+
+  // Combine results from all chunks in order
+  T result = T(0);
+  for (size_t i = 0; i < partial_results.size(); ++i) {
+    result += partial_results[i];
+  }
+
+  return result;
+}
+
+// Function to compute the inner product of two iterator ranges in parallel
+// using the process-wide thread pool. Parameters:
+//   first1, last1: first input range
+//   first2: start of the second input range (at least last1 - first1 long)
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+//   mode: how floating-point products are accumulated (see AccumulationMode)
+// Returns: inner product of the two ranges
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+iter_value_t<It1> parallel_inner_product_threads(
+    It1 first1, It1 last1, It2 first2,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  return parallel_inner_product_threads(default_thread_pool(), first1, last1,
+                                        first2, num_threads, mode);
+}
+
+// Function to compute the inner product of two vectors in parallel on a
+// persistent thread pool. Parameters:
+//   pool: thread pool that executes the chunks
 //   a, b: input vectors
-//   num_threads: number of threads to use (defaults to hardware concurrency)
+//   num_threads: number of chunks to split the work into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+//   mode: how floating-point products are accumulated (see AccumulationMode)
 // Returns: inner product of vectors a and b
 template <typename T>
 T parallel_inner_product_threads(
-    const std::vector<T>& a, const std::vector<T>& b,
-    unsigned int num_threads = std::thread::hardware_concurrency()) {
+    ThreadPool& pool, const std::vector<T>& a, const std::vector<T>& b,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
   // Verify input vectors have same size
   if (a.size() != b.size()) {
     throw std::invalid_argument("Vectors must be of the same size");
   }
+  return parallel_inner_product_threads(pool, a.begin(), a.end(), b.begin(),
+                                        num_threads, mode);
+}
 
-  // Calculate work distribution using ceiling division for better load
-  // balancing
-  size_t n = a.size();
+// Function to compute the inner product of two vectors in parallel using the
+// process-wide thread pool. Parameters:
+//   a, b: input vectors
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+//   mode: how floating-point products are accumulated (see AccumulationMode)
+// Returns: inner product of vectors a and b
+template <typename T>
+T parallel_inner_product_threads(
+    const std::vector<T>& a, const std::vector<T>& b,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  return parallel_inner_product_threads(default_thread_pool(), a, b,
+                                        num_threads, mode);
+}
+
+#ifdef __cpp_lib_span
+// Function to compute the inner product of two spans in parallel using the
+// process-wide thread pool. Parameters:
+//   a, b: input spans of the same size
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+//   mode: how floating-point products are accumulated (see AccumulationMode)
+// Returns: inner product of spans a and b
+template <typename A, size_t ExtentA, typename B, size_t ExtentB>
+std::remove_cv_t<A> parallel_inner_product_threads(
+    std::span<A, ExtentA> a, std::span<B, ExtentB> b,
+    unsigned int num_threads = kAutoThreads,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return parallel_inner_product_threads(a.data(), a.data() + a.size(),
+                                        b.data(), num_threads, mode);
+}
+#endif  // __cpp_lib_span
+
+// Function to compute several inner products that share the operand a in one
+// parallel pass on a persistent thread pool. Parameters:
+//   pool: thread pool that executes the chunks
+//   first1, last1: shared input range a
+//   others: start of every other operand (each at least last1 - first1 long)
+//   num_threads: number of chunks to split the work into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: result[k] = a . others[k]
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+std::vector<iter_value_t<It1>> parallel_fused_inner_product_threads(
+    ThreadPool& pool, It1 first1, It1 last1, const std::vector<It2>& others,
+    unsigned int num_threads = kAutoThreads) {
+  using T = iter_value_t<It1>;
+
+  size_t n = static_cast<size_t>(last1 - first1);
+  const size_t k = others.size();
+  std::vector<T> results(k, T(0));
+  if (n == 0 || k == 0) return results;
+
+  // One element of a costs k multiply-adds
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool), n * k,
+                              pool_workers(pool));
+  }
+  if (num_threads <= 1) {
+    fused_chunk_inner_products(first1, others, 0, n, results.data());
+    return results;
+  }
+
+  if (num_threads > n) num_threads = static_cast<unsigned int>(n);
   size_t chunk_size = (n + num_threads - 1) / num_threads;  // Ceiling division
-  std::vector<std::future<T>> futures;  // Container to store future results
+  num_threads = static_cast<unsigned int>((n + chunk_size - 1) / chunk_size);
+  PaddedRows<T> partial_results(num_threads, k, T(0));
 
-  // Launch threads to compute partial inner products
-  for (unsigned int i = 0; i < num_threads; ++i) {
-    // Calculate start and end indices for this thread
+  // Each pool task multiplies its tiles of a with every operand
+  pool.parallel_for(num_threads, [&](size_t i) {
     size_t start_idx = i * chunk_size;
-    // For last thread, process remaining elements
-    size_t end_idx = (i == num_threads - 1) ? n : start_idx + chunk_size;
+    size_t end_idx = std::min(n, start_idx + chunk_size);
+    fused_chunk_inner_products(first1, others, start_idx, end_idx,
+                               partial_results.row(i));
+  });
 
-    // Launch async task for this chunk
-    // Each task computes inner product for its assigned portion
-    futures.emplace_back(
-        std::async(std::launch::async, [&, start_idx, end_idx]() -> T {
-          return std::inner_product(
-              a.begin() + start_idx,  // Start of first vector chunk
-              a.begin() + end_idx,    // End of first vector chunk
-              b.begin() + start_idx,  // Start of second vector chunk
-              T(0)                    // Initial sum value
-          );
-        }));
+  // Combine results from all chunks in order
+  for (unsigned int i = 0; i < num_threads; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      results[j] += partial_results.row(i)[j];
+    }
   }
+  return results;
+}
 
-  // Combine results from all threads
-  T result = T(0);
-  for (auto& f : futures) {
-    result += f.get();  // Wait for and add each thread's result
+// Function to compute several inner products that share the operand a in one
+// parallel pass using the process-wide thread pool. Parameters:
+//   first1, last1: shared input range a
+//   others: start of every other operand (each at least last1 - first1 long)
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: result[k] = a . others[k]
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+std::vector<iter_value_t<It1>> parallel_fused_inner_product_threads(
+    It1 first1, It1 last1, const std::vector<It2>& others,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_fused_inner_product_threads(default_thread_pool(), first1,
+                                              last1, others, num_threads);
+}
+
+// Function to compute several inner products that share the vector a in one
+// parallel pass on a persistent thread pool. Parameters:
+//   pool: thread pool that executes the chunks
+//   a: shared input vector
+//   others: the other operands, each of the size of a (e.g. {&b, &c, &a})
+//   num_threads: number of chunks to split the work into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: result[k] = a . *others[k]
+template <typename T>
+std::vector<T> parallel_fused_inner_product_threads(
+    ThreadPool& pool, const std::vector<T>& a,
+    const std::vector<const std::vector<T>*>& others,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_fused_inner_product_threads(
+      pool, a.begin(), a.end(), fused_operands(a, others), num_threads);
+}
+
+// Function to compute several inner products that share the vector a in one
+// parallel pass using the process-wide thread pool. Parameters:
+//   a: shared input vector
+//   others: the other operands, each of the size of a (e.g. {&b, &c, &a})
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: result[k] = a . *others[k]
+template <typename T>
+std::vector<T> parallel_fused_inner_product_threads(
+    const std::vector<T>& a, const std::vector<const std::vector<T>*>& others,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_fused_inner_product_threads(default_thread_pool(), a, others,
+                                              num_threads);
+}
+
+// Function to compute the inner products of a batch of independent vector
+// pairs in one parallel call on a persistent thread pool. Parameters:
+//   pool: thread pool that executes the chunks
+//   a, b: batches of the same length; a[i] and b[i] must have the same size
+//   num_threads: number of chunks to split the batch into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: result[i] = a[i] . b[i]
+template <typename T>
+std::vector<T> parallel_batched_inner_product_threads(
+    ThreadPool& pool, const std::vector<std::vector<T>>& a,
+    const std::vector<std::vector<T>>& b,
+    unsigned int num_threads = kAutoThreads) {
+  std::vector<size_t> offsets = batch_offsets(a, b);
+  std::vector<T> results(a.size(), T(0));
+
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool),
+                              offsets.back(), pool_workers(pool));
+  }
+  if (num_threads > a.size()) num_threads = static_cast<unsigned int>(a.size());
+  if (num_threads <= 1) {
+    batch_chunk_inner_products(a, b, 0, a.size(), results.data());
+    return results;
   }
 
-  return result;
+  // Chunks hold whole pairs and roughly the same number of elements
+  std::vector<size_t> bounds = batch_bounds(offsets, num_threads);
+  pool.parallel_for(num_threads, [&](size_t c) {
+    batch_chunk_inner_products(a, b, bounds[c], bounds[c + 1],
+                               results.data());
+  });
+  return results;
+}
+
+// Function to compute the inner products of a batch of independent vector
+// pairs in one parallel call using the process-wide thread pool. Parameters:
+//   a, b: batches of the same length; a[i] and b[i] must have the same size
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: result[i] = a[i] . b[i]
+template <typename T>
+std::vector<T> parallel_batched_inner_product_threads(
+    const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_batched_inner_product_threads(default_thread_pool(), a, b,
+                                                num_threads);
+}
+
+// Function to compute the row products a.row(i) . b.row(i) of two matrices
+// of the same shape on a persistent thread pool, reading the rows in place.
+// Parameters:
+//   pool: thread pool that executes the chunks
+//   a, b: row-major matrix views of the same shape
+//   num_threads: number of chunks to split the work into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: result[i] = a.row(i) . b.row(i)
+template <typename T>
+std::vector<T> parallel_row_inner_products_threads(
+    ThreadPool& pool, const MatrixView<T>& a, const MatrixView<T>& b,
+    unsigned int num_threads = kAutoThreads) {
+  check_same_shape(a, b);
+  std::vector<T> results(a.rows, T(0));
+  if (a.rows == 0) return results;
+
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool),
+                              a.rows * a.cols, pool_workers(pool));
+  }
+  if (num_threads <= 1) {
+    row_chunk_inner_products(a, b, 0, a.rows, results.data());
+    return results;
+  }
+  if (a.rows < num_threads) {
+    // Too few rows to share out: split every row product instead
+    for (size_t i = 0; i < a.rows; ++i) {
+      results[i] = parallel_inner_product_threads(
+          pool, a.row(i), a.row(i) + a.cols, b.row(i), num_threads);
+    }
+    return results;
+  }
+
+  size_t chunk_size = (a.rows + num_threads - 1) / num_threads;
+  num_threads = static_cast<unsigned int>((a.rows + chunk_size - 1) / chunk_size);
+  pool.parallel_for(num_threads, [&](size_t c) {
+    row_chunk_inner_products(a, b, c * chunk_size,
+                             std::min(a.rows, (c + 1) * chunk_size),
+                             results.data());
+  });
+  return results;
+}
+
+// Function to compute the row products of two matrices using the
+// process-wide thread pool. Parameters:
+//   a, b: row-major matrix views of the same shape
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: result[i] = a.row(i) . b.row(i)
+template <typename T>
+std::vector<T> parallel_row_inner_products_threads(
+    const MatrixView<T>& a, const MatrixView<T>& b,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_row_inner_products_threads(default_thread_pool(), a, b,
+                                             num_threads);
+}
+
+// Function to compute the column products of two matrices of the same shape
+// on a persistent thread pool without copying the columns: every chunk of
+// rows is read contiguously into per-chunk column sums (see
+// column_chunk_inner_products), which are combined in chunk order.
+// Parameters:
+//   pool: thread pool that executes the chunks
+//   a, b: row-major matrix views of the same shape
+//   num_threads: number of chunks to split the rows into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: result[j] = column j of a . column j of b
+template <typename T>
+std::vector<T> parallel_column_inner_products_threads(
+    ThreadPool& pool, const MatrixView<T>& a, const MatrixView<T>& b,
+    unsigned int num_threads = kAutoThreads) {
+  check_same_shape(a, b);
+  std::vector<T> results(a.cols, T(0));
+  if (a.rows == 0 || a.cols == 0) return results;
+
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool),
+                              a.rows * a.cols, pool_workers(pool));
+  }
+  if (num_threads > a.rows) num_threads = static_cast<unsigned int>(a.rows);
+  if (num_threads <= 1) {
+    column_chunk_inner_products(a, b, 0, a.rows, results.data());
+    return results;
+  }
+
+  size_t chunk_size = (a.rows + num_threads - 1) / num_threads;
+  num_threads = static_cast<unsigned int>((a.rows + chunk_size - 1) / chunk_size);
+  PaddedRows<T> partial_results(num_threads, a.cols, T(0));
+  pool.parallel_for(num_threads, [&](size_t c) {
+    column_chunk_inner_products(a, b, c * chunk_size,
+                                std::min(a.rows, (c + 1) * chunk_size),
+                                partial_results.row(c));
+  });
+
+  // Combine results from all chunks in order
+  for (unsigned int c = 0; c < num_threads; ++c) {
+    for (size_t j = 0; j < a.cols; ++j) {
+      results[j] += partial_results.row(c)[j];
+    }
+  }
+  return results;
+}
+
+// Function to compute the column products of two matrices using the
+// process-wide thread pool. Parameters:
+//   a, b: row-major matrix views of the same shape
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: result[j] = column j of a . column j of b
+template <typename T>
+std::vector<T> parallel_column_inner_products_threads(
+    const MatrixView<T>& a, const MatrixView<T>& b,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_column_inner_products_threads(default_thread_pool(), a, b,
+                                                num_threads);
+}
+
+// Function to compute the Gram matrix of all row pairs of a matrix on a
+// persistent thread pool. The upper triangle is split into tiles of
+// kGramTileRows x kGramTileRows entries that are computed in cache-sized depth
+// blocks (see gram_tile); chunks take contiguous runs of tiles. Parameters:
+//   pool: thread pool that executes the chunks
+//   a: row-major matrix view
+//   num_threads: number of chunks to split the tiles into (kAutoThreads, the
+//   default, lets the auto-tuner choose)
+// Returns: the symmetric a.rows x a.rows matrix g, row-major, with
+// g[i * a.rows + j] = a.row(i) . a.row(j)
+template <typename T>
+std::vector<T> parallel_gram_matrix_threads(
+    ThreadPool& pool, const MatrixView<T>& a,
+    unsigned int num_threads = kAutoThreads) {
+  std::vector<T> gram(a.rows * a.rows, T(0));
+  if (a.rows == 0) return gram;
+  std::vector<std::pair<size_t, size_t>> tiles = gram_tile_pairs(a.rows);
+
+  // The upper triangle costs rows * (rows + 1) / 2 * cols multiply-adds
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool),
+                              a.rows * (a.rows + 1) / 2 * a.cols,
+                              pool_workers(pool));
+  }
+  if (num_threads > tiles.size()) {
+    num_threads = static_cast<unsigned int>(tiles.size());
+  }
+  if (num_threads <= 1) {
+    for (const auto& tile : tiles) gram_tile(a, tile.first, tile.second, gram.data());
+    return gram;
+  }
+
+  // Every tile writes its own entries, so the chunks need no combining
+  pool.parallel_for(num_threads, [&](size_t c) {
+    size_t first = c * tiles.size() / num_threads;
+    size_t last = (c + 1) * tiles.size() / num_threads;
+    for (size_t t = first; t < last; ++t) {
+      gram_tile(a, tiles[t].first, tiles[t].second, gram.data());
+    }
+  });
+  return gram;
+}
+
+// Function to compute the Gram matrix of all row pairs of a matrix using the
+// process-wide thread pool. Parameters:
+//   a: row-major matrix view
+//   num_threads: number of threads to use (kAutoThreads, the default, lets the
+//   auto-tuner choose)
+// Returns: g[i * a.rows + j] = a.row(i) . a.row(j)
+template <typename T>
+std::vector<T> parallel_gram_matrix_threads(
+    const MatrixView<T>& a, unsigned int num_threads = kAutoThreads) {
+  return parallel_gram_matrix_threads(default_thread_pool(), a, num_threads);
 }
 
 #endif  // INNER_PRODUCT_THREADS_HPP
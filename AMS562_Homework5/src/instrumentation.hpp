@@ -0,0 +1,426 @@
+// src/instrumentation.hpp
+
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+/**
+ * @brief This header file implements the optional instrumentation layer of
+ * the parallel primitives.
+ *
+ * Build with AMS562_INSTRUMENTATION=1 (CMake option INSTRUMENTATION) to make
+ * the primitives record one trace event per call (category "region") and per
+ * chunk (category "chunk"): start time, duration, thread, chunk index and
+ * number of elements. On Linux, every event also carries the hardware
+ * counters of its thread over its duration (cycles, instructions and
+ * last-level cache misses, from perf_event_open), and an estimate of the
+ * bytes moved from memory (cache misses times the cache-line size).
+ *
+ * The events can be written as a Chrome trace (chrome://tracing or
+ * https://ui.perfetto.dev) with Tracer::write_chrome_trace(), or to the file
+ * named by AMS562_TRACE_FILE at exit. Tracer::summary() reports per-region
+ * load imbalance: the busiest thread's time over the mean thread time.
+ *
+ * Without AMS562_INSTRUMENTATION the AMS562_TRACE_* macros expand to nothing
+ * and none of the classes below are declared, so the layer costs nothing.
+ */
+
+#ifndef AMS562_INSTRUMENTATION
+#define AMS562_INSTRUMENTATION 0
+#endif
+
+#if AMS562_INSTRUMENTATION
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Hardware counter values of one thread
+ */
+struct PerfSample {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t llc_misses = 0;
+};
+
+/**
+ * @brief Hardware counters of the calling thread (Linux perf_event)
+ *
+ * Each counter is opened separately for the calling thread, user space only.
+ * A counter the kernel refuses (no PMU in a VM, perf_event_paranoid, seccomp)
+ * stays unavailable and reads as zero.
+ */
+class PerfCounters {
+ public:
+  static constexpr int kCycles = 0;
+  static constexpr int kInstructions = 1;
+  static constexpr int kLlcMisses = 2;
+
+  PerfCounters() {
+#ifdef __linux__
+    fds_[kCycles] = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+    fds_[kInstructions] = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[kLlcMisses] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /**
+   * @brief Returns whether counter (kCycles, kInstructions or kLlcMisses) is
+   * available
+   */
+  bool available(int counter) const { return fds_[counter] >= 0; }
+
+  /**
+   * @brief Returns whether any counter is available
+   */
+  bool any_available() const {
+    return available(kCycles) || available(kInstructions) ||
+           available(kLlcMisses);
+  }
+
+  /**
+   * @brief Reads the current counter values
+   */
+  PerfSample read() const {
+    return {read_counter(kCycles), read_counter(kInstructions),
+            read_counter(kLlcMisses)};
+  }
+
+  /**
+   * @brief Returns the counters of the calling thread, opened on first use
+   */
+  static const PerfCounters& this_thread() {
+    static thread_local PerfCounters counters;
+    return counters;
+  }
+
+ private:
+#ifdef __linux__
+  static int open_counter(uint64_t config) {
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return static_cast<int>(fd);
+  }
+#endif
+
+  uint64_t read_counter(int counter) const {
+    uint64_t value = 0;
+#ifdef __linux__
+    if (fds_[counter] >= 0 &&
+        ::read(fds_[counter], &value, sizeof(value)) != sizeof(value)) {
+      value = 0;
+    }
+#endif
+    return value;
+  }
+
+  int fds_[3] = {-1, -1, -1};
+};
+
+/**
+ * @brief One complete trace event (a region or a chunk)
+ */
+struct TraceEvent {
+  const char* name = "";      ///< string literal naming the primitive
+  const char* category = "";  ///< "region" or "chunk"
+  uint32_t thread = 0;        ///< small sequential id of the thread
+  double start_us = 0;        ///< start, in microseconds since tracer start
+  double duration_us = 0;
+  int64_t chunk = -1;         ///< chunk index, -1 for regions
+  uint64_t elements = 0;      ///< elements processed, 0 if unknown
+  bool has_counters = false;
+  PerfSample counters;        ///< counter deltas over the event
+};
+
+/**
+ * @brief Aggregated statistics of the events with one name
+ */
+struct TraceSummary {
+  std::string name;
+  size_t events = 0;
+  size_t threads = 0;          ///< threads that ran at least one event
+  double total_us = 0;         ///< sum of the event durations
+  double max_thread_us = 0;    ///< busiest thread
+  double mean_thread_us = 0;
+  double imbalance = 0;        ///< max_thread_us / mean_thread_us - 1
+  uint64_t elements = 0;
+  PerfSample counters;
+  double bytes_moved = 0;      ///< llc_misses times the cache-line size
+};
+
+/**
+ * @brief Process-wide collector of trace events
+ *
+ * Every thread appends to its own buffer, so recording only takes an
+ * uncontended lock.
+ */
+class Tracer {
+ public:
+  static constexpr double kCacheLineBytes = 64;
+
+  /**
+   * @brief Returns the process-wide tracer
+   */
+  static Tracer& instance() {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  ~Tracer() {
+    if (const char* path = std::getenv("AMS562_TRACE_FILE")) {
+      write_chrome_trace(std::string(path));
+    }
+  }
+
+  /**
+   * @brief Microseconds since the tracer was created
+   */
+  double now_us() const {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  /**
+   * @brief Appends an event to the calling thread's buffer (the thread field
+   * is filled in)
+   */
+  void record(TraceEvent event) {
+    ThreadBuffer& buffer = this_thread_buffer();
+    event.thread = buffer.thread;
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back(event);
+  }
+
+  /**
+   * @brief Returns every recorded event, ordered by start time
+   */
+  std::vector<TraceEvent> events() const {
+    std::vector<TraceEvent> all;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& buffer : buffers_) {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      all.insert(all.end(), buffer->events.begin(), buffer->events.end());
+    }
+    std::sort(all.begin(), all.end(),
+              [](const TraceEvent& a, const TraceEvent& b) {
+                return a.start_us < b.start_us;
+              });
+    return all;
+  }
+
+  /**
+   * @brief Drops every recorded event
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& buffer : buffers_) {
+      std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+      buffer->events.clear();
+    }
+  }
+
+  /**
+   * @brief Aggregates the events per name; chunk events give the per-thread
+   * load imbalance of a primitive
+   */
+  std::vector<TraceSummary> summary() const {
+    std::map<std::string, TraceSummary> by_name;
+    std::map<std::string, std::map<uint32_t, double>> thread_time;
+    for (const TraceEvent& event : events()) {
+      TraceSummary& s = by_name[event.name];
+      s.name = event.name;
+      ++s.events;
+      s.total_us += event.duration_us;
+      s.elements += event.elements;
+      s.counters.cycles += event.counters.cycles;
+      s.counters.instructions += event.counters.instructions;
+      s.counters.llc_misses += event.counters.llc_misses;
+      thread_time[event.name][event.thread] += event.duration_us;
+    }
+    std::vector<TraceSummary> result;
+    for (auto& entry : by_name) {
+      TraceSummary& s = entry.second;
+      const auto& times = thread_time[entry.first];
+      s.threads = times.size();
+      for (const auto& t : times) {
+        s.max_thread_us = std::max(s.max_thread_us, t.second);
+      }
+      s.mean_thread_us = s.total_us / s.threads;
+      s.imbalance =
+          s.mean_thread_us > 0 ? s.max_thread_us / s.mean_thread_us - 1 : 0;
+      s.bytes_moved = s.counters.llc_misses * kCacheLineBytes;
+      result.push_back(s);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Writes the events in the Chrome trace event format
+   */
+  void write_chrome_trace(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const TraceEvent& e : events()) {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+          << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us
+          << ",\"args\":{";
+      out << "\"elements\":" << e.elements;
+      if (e.chunk >= 0) out << ",\"chunk\":" << e.chunk;
+      if (e.has_counters) {
+        out << ",\"cycles\":" << e.counters.cycles
+            << ",\"instructions\":" << e.counters.instructions
+            << ",\"llc_misses\":" << e.counters.llc_misses
+            << ",\"bytes_moved\":"
+            << e.counters.llc_misses * static_cast<uint64_t>(kCacheLineBytes);
+      }
+      out << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+  /**
+   * @brief Writes the events to a Chrome trace file
+   * @return false if the file cannot be written
+   */
+  bool write_chrome_trace(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    write_chrome_trace(out);
+    return static_cast<bool>(out);
+  }
+
+ private:
+  struct ThreadBuffer {
+    uint32_t thread = 0;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+  };
+
+  Tracer() : start_(std::chrono::steady_clock::now()) {}
+
+  // Buffers are owned by the tracer, so events of finished threads are kept
+  ThreadBuffer& this_thread_buffer() {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+      auto created = std::make_unique<ThreadBuffer>();
+      std::lock_guard<std::mutex> lock(mutex_);
+      created->thread = static_cast<uint32_t>(buffers_.size());
+      buffer = created.get();
+      buffers_.push_back(std::move(created));
+    }
+    return *buffer;
+  }
+
+  std::chrono::steady_clock::time_point start_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+/**
+ * @brief Records a trace event covering its own lifetime
+ */
+class TraceScope {
+ public:
+  /**
+   * @param name String literal naming the primitive
+   * @param category "region" or "chunk"
+   * @param chunk Chunk index, -1 for regions
+   * @param elements Number of elements processed
+   */
+  TraceScope(const char* name, const char* category, int64_t chunk = -1,
+             uint64_t elements = 0)
+      : counters_(PerfCounters::this_thread()) {
+    event_.name = name;
+    event_.category = category;
+    event_.chunk = chunk;
+    event_.elements = elements;
+    event_.has_counters = counters_.any_available();
+    if (event_.has_counters) start_counters_ = counters_.read();
+    event_.start_us = Tracer::instance().now_us();
+  }
+
+  ~TraceScope() {
+    Tracer& tracer = Tracer::instance();
+    event_.duration_us = tracer.now_us() - event_.start_us;
+    if (event_.has_counters) {
+      PerfSample end = counters_.read();
+      event_.counters.cycles = end.cycles - start_counters_.cycles;
+      event_.counters.instructions =
+          end.instructions - start_counters_.instructions;
+      event_.counters.llc_misses = end.llc_misses - start_counters_.llc_misses;
+    }
+    tracer.record(event_);
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const PerfCounters& counters_;
+  PerfSample start_counters_;
+  TraceEvent event_;
+};
+
+#define AMS562_TRACE_CONCAT_(a, b) a##b
+#define AMS562_TRACE_CONCAT(a, b) AMS562_TRACE_CONCAT_(a, b)
+
+/// Records the enclosing scope as a region of the named primitive
+#define AMS562_TRACE_REGION(name, elements)                              \
+  TraceScope AMS562_TRACE_CONCAT(ams562_trace_scope_, __LINE__)(        \
+      name, "region", -1, static_cast<uint64_t>(elements))
+
+/// Records the enclosing scope as one chunk of the named primitive
+#define AMS562_TRACE_CHUNK(name, chunk, elements)                        \
+  TraceScope AMS562_TRACE_CONCAT(ams562_trace_scope_, __LINE__)(        \
+      name, "chunk", static_cast<int64_t>(chunk),                        \
+      static_cast<uint64_t>(elements))
+
+#else  // !AMS562_INSTRUMENTATION
+
+#define AMS562_TRACE_REGION(name, elements) ((void)0)
+#define AMS562_TRACE_CHUNK(name, chunk, elements) ((void)0)
+
+#endif  // AMS562_INSTRUMENTATION
+
+#endif  // INSTRUMENTATION_HPP
@@ -0,0 +1,509 @@
+// src/numa.hpp
+
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "range_traits.hpp"
+#include "scan_common.hpp"
+#include "thread_pool.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief This header file implements NUMA-aware execution for the
+ * threads-based primitives.
+ *
+ * A NumaExecutor owns one ThreadPool per NUMA node, with the workers of each
+ * pool pinned to the CPUs of their node. An array of n elements is split into
+ * one page-aligned range per node (numa_node_range). The first-touch helpers
+ * (numa_allocate, numa_copy) write every range from its own node, so the
+ * kernel places its pages on that node, and the NUMA primitives
+ * (numa_inner_product, numa_inclusive_scan) hand every range to the same node
+ * again, so threads only read local memory.
+ *
+ * The topology is read from /sys/devices/system/node. On machines with a
+ * single node, or where sysfs is unavailable, the executor has one unpinned
+ * pool and the primitives behave like their plain threads counterparts.
+ *
+ * For the OpenMP backend, numa_fill_openmp and numa_inner_product_openmp use
+ * the same schedule(static) partition for the first touch and the
+ * computation; run with OMP_PROC_BIND=spread OMP_PLACES=cores so threads stay
+ * on their node.
+ */
+
+/**
+ * @brief CPUs of every NUMA node of the machine
+ */
+struct NumaTopology {
+  std::vector<std::vector<int>> node_cpus;  ///< CPU ids, one list per node
+
+  /**
+   * @brief Returns the number of NUMA nodes (at least one)
+   */
+  size_t num_nodes() const { return node_cpus.size(); }
+};
+
+/**
+ * @brief Parses a sysfs CPU list such as "0-3,8,10-11"
+ * @return The CPU ids, or an empty vector if the list is malformed
+ */
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(),
+                               [](char c) { return c == ' ' || c == '\n'; }),
+                range.end());
+    if (range.empty()) continue;
+    size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first
+                                           : std::stoi(range.substr(dash + 1));
+      if (first < 0 || last < first) return {};
+      for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    } catch (const std::exception&) {
+      return {};
+    }
+  }
+  return cpus;
+}
+
+/**
+ * @brief Reads the NUMA topology from sysfs
+ * @param sysfs_root Directory holding the node<k> entries
+ *
+ * Falls back to a single node with every CPU when the directory is missing
+ * or lists fewer than one populated node.
+ */
+inline NumaTopology read_numa_topology(
+    const std::string& sysfs_root = "/sys/devices/system/node") {
+  NumaTopology topology;
+  std::vector<int> nodes;
+  {
+    std::ifstream online(sysfs_root + "/online");
+    std::string list;
+    if (online && std::getline(online, list)) nodes = parse_cpu_list(list);
+  }
+  for (int node : nodes) {
+    std::ifstream cpulist(sysfs_root + "/node" + std::to_string(node) +
+                          "/cpulist");
+    std::string list;
+    if (!cpulist || !std::getline(cpulist, list)) continue;
+    std::vector<int> cpus = parse_cpu_list(list);
+    if (!cpus.empty()) topology.node_cpus.push_back(std::move(cpus));
+  }
+  if (topology.node_cpus.empty()) {
+    std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+    std::iota(cpus.begin(), cpus.end(), 0);
+    topology.node_cpus.push_back(std::move(cpus));
+  }
+  return topology;
+}
+
+/**
+ * @brief Returns the topology of this machine, read once
+ */
+inline const NumaTopology& numa_topology() {
+  static const NumaTopology topology = read_numa_topology();
+  return topology;
+}
+
+/**
+ * @brief Pins the calling thread to a set of CPUs
+ * @return false if pinning is unsupported or was refused
+ */
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+/**
+ * @brief Returns the size of a memory page in bytes
+ */
+inline size_t numa_page_size() {
+#ifdef __linux__
+  static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page;
+#else
+  return 4096;
+#endif
+}
+
+/**
+ * @brief Half-open range of element indices
+ */
+struct NumaRange {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+/**
+ * @brief Returns the range of an n-element array that node owns
+ * @param n Number of elements
+ * @param element_size Size of one element in bytes
+ * @param num_nodes Number of nodes the array is split over
+ * @param node Index of the node
+ *
+ * Range boundaries fall on page boundaries of a page-aligned array, so no
+ * page is shared by two nodes.
+ */
+inline NumaRange numa_node_range(size_t n, size_t element_size,
+                                 size_t num_nodes, size_t node) {
+  size_t per_page = std::max<size_t>(1, numa_page_size() / element_size);
+  size_t pages = (n + per_page - 1) / per_page;
+  auto boundary = [&](size_t k) {
+    return std::min(n, (pages * k / num_nodes) * per_page);
+  };
+  return {boundary(node), node + 1 == num_nodes ? n : boundary(node + 1)};
+}
+
+/**
+ * @brief One pinned thread pool per NUMA node
+ */
+class NumaExecutor {
+ public:
+  /**
+   * @brief Creates one pool per node with one worker per CPU of the node;
+   * workers are pinned only when there is more than one node
+   *
+   * With a single node the calling thread takes part in the work (see
+   * for_each_node), so the pool has one worker less.
+   */
+  explicit NumaExecutor(const NumaTopology& topology = numa_topology()) {
+    bool pin = topology.num_nodes() > 1;
+    for (const std::vector<int>& cpus : topology.node_cpus) {
+      std::function<void(unsigned int)> init;
+      unsigned int workers = static_cast<unsigned int>(cpus.size());
+      if (pin) {
+        init = [cpus](unsigned int) { pin_current_thread(cpus); };
+      } else {
+        workers = std::max(1u, workers - 1);
+      }
+      pools_.push_back(std::make_unique<ThreadPool>(workers, init));
+    }
+  }
+
+  /**
+   * @brief Returns the number of nodes
+   */
+  size_t num_nodes() const { return pools_.size(); }
+
+  /**
+   * @brief Returns the pool whose workers run on node
+   */
+  ThreadPool& node_pool(size_t node) { return *pools_[node]; }
+
+  /**
+   * @brief Returns the range of an n-element array of T that node owns
+   */
+  template <typename T>
+  NumaRange node_range(size_t node, size_t n) const {
+    return numa_node_range(n, sizeof(T), pools_.size(), node);
+  }
+
+  /**
+   * @brief Runs f(node, pool) for every node on a worker of that node and
+   * waits for all of them; the first exception is rethrown
+   *
+   * With a single node, f runs on the calling thread.
+   */
+  template <typename F>
+  void for_each_node(F&& f) {
+    if (pools_.size() == 1) {
+      f(size_t(0), *pools_[0]);
+      return;
+    }
+    std::vector<std::future<void>> done;
+    done.reserve(pools_.size());
+    for (size_t node = 0; node < pools_.size(); ++node) {
+      ThreadPool& pool = *pools_[node];
+      done.push_back(pool.submit([&f, node, &pool]() { f(node, pool); }));
+    }
+    for (auto& d : done) d.wait();
+    for (auto& d : done) d.get();
+  }
+
+  /**
+   * @brief Returns the chunk size used to split a range of length elements
+   * over the workers of pool (at least 4096 elements per chunk)
+   */
+  static size_t chunk_size(const ThreadPool& pool, size_t length) {
+    constexpr size_t kMinChunk = 4096;
+    size_t chunks = std::clamp<size_t>(length / kMinChunk, 1, pool.size());
+    return std::max<size_t>(1, (length + chunks - 1) / chunks);
+  }
+
+  /**
+   * @brief Returns the number of chunks of a range of length elements
+   */
+  static size_t chunk_count(const ThreadPool& pool, size_t length) {
+    size_t size = chunk_size(pool, length);
+    return (length + size - 1) / size;
+  }
+
+  /**
+   * @brief Runs f(chunk, begin, end) over the chunks of range on the workers
+   * of pool
+   */
+  template <typename F>
+  static void for_each_chunk(ThreadPool& pool, NumaRange range, F&& f) {
+    size_t length = range.end - range.begin;
+    size_t size = chunk_size(pool, length);
+    pool.parallel_for(chunk_count(pool, length), [&](size_t c) {
+      size_t begin = range.begin + c * size;
+      f(c, begin, std::min(range.end, begin + size));
+    });
+  }
+
+ private:
+  std::vector<std::unique_ptr<ThreadPool>> pools_;
+};
+
+/**
+ * @brief Returns the process-wide NUMA executor, created on first use
+ */
+inline NumaExecutor& default_numa_executor() {
+  static NumaExecutor executor;
+  return executor;
+}
+
+/**
+ * @brief Page-aligned array whose pages were first touched by the node that
+ * processes them; created by numa_allocate and numa_copy
+ */
+template <typename T>
+class NumaBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "NumaBuffer holds trivially copyable elements");
+
+ public:
+  NumaBuffer() = default;
+
+  /**
+   * @brief Allocates n uninitialized, untouched elements
+   */
+  explicit NumaBuffer(size_t n) : size_(n) {
+    if (n == 0) return;
+    size_t page = numa_page_size();
+    size_t bytes = (n * sizeof(T) + page - 1) / page * page;
+    data_.reset(static_cast<T*>(std::aligned_alloc(page, bytes)));
+    if (!data_) throw std::bad_alloc();
+  }
+
+  T* data() { return data_.get(); }
+  const T* data() const { return data_.get(); }
+  size_t size() const { return size_; }
+  T* begin() { return data(); }
+  T* end() { return data() + size_; }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + size_; }
+  T& operator[](size_t i) { return data_.get()[i]; }
+  const T& operator[](size_t i) const { return data_.get()[i]; }
+
+ private:
+  struct Free {
+    void operator()(T* p) const { std::free(p); }
+  };
+  std::unique_ptr<T, Free> data_;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief Allocates n elements set to value, each node writing its own range
+ */
+template <typename T>
+NumaBuffer<T> numa_allocate(size_t n, const T& value,
+                            NumaExecutor& executor = default_numa_executor()) {
+  NumaBuffer<T> buffer(n);
+  T* data = buffer.data();
+  executor.for_each_node([&](size_t node, ThreadPool& pool) {
+    NumaExecutor::for_each_chunk(
+        pool, executor.node_range<T>(node, n),
+        [&](size_t, size_t begin, size_t end) {
+          std::fill(data + begin, data + end, value);
+        });
+  });
+  return buffer;
+}
+
+/**
+ * @brief Copies a random-access range into a buffer, each node writing its
+ * own range
+ */
+template <typename It>
+NumaBuffer<iter_value_t<It>> numa_copy(
+    It first, It last, NumaExecutor& executor = default_numa_executor()) {
+  using T = iter_value_t<It>;
+  size_t n = static_cast<size_t>(last - first);
+  NumaBuffer<T> buffer(n);
+  T* data = buffer.data();
+  executor.for_each_node([&](size_t node, ThreadPool& pool) {
+    NumaExecutor::for_each_chunk(
+        pool, executor.node_range<T>(node, n),
+        [&](size_t, size_t begin, size_t end) {
+          std::copy(first + begin, first + end, data + begin);
+        });
+  });
+  return buffer;
+}
+
+/**
+ * @brief Computes the inner product of a[0, n) and b[0, n) with every node
+ * reading the range it first touched
+ *
+ * Chunk results are combined in a fixed order, so the result only depends on
+ * the topology, not on scheduling.
+ */
+template <typename T>
+T numa_inner_product(const T* a, const T* b, size_t n,
+                     NumaExecutor& executor = default_numa_executor()) {
+  std::vector<std::vector<T>> partial(executor.num_nodes());
+  executor.for_each_node([&](size_t node, ThreadPool& pool) {
+    NumaRange range = executor.node_range<T>(node, n);
+    partial[node].assign(
+        NumaExecutor::chunk_count(pool, range.end - range.begin), T(0));
+    NumaExecutor::for_each_chunk(
+        pool, range, [&](size_t c, size_t begin, size_t end) {
+          partial[node][c] =
+              std::inner_product(a + begin, a + end, b + begin, T(0));
+        });
+  });
+  T result = T(0);
+  for (const auto& node_partial : partial) {
+    for (const T& p : node_partial) result += p;
+  }
+  return result;
+}
+
+/**
+ * @brief Inner product of two NUMA buffers of the same size
+ */
+template <typename T>
+T numa_inner_product(const NumaBuffer<T>& a, const NumaBuffer<T>& b,
+                     NumaExecutor& executor = default_numa_executor()) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return numa_inner_product(a.data(), b.data(), a.size(), executor);
+}
+
+/**
+ * @brief Inclusive prefix sum of input[0, n) into output (which may equal
+ * input), with every node scanning the range it first touched
+ *
+ * Reduce-then-scan: every node reduces the chunks of its range, the chunk
+ * sums are scanned serially, and every node then scans its chunks once,
+ * seeded with the preceding sum.
+ */
+template <typename T>
+void numa_inclusive_scan(const T* input, T* output, size_t n,
+                         NumaExecutor& executor = default_numa_executor()) {
+  if (n == 0) return;
+
+  // Chunk sums of every node, in array order
+  std::vector<std::vector<T>> sums(executor.num_nodes());
+
+  // Phase 1: read-only reduction of every chunk
+  executor.for_each_node([&](size_t node, ThreadPool& pool) {
+    NumaRange range = executor.node_range<T>(node, n);
+    sums[node].assign(
+        NumaExecutor::chunk_count(pool, range.end - range.begin), T(0));
+    NumaExecutor::for_each_chunk(
+        pool, range, [&](size_t c, size_t begin, size_t end) {
+          sums[node][c] = chunk_reduce(input, begin, end);
+        });
+  });
+
+  // Replace every chunk sum by the sum of all preceding chunks
+  T running = T(0);
+  for (auto& node_sums : sums) {
+    for (T& sum : node_sums) {
+      T chunk = sum;
+      sum = running;
+      running += chunk;
+    }
+  }
+
+  // Phase 2: scan every chunk once, seeded with the preceding chunk sums
+  executor.for_each_node([&](size_t node, ThreadPool& pool) {
+    NumaExecutor::for_each_chunk(
+        pool, executor.node_range<T>(node, n),
+        [&](size_t c, size_t begin, size_t end) {
+          seeded_inclusive_scan(input, output, begin, end, sums[node][c]);
+        });
+  });
+}
+
+/**
+ * @brief In-place inclusive prefix sum of a NUMA buffer
+ */
+template <typename T>
+void numa_inclusive_scan(NumaBuffer<T>& data,
+                         NumaExecutor& executor = default_numa_executor()) {
+  numa_inclusive_scan(data.data(), data.data(), data.size(), executor);
+}
+
+#ifdef _OPENMP
+/**
+ * @brief Sets data[0, n) to value with the schedule(static) partition that
+ * numa_inner_product_openmp uses, so every thread first touches the pages it
+ * later reads
+ */
+template <typename T>
+void numa_fill_openmp(T* data, size_t n, const T& value) {
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = value;
+  }
+}
+
+/**
+ * @brief Inner product with the schedule(static) partition of
+ * numa_fill_openmp
+ */
+template <typename T>
+T numa_inner_product_openmp(const T* a, const T* b, size_t n) {
+  T result = T(0);
+#pragma omp parallel for schedule(static) reduction(+ : result)
+  for (size_t i = 0; i < n; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+#endif  // _OPENMP
+
+#endif  // NUMA_HPP
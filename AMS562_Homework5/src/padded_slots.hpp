@@ -0,0 +1,125 @@
+// src/padded_slots.hpp
+
+#ifndef PADDED_SLOTS_HPP
+#define PADDED_SLOTS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief This header file contains the per-worker slots that the parallel
+ * primitives use to pass chunk aggregates (chunk sums of a scan, partial sums
+ * of an inner product) from the workers to the combining thread.
+ *
+ * In a plain std::vector<T> the slots of neighbouring chunks share a cache
+ * line, so every write by one worker invalidates the line in the caches of
+ * the others (false sharing). Here every slot, or every row of slots, starts
+ * on its own cache line.
+ */
+
+/**
+ * @brief Size in bytes of the cache line the slots are padded to
+ *
+ * std::hardware_destructive_interference_size is not used because its value
+ * may differ between translation units built for different targets (GCC warns
+ * about it in headers); 64 bytes is the line size of current x86-64 and most
+ * AArch64 cores.
+ */
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief A value alone on its cache line(s)
+ */
+template <typename T>
+struct alignas(kCacheLineSize) CacheLinePadded {
+  T value;
+};
+
+/**
+ * @brief Fixed number of values, one per worker, each on its own cache line
+ */
+template <typename T>
+class PaddedSlots {
+ public:
+  /**
+   * @brief Creates count slots holding init
+   */
+  explicit PaddedSlots(size_t count, const T& init = T())
+      : slots_(count, CacheLinePadded<T>{init}) {}
+
+  T& operator[](size_t i) { return slots_[i].value; }
+  const T& operator[](size_t i) const { return slots_[i].value; }
+
+  /**
+   * @brief Returns the number of slots
+   */
+  size_t size() const { return slots_.size(); }
+
+ private:
+  std::vector<CacheLinePadded<T>> slots_;
+};
+
+/**
+ * @brief Fixed number of rows of cols values, one row per worker; every row
+ * starts on a cache line of its own, so workers that accumulate into their
+ * rows never write to a line another row lives on
+ */
+template <typename T>
+class PaddedRows {
+  static_assert(std::is_trivially_copyable_v<T> &&
+                    std::is_trivially_destructible_v<T>,
+                "PaddedRows holds trivially copyable values");
+
+ public:
+  /**
+   * @brief Creates rows x cols values holding init
+   */
+  PaddedRows(size_t rows, size_t cols, const T& init = T())
+      : rows_(rows), cols_(cols), stride_(padded_stride(cols)),
+        data_(allocate(rows * stride_)) {
+    std::uninitialized_fill_n(data_.get(), rows * stride_, init);
+  }
+
+  T* row(size_t i) { return data_.get() + i * stride_; }
+  const T* row(size_t i) const { return data_.get() + i * stride_; }
+
+  /**
+   * @brief Returns the number of rows
+   */
+  size_t rows() const { return rows_; }
+
+  /**
+   * @brief Returns the number of values per row
+   */
+  size_t cols() const { return cols_; }
+
+ private:
+  struct AlignedDelete {
+    void operator()(T* p) const {
+      ::operator delete(p, std::align_val_t(kCacheLineSize));
+    }
+  };
+
+  // Row length rounded up to a whole number of cache lines (and of values)
+  static size_t padded_stride(size_t cols) {
+    const size_t unit = std::lcm(sizeof(T), kCacheLineSize) / sizeof(T);
+    return (std::max<size_t>(1, cols) + unit - 1) / unit * unit;
+  }
+
+  static T* allocate(size_t count) {
+    return static_cast<T*>(::operator new(std::max<size_t>(1, count) * sizeof(T),
+                                          std::align_val_t(kCacheLineSize)));
+  }
+
+  size_t rows_;
+  size_t cols_;
+  size_t stride_;
+  std::unique_ptr<T, AlignedDelete> data_;
+};
+
+#endif  // PADDED_SLOTS_HPP
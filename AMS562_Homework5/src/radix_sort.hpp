@@ -0,0 +1,434 @@
+// src/radix_sort.hpp
+
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "auto_tune.hpp"
+#include "instrumentation.hpp"
+#include "range_traits.hpp"
+#include "scan_algorithms.hpp"
+#include "scan_common.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__SSE2__)
+#define AMS562_RADIX_STREAM_STORES 1
+#include <emmintrin.h>
+#else
+#define AMS562_RADIX_STREAM_STORES 0
+#endif
+
+/**
+ * @brief This header file contains a parallel LSD radix sort for integer and
+ * floating-point keys, alone or with values attached.
+ *
+ * Every key is mapped to an unsigned integer with the same order
+ * (radix_key), which is then sorted one 8-bit digit at a time, least
+ * significant first. Each pass is a stable counting sort built on the
+ * primitives of scan_algorithms.hpp:
+ *   1. every chunk counts its digits (parallel_chunked_histogram_threads);
+ *   2. the chunked exclusive scan of the bin-major counts gives every chunk
+ *      and digit its output position (histogram_scatter_offsets);
+ *   3. every chunk scatters its elements. Writes go through a line-sized
+ *      buffer per digit and are flushed a whole aligned cache line at a time
+ *      with streaming stores, instead of one scattered store per key.
+ * Passes in which all keys share a digit are skipped, so e.g. small integers
+ * in 64-bit keys only pay for the digits they use.
+ *
+ * Floating-point keys are ordered like their radix_key: -NaN < -inf < ... <
+ * -0.0 < +0.0 < ... < +inf < +NaN.
+ */
+
+/**
+ * @brief Key types the radix sort accepts: integers and float/double
+ */
+template <typename T>
+constexpr bool is_radix_key_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+/**
+ * @brief Unsigned integer of the same size as a radix key type
+ */
+template <typename T>
+using radix_bits_t = std::conditional_t<
+    sizeof(T) == 1, uint8_t,
+    std::conditional_t<sizeof(T) == 2, uint16_t,
+                       std::conditional_t<sizeof(T) == 4, uint32_t,
+                                          uint64_t>>>;
+
+/**
+ * @brief Maps a key to an unsigned integer whose order is the key order
+ *
+ * Signed integers flip the sign bit. Floats flip the sign bit of positive
+ * values and every bit of negative values, so that larger magnitudes of
+ * negative values come first.
+ */
+template <typename T>
+radix_bits_t<T> radix_key(T value) {
+  static_assert(is_radix_key_v<T>, "radix sort needs integer or float keys");
+  using U = radix_bits_t<T>;
+  constexpr U sign = U(1) << (std::numeric_limits<U>::digits - 1);
+  U bits;
+  std::memcpy(&bits, &value, sizeof(T));
+  if constexpr (std::is_floating_point_v<T>) {
+    return (bits & sign) ? U(~bits) : U(bits | sign);
+  } else if constexpr (std::is_signed_v<T>) {
+    return U(bits ^ sign);
+  } else {
+    return bits;
+  }
+}
+
+/**
+ * @brief Number of bits per radix digit (256 bins per pass)
+ */
+constexpr unsigned int kRadixBits = 8;
+constexpr size_t kRadixBins = size_t(1) << kRadixBits;
+
+/**
+ * @brief Inputs shorter than this are sorted with a comparison sort; a radix
+ * pass costs at least one histogram of kRadixBins per chunk
+ */
+constexpr size_t kRadixSortCutoff = 4096;
+
+/**
+ * @brief Size of the scatter buffer of each digit: one cache line
+ */
+constexpr size_t kRadixLineBytes = 64;
+
+/**
+ * @brief Number of keys buffered per digit before a scatter write; the 256
+ * buffers of a chunk (16 KiB) fit in the L1 cache
+ */
+template <typename T>
+constexpr size_t radix_buffer_size() {
+  return kRadixLineBytes / sizeof(T);
+}
+
+/**
+ * @brief Copies one cache line from src to dst with non-temporal stores when
+ * SSE2 is available; dst must be line aligned and src 16-byte aligned
+ *
+ * A whole-line streaming store does not read the destination line first, so
+ * a scatter pass moves each output byte across the memory bus once instead
+ * of twice, and does not evict the input from the cache.
+ */
+inline void radix_stream_line(void* dst, const void* src) {
+#if AMS562_RADIX_STREAM_STORES
+  const __m128i* from = static_cast<const __m128i*>(src);
+  __m128i* to = static_cast<__m128i*>(dst);
+  for (size_t j = 0; j < kRadixLineBytes / sizeof(__m128i); ++j) {
+    _mm_stream_si128(to + j, _mm_load_si128(from + j));
+  }
+#else
+  std::memcpy(dst, src, kRadixLineBytes);
+#endif
+}
+
+/**
+ * @brief Orders the streaming stores of this thread before later stores, so
+ * the scattered output is complete when the chunk's task finishes
+ */
+inline void radix_stream_fence() {
+#if AMS562_RADIX_STREAM_STORES
+  _mm_sfence();
+#endif
+}
+
+/**
+ * @brief Digit of a key in a given pass
+ */
+template <typename T>
+size_t radix_digit(const T& value, unsigned int pass) {
+  return static_cast<size_t>(radix_key(value) >> (pass * kRadixBits)) &
+         (kRadixBins - 1);
+}
+
+/**
+ * @brief Scatters the elements [start_idx, end_idx) from (keys_in,
+ * values_in) to (keys_out, values_out) through per-digit buffers
+ * @param offsets Scatter offsets of the chunk, one per digit; consumed
+ *
+ * Keys are collected in a line-sized buffer per digit. When the output is
+ * contiguous, the first flush of a digit fills its output up to the next
+ * line boundary, so every later flush is one aligned whole-line streaming
+ * store. Values are copied alongside with plain stores. Without values, V is
+ * ignored and values_in/values_out may be null.
+ */
+template <bool kHasValues, typename KeyIn, typename KeyOut, typename V>
+void radix_scatter_chunk(KeyIn keys_in, KeyOut keys_out, const V* values_in,
+                         V* values_out, size_t start_idx, size_t end_idx,
+                         unsigned int pass, size_t* offsets) {
+  using K = iter_value_t<KeyIn>;
+  constexpr size_t kBuffer = radix_buffer_size<K>();
+  constexpr bool kStream = is_contiguous_iterator_of_v<KeyOut, K>;
+  alignas(kRadixLineBytes) K key_buffer[kRadixBins * kBuffer];
+  std::vector<V> value_storage(kHasValues ? kRadixBins * kBuffer : 0);
+  V* value_buffer = value_storage.data();
+  unsigned int fill[kRadixBins] = {};
+  unsigned int limit[kRadixBins];
+
+  K* out = nullptr;
+  if constexpr (kStream) out = &*keys_out;
+  for (size_t digit = 0; digit < kRadixBins; ++digit) {
+    limit[digit] = kBuffer;
+    if constexpr (kStream) {
+      size_t misaligned =
+          reinterpret_cast<uintptr_t>(out + offsets[digit]) % kRadixLineBytes;
+      if (misaligned != 0) {
+        limit[digit] =
+            static_cast<unsigned int>((kRadixLineBytes - misaligned) /
+                                      sizeof(K));
+      }
+    }
+  }
+
+  auto flush = [&](size_t digit) {
+    const size_t base = digit * kBuffer;
+    const size_t count = fill[digit];
+    if (kStream && count == kBuffer) {
+      radix_stream_line(out + offsets[digit], key_buffer + base);
+    } else {
+      std::copy(key_buffer + base, key_buffer + base + count,
+                keys_out + offsets[digit]);
+    }
+    if constexpr (kHasValues) {
+      std::copy(value_buffer + base, value_buffer + base + count,
+                values_out + offsets[digit]);
+    }
+    offsets[digit] += count;
+    fill[digit] = 0;
+    limit[digit] = kBuffer;
+  };
+
+  for (size_t i = start_idx; i < end_idx; ++i) {
+    const K key = keys_in[i];
+    const size_t digit = radix_digit(key, pass);
+    const size_t slot = digit * kBuffer + fill[digit];
+    key_buffer[slot] = key;
+    if constexpr (kHasValues) value_buffer[slot] = values_in[i];
+    if (++fill[digit] == limit[digit]) flush(digit);
+  }
+  for (size_t digit = 0; digit < kRadixBins; ++digit) {
+    if (fill[digit] > 0) flush(digit);
+  }
+  if constexpr (kStream) radix_stream_fence();
+}
+
+/**
+ * @brief Sorts n keys (and their values) with a comparison sort on the radix
+ * order; used below kRadixSortCutoff so that short inputs give the same
+ * order as long ones
+ */
+template <bool kHasValues, typename KeyIt, typename V>
+void radix_fallback_sort(KeyIt keys, V* values, size_t n) {
+  using K = iter_value_t<KeyIt>;
+  auto less = [](const K& a, const K& b) { return radix_key(a) < radix_key(b); };
+  if constexpr (kHasValues) {
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return less(keys[a], keys[b]);
+    });
+    std::vector<K> sorted_keys(n);
+    std::vector<V> sorted_values(n);
+    for (size_t i = 0; i < n; ++i) {
+      sorted_keys[i] = keys[order[i]];
+      sorted_values[i] = values[order[i]];
+    }
+    std::copy(sorted_keys.begin(), sorted_keys.end(), keys);
+    std::copy(sorted_values.begin(), sorted_values.end(), values);
+  } else {
+    std::sort(keys, keys + n, less);
+  }
+}
+
+/**
+ * @brief Radix sort of n keys starting at keys, with values when kHasValues
+ * @param pool The thread pool that executes the chunks
+ * @param num_threads Number of chunks (kAutoThreads lets the auto-tuner
+ * choose)
+ */
+template <bool kHasValues, typename KeyIt, typename V>
+void radix_sort_impl(ThreadPool& pool, KeyIt keys, V* values, size_t n,
+                     unsigned int num_threads) {
+  using K = iter_value_t<KeyIt>;
+  AMS562_TRACE_REGION("radix_sort_threads", n);
+  if (n < kRadixSortCutoff) {
+    radix_fallback_sort<kHasValues>(keys, values, n);
+    return;
+  }
+
+  const unsigned int num_chunks =
+      plan_scan_algorithm<K>(pool, n, num_threads).num_chunks;
+  std::vector<K> key_temp(n);
+  std::vector<V> value_temp(kHasValues ? n : 0);
+  bool in_temp = false;  // whether the current order lives in the temporaries
+
+  // A single chunk's digit counts do not change between passes (they are
+  // the counts of the whole input), so all passes are counted in one read
+  std::vector<size_t> serial_counts;
+  if (num_chunks <= 1) {
+    serial_counts.assign(sizeof(K) * kRadixBins, 0);
+    for (size_t i = 0; i < n; ++i) {
+      const auto bits = radix_key(K(keys[i]));
+      for (unsigned int pass = 0; pass < sizeof(K); ++pass) {
+        ++serial_counts[pass * kRadixBins +
+                        (static_cast<size_t>(bits >> (pass * kRadixBits)) &
+                         (kRadixBins - 1))];
+      }
+    }
+  }
+
+  // One stable counting-sort pass from (keys_in, values_in) to
+  // (keys_out, values_out); returns false if the digit is constant
+  auto run_pass = [&](auto keys_in, auto keys_out, const V* values_in,
+                      V* values_out, unsigned int pass) {
+    ChunkedHistogram histogram;
+    if (serial_counts.empty()) {
+      auto digit_of = [pass](const K& key) { return radix_digit(key, pass); };
+      histogram = parallel_chunked_histogram_threads(
+          pool, keys_in, keys_in + n, kRadixBins, digit_of, num_chunks);
+    } else {
+      histogram.plan = make_chunk_plan(n, 1);
+      histogram.num_bins = kRadixBins;
+      histogram.counts.assign(
+          serial_counts.begin() + pass * kRadixBins,
+          serial_counts.begin() + (pass + 1) * kRadixBins);
+    }
+    for (size_t digit = 0; digit < kRadixBins; ++digit) {
+      size_t total = 0;
+      for (size_t c = 0; c < histogram.plan.num_chunks; ++c) {
+        total += histogram.at(digit, c);
+      }
+      if (total == n) return false;
+      if (total > 0) break;
+    }
+    histogram_scatter_offsets(pool, histogram);
+
+    auto scatter = [&](size_t c) {
+      AMS562_TRACE_CHUNK("radix_sort_threads/scatter", c,
+                         histogram.plan.end(c) - histogram.plan.begin(c));
+      size_t offsets[kRadixBins];
+      for (size_t digit = 0; digit < kRadixBins; ++digit) {
+        offsets[digit] = histogram.at(digit, c);
+      }
+      radix_scatter_chunk<kHasValues>(keys_in, keys_out, values_in,
+                                      values_out, histogram.plan.begin(c),
+                                      histogram.plan.end(c), pass, offsets);
+    };
+    if (histogram.plan.num_chunks <= 1) {
+      scatter(0);
+    } else {
+      pool.parallel_for(histogram.plan.num_chunks, scatter);
+    }
+    return true;
+  };
+
+  for (unsigned int pass = 0; pass < sizeof(K); ++pass) {
+    bool moved = in_temp
+        ? run_pass(key_temp.begin(), keys, value_temp.data(), values, pass)
+        : run_pass(keys, key_temp.begin(), values, value_temp.data(), pass);
+    if (moved) in_temp = !in_temp;
+  }
+  if (in_temp) {
+    std::copy(key_temp.begin(), key_temp.end(), keys);
+    if constexpr (kHasValues) {
+      std::copy(value_temp.begin(), value_temp.end(), values);
+    }
+  }
+}
+
+/**
+ * @brief Sorts [first, last) in ascending radix order on a persistent thread
+ * pool (parallel std::sort for integer and float keys)
+ * @param pool The thread pool that executes the chunks
+ * @param first, last The range to sort
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ */
+template <typename RandomIt, enable_if_random_access_t<RandomIt> = 0>
+void parallel_radix_sort_threads(ThreadPool& pool, RandomIt first,
+                                 RandomIt last,
+                                 unsigned int num_threads = kAutoThreads) {
+  using K = iter_value_t<RandomIt>;
+  static_assert(is_radix_key_v<K>, "radix sort needs integer or float keys");
+  radix_sort_impl<false>(pool, first, static_cast<K*>(nullptr),
+                         static_cast<size_t>(last - first), num_threads);
+}
+
+/**
+ * @brief Sorts [first, last) in ascending radix order using the process-wide
+ * thread pool
+ */
+template <typename RandomIt, enable_if_random_access_t<RandomIt> = 0>
+void parallel_radix_sort_threads(RandomIt first, RandomIt last,
+                                 unsigned int num_threads = kAutoThreads) {
+  parallel_radix_sort_threads(default_thread_pool(), first, last,
+                              num_threads);
+}
+
+/**
+ * @brief Sorts a vector in ascending radix order on a persistent thread pool
+ */
+template <typename K>
+void parallel_radix_sort_threads(ThreadPool& pool, std::vector<K>& data,
+                                 unsigned int num_threads = kAutoThreads) {
+  parallel_radix_sort_threads(pool, data.begin(), data.end(), num_threads);
+}
+
+/**
+ * @brief Sorts a vector in ascending radix order using the process-wide
+ * thread pool
+ */
+template <typename K>
+void parallel_radix_sort_threads(std::vector<K>& data,
+                                 unsigned int num_threads = kAutoThreads) {
+  parallel_radix_sort_threads(default_thread_pool(), data.begin(), data.end(),
+                              num_threads);
+}
+
+/**
+ * @brief Sorts keys in ascending radix order and applies the same
+ * permutation to values, on a persistent thread pool; stable, so values of
+ * equal keys keep their order
+ * @param pool The thread pool that executes the chunks
+ * @param keys The keys to sort
+ * @param values One value per key
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @throws std::invalid_argument if keys and values differ in size
+ */
+template <typename K, typename V>
+void parallel_radix_sort_by_key_threads(
+    ThreadPool& pool, std::vector<K>& keys, std::vector<V>& values,
+    unsigned int num_threads = kAutoThreads) {
+  static_assert(is_radix_key_v<K>, "radix sort needs integer or float keys");
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument("Keys and values must be of the same size");
+  }
+  radix_sort_impl<true>(pool, keys.begin(), values.data(), keys.size(),
+                        num_threads);
+}
+
+/**
+ * @brief Sorts keys and their values using the process-wide thread pool (see
+ * the pool overload)
+ */
+template <typename K, typename V>
+void parallel_radix_sort_by_key_threads(
+    std::vector<K>& keys, std::vector<V>& values,
+    unsigned int num_threads = kAutoThreads) {
+  parallel_radix_sort_by_key_threads(default_thread_pool(), keys, values,
+                                     num_threads);
+}
+
+#endif  // RADIX_SORT_HPP
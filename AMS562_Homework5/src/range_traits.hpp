@@ -0,0 +1,52 @@
+// src/range_traits.hpp
+
+#ifndef RANGE_TRAITS_HPP
+#define RANGE_TRAITS_HPP
+
+#include <iterator>
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>  // provides std::span (and __cpp_lib_span) in C++20 builds
+#endif
+
+/**
+ * @brief This header file contains the traits used to constrain the
+ * iterator-range overloads of the parallel primitives, so that they never
+ * compete with the std::vector overloads during overload resolution.
+ *
+ * The std::span overloads of the primitives are only declared when the
+ * standard library provides std::span (C++20), i.e. when __cpp_lib_span is
+ * defined after including this header.
+ */
+
+/**
+ * @brief True when It is a random-access iterator (raw pointers included)
+ */
+template <typename It, typename = void>
+struct is_random_access_iterator : std::false_type {};
+
+template <typename It>
+struct is_random_access_iterator<
+    It, std::void_t<typename std::iterator_traits<It>::iterator_category>>
+    : std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<It>::iterator_category> {};
+
+template <typename It>
+constexpr bool is_random_access_iterator_v =
+    is_random_access_iterator<It>::value;
+
+/**
+ * @brief Enables an overload only for random-access iterators
+ */
+template <typename It>
+using enable_if_random_access_t =
+    std::enable_if_t<is_random_access_iterator_v<It>, int>;
+
+/**
+ * @brief Value type of an iterator
+ */
+template <typename It>
+using iter_value_t = typename std::iterator_traits<It>::value_type;
+
+#endif  // RANGE_TRAITS_HPP
@@ -0,0 +1,555 @@
+// src/scan_algorithms.hpp
+
+#ifndef SCAN_ALGORITHMS_HPP
+#define SCAN_ALGORITHMS_HPP
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "auto_tune.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inner_product_common.hpp"
+#include "inner_product_threads.hpp"
+#include "instrumentation.hpp"
+#include "range_traits.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief This header file contains parallel primitives built on the chunked
+ * scan: stream compaction (copy_if), stable partition, the per-chunk
+ * histograms and scatter offsets of a radix sort, and sparse matrix-vector
+ * products in CSR format.
+ *
+ * The compaction-style algorithms share one pattern. The input is split into
+ * chunks; each chunk counts what it will write (reduce), an exclusive scan
+ * of the counts gives every chunk its first output position, and the chunks
+ * then write their elements independently (scatter). Output is in input
+ * order, so every algorithm matches its serial std counterpart exactly.
+ */
+
+/**
+ * @brief Split of n elements into num_chunks contiguous chunks; all chunks
+ * but the last hold chunk_size elements and none is empty
+ */
+struct ChunkPlan {
+  size_t n = 0;
+  size_t chunk_size = 0;
+  unsigned int num_chunks = 1;
+
+  size_t begin(size_t chunk) const { return std::min(n, chunk * chunk_size); }
+  size_t end(size_t chunk) const {
+    return std::min(n, (chunk + 1) * chunk_size);
+  }
+};
+
+/**
+ * @brief Splits n elements into at most num_chunks chunks using ceiling
+ * division, dropping the chunks that would be empty
+ */
+inline ChunkPlan make_chunk_plan(size_t n, unsigned int num_chunks) {
+  ChunkPlan plan;
+  plan.n = n;
+  if (n == 0) return plan;
+  num_chunks = std::max(1u, num_chunks);
+  if (num_chunks > n) num_chunks = static_cast<unsigned int>(n);
+  plan.chunk_size = (n + num_chunks - 1) / num_chunks;
+  plan.num_chunks =
+      static_cast<unsigned int>((n + plan.chunk_size - 1) / plan.chunk_size);
+  return plan;
+}
+
+/**
+ * @brief Looks up the tuned profile of the scan-based algorithms for element
+ * type T, calibrating it on first use; the calibration kernel is a serial
+ * compaction, the cheapest per-element work of the family
+ */
+template <typename T>
+TuningProfile scan_algorithms_threads_profile(ThreadPool& pool) {
+  static const std::string key = profile_key<T>("scan_algorithms_threads");
+  static thread_local CachedProfile cache;
+  std::vector<T> sample;  // allocated only if a calibration runs
+  std::vector<T> kept;
+  return pool_profile(
+      pool, key, cache,
+      [&]() {
+        sample.resize(kCalibrationElements, T(1));
+        kept.resize(kCalibrationElements);
+        keep_result(std::copy_if(sample.begin(), sample.end(), kept.begin(),
+                                 [](const T& v) { return v != T(0); }) -
+                    kept.begin());
+      },
+      kCalibrationElements);
+}
+
+/**
+ * @brief Plans the chunks of a scan-based algorithm over n elements;
+ * kAutoThreads lets the auto-tuner choose the chunk count
+ */
+template <typename T>
+ChunkPlan plan_scan_algorithm(ThreadPool& pool, size_t n,
+                              unsigned int num_threads) {
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(scan_algorithms_threads_profile<T>(pool), n,
+                              pool_workers(pool));
+  }
+  return make_chunk_plan(n, num_threads);
+}
+
+/**
+ * @brief Turns per-chunk counts into output offsets in place: counts holds
+ * one count per chunk plus a trailing slot, and afterwards counts[c] is the
+ * first output position of chunk c and counts.back() the total
+ */
+inline void counts_to_offsets(ThreadPool& pool, std::vector<size_t>& counts) {
+  parallel_exclusive_scan_threads(pool, counts.begin(), counts.end(),
+                                  counts.begin());
+}
+
+// ---------------------------------------------------------------------------
+// Stream compaction and partition
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Copies the elements of [first, last) that satisfy pred to d_first,
+ * keeping their order, on a persistent thread pool (parallel std::copy_if)
+ * @param pool The thread pool that executes the chunks
+ * @param first, last The input range
+ * @param d_first Start of the output range (random access, must not overlap
+ * the input)
+ * @param pred Unary predicate; it is called twice per element (count and
+ * copy pass), so it must return the same value for the same element
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @return Iterator past the last element written
+ */
+template <typename InIt, typename OutIt, typename Pred,
+          enable_if_random_access_t<InIt> = 0>
+OutIt parallel_copy_if_threads(ThreadPool& pool, InIt first, InIt last,
+                               OutIt d_first, Pred pred,
+                               unsigned int num_threads = kAutoThreads) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  AMS562_TRACE_REGION("copy_if_threads", n);
+
+  ChunkPlan plan = plan_scan_algorithm<T>(pool, n, num_threads);
+  if (plan.num_chunks <= 1) return std::copy_if(first, last, d_first, pred);
+
+  // Reduce: count the selected elements of every chunk
+  std::vector<size_t> offsets(plan.num_chunks + 1, 0);
+  pool.parallel_for(plan.num_chunks, [&](size_t c) {
+    AMS562_TRACE_CHUNK("copy_if_threads/count", c, plan.end(c) - plan.begin(c));
+    offsets[c] = static_cast<size_t>(
+        std::count_if(first + plan.begin(c), first + plan.end(c), pred));
+  });
+  counts_to_offsets(pool, offsets);
+
+  // Scatter: every chunk writes its selected elements at its offset
+  pool.parallel_for(plan.num_chunks, [&](size_t c) {
+    AMS562_TRACE_CHUNK("copy_if_threads/copy", c, plan.end(c) - plan.begin(c));
+    std::copy_if(first + plan.begin(c), first + plan.end(c),
+                 d_first + offsets[c], pred);
+  });
+  return d_first + offsets.back();
+}
+
+/**
+ * @brief Copies the elements of [first, last) that satisfy pred to d_first
+ * using the process-wide thread pool (see the pool overload)
+ */
+template <typename InIt, typename OutIt, typename Pred,
+          enable_if_random_access_t<InIt> = 0>
+OutIt parallel_copy_if_threads(InIt first, InIt last, OutIt d_first,
+                               Pred pred,
+                               unsigned int num_threads = kAutoThreads) {
+  return parallel_copy_if_threads(default_thread_pool(), first, last, d_first,
+                                  pred, num_threads);
+}
+
+/**
+ * @brief Returns the elements of input that satisfy pred, in input order
+ * (stream compaction), on a persistent thread pool
+ */
+template <typename T, typename Pred>
+std::vector<T> parallel_copy_if_threads(
+    ThreadPool& pool, const std::vector<T>& input, Pred pred,
+    unsigned int num_threads = kAutoThreads) {
+  std::vector<T> output(input.size());
+  auto end = parallel_copy_if_threads(pool, input.begin(), input.end(),
+                                      output.begin(), pred, num_threads);
+  output.erase(end, output.end());
+  return output;
+}
+
+/**
+ * @brief Returns the elements of input that satisfy pred, in input order,
+ * using the process-wide thread pool
+ */
+template <typename T, typename Pred>
+std::vector<T> parallel_copy_if_threads(
+    const std::vector<T>& input, Pred pred,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_copy_if_threads(default_thread_pool(), input, pred,
+                                  num_threads);
+}
+
+/**
+ * @brief Stable partition of [first, last) into d_first: the elements that
+ * satisfy pred come first, then the others, each group in input order
+ * (parallel std::partition_copy into one range)
+ * @param pool The thread pool that executes the chunks
+ * @param first, last The input range
+ * @param d_first Start of the output range of last - first elements (random
+ * access, must not overlap the input)
+ * @param pred Unary predicate; called twice per element
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @return Iterator to the first output element that does not satisfy pred
+ */
+template <typename InIt, typename OutIt, typename Pred,
+          enable_if_random_access_t<InIt> = 0>
+OutIt parallel_partition_threads(ThreadPool& pool, InIt first, InIt last,
+                                 OutIt d_first, Pred pred,
+                                 unsigned int num_threads = kAutoThreads) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  AMS562_TRACE_REGION("partition_threads", n);
+
+  ChunkPlan plan = plan_scan_algorithm<T>(pool, n, num_threads);
+  if (plan.num_chunks <= 1) {
+    size_t selected = static_cast<size_t>(std::count_if(first, last, pred));
+    std::partition_copy(first, last, d_first, d_first + selected, pred);
+    return d_first + selected;
+  }
+
+  // Reduce and scan the counts of selected elements. The rejected elements
+  // before chunk c are the elements before it minus the selected ones, so a
+  // single scan places both groups.
+  std::vector<size_t> offsets(plan.num_chunks + 1, 0);
+  pool.parallel_for(plan.num_chunks, [&](size_t c) {
+    AMS562_TRACE_CHUNK("partition_threads/count", c,
+                       plan.end(c) - plan.begin(c));
+    offsets[c] = static_cast<size_t>(
+        std::count_if(first + plan.begin(c), first + plan.end(c), pred));
+  });
+  counts_to_offsets(pool, offsets);
+  const size_t selected = offsets.back();
+
+  pool.parallel_for(plan.num_chunks, [&](size_t c) {
+    AMS562_TRACE_CHUNK("partition_threads/copy", c,
+                       plan.end(c) - plan.begin(c));
+    std::partition_copy(first + plan.begin(c), first + plan.end(c),
+                        d_first + offsets[c],
+                        d_first + selected + (plan.begin(c) - offsets[c]),
+                        pred);
+  });
+  return d_first + selected;
+}
+
+/**
+ * @brief Stable partition of [first, last) into d_first using the
+ * process-wide thread pool (see the pool overload)
+ */
+template <typename InIt, typename OutIt, typename Pred,
+          enable_if_random_access_t<InIt> = 0>
+OutIt parallel_partition_threads(InIt first, InIt last, OutIt d_first,
+                                 Pred pred,
+                                 unsigned int num_threads = kAutoThreads) {
+  return parallel_partition_threads(default_thread_pool(), first, last,
+                                    d_first, pred, num_threads);
+}
+
+/**
+ * @brief Stable in-place partition of a vector on a persistent thread pool
+ * (parallel std::stable_partition); uses one temporary copy of data
+ * @return Number of elements that satisfy pred (the partition point)
+ */
+template <typename T, typename Pred>
+size_t parallel_partition_threads(ThreadPool& pool, std::vector<T>& data,
+                                  Pred pred,
+                                  unsigned int num_threads = kAutoThreads) {
+  std::vector<T> partitioned(data.size());
+  auto point = parallel_partition_threads(pool, data.begin(), data.end(),
+                                          partitioned.begin(), pred,
+                                          num_threads);
+  data.swap(partitioned);
+  return static_cast<size_t>(point - data.begin());
+}
+
+/**
+ * @brief Stable in-place partition of a vector using the process-wide thread
+ * pool
+ * @return Number of elements that satisfy pred (the partition point)
+ */
+template <typename T, typename Pred>
+size_t parallel_partition_threads(std::vector<T>& data, Pred pred,
+                                  unsigned int num_threads = kAutoThreads) {
+  return parallel_partition_threads(default_thread_pool(), data, pred,
+                                    num_threads);
+}
+
+// ---------------------------------------------------------------------------
+// Histograms and radix scatter offsets
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Per-chunk bin counts of a range, the first pass of a radix sort
+ *
+ * counts is bin-major: counts[bin * plan.num_chunks + chunk]. In this order
+ * an exclusive scan of counts (histogram_scatter_offsets) yields, for every
+ * chunk and bin, the first output position of that chunk's elements in that
+ * bin, which is exactly what a stable counting-sort scatter needs.
+ */
+struct ChunkedHistogram {
+  ChunkPlan plan;
+  size_t num_bins = 0;
+  std::vector<size_t> counts;
+
+  size_t& at(size_t bin, size_t chunk) {
+    return counts[bin * plan.num_chunks + chunk];
+  }
+  size_t at(size_t bin, size_t chunk) const {
+    return counts[bin * plan.num_chunks + chunk];
+  }
+};
+
+/**
+ * @brief Counts, per chunk, how many elements of [first, last) fall in each
+ * of num_bins bins
+ * @param pool The thread pool that executes the chunks
+ * @param first, last The input range
+ * @param num_bins Number of bins
+ * @param bin_of Callable mapping an element to its bin in [0, num_bins)
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ */
+template <typename InIt, typename BinOf, enable_if_random_access_t<InIt> = 0>
+ChunkedHistogram parallel_chunked_histogram_threads(
+    ThreadPool& pool, InIt first, InIt last, size_t num_bins, BinOf bin_of,
+    unsigned int num_threads = kAutoThreads) {
+  using T = iter_value_t<InIt>;
+  size_t n = static_cast<size_t>(last - first);
+  AMS562_TRACE_REGION("histogram_threads", n);
+
+  ChunkedHistogram histogram;
+  histogram.plan = plan_scan_algorithm<T>(pool, n, num_threads);
+  histogram.num_bins = num_bins;
+  histogram.counts.assign(num_bins * histogram.plan.num_chunks, 0);
+
+  auto count_chunk = [&](size_t c) {
+    AMS562_TRACE_CHUNK("histogram_threads/count", c,
+                       histogram.plan.end(c) - histogram.plan.begin(c));
+    // Count into a private array; the bin-major slots of neighbouring chunks
+    // share cache lines
+    std::vector<size_t> local(num_bins, 0);
+    for (size_t i = histogram.plan.begin(c); i < histogram.plan.end(c); ++i) {
+      ++local[static_cast<size_t>(bin_of(first[i]))];
+    }
+    for (size_t bin = 0; bin < num_bins; ++bin) {
+      histogram.at(bin, c) = local[bin];
+    }
+  };
+  if (histogram.plan.num_chunks <= 1) {
+    count_chunk(0);
+  } else {
+    pool.parallel_for(histogram.plan.num_chunks, count_chunk);
+  }
+  return histogram;
+}
+
+/**
+ * @brief Turns the counts of a chunked histogram into scatter offsets in
+ * place: afterwards histogram.at(bin, chunk) is the output position of the
+ * first element of that chunk in that bin
+ * @return Total number of counted elements
+ */
+inline size_t histogram_scatter_offsets(ThreadPool& pool,
+                                        ChunkedHistogram& histogram) {
+  histogram.counts.push_back(0);
+  counts_to_offsets(pool, histogram.counts);
+  size_t total = histogram.counts.back();
+  histogram.counts.pop_back();
+  return total;
+}
+
+/**
+ * @brief Counts how many elements of [first, last) fall in each of num_bins
+ * bins, on a persistent thread pool
+ * @return num_bins counts
+ */
+template <typename InIt, typename BinOf, enable_if_random_access_t<InIt> = 0>
+std::vector<size_t> parallel_histogram_threads(
+    ThreadPool& pool, InIt first, InIt last, size_t num_bins, BinOf bin_of,
+    unsigned int num_threads = kAutoThreads) {
+  ChunkedHistogram histogram = parallel_chunked_histogram_threads(
+      pool, first, last, num_bins, bin_of, num_threads);
+  std::vector<size_t> totals(num_bins, 0);
+  for (size_t bin = 0; bin < num_bins; ++bin) {
+    for (size_t c = 0; c < histogram.plan.num_chunks; ++c) {
+      totals[bin] += histogram.at(bin, c);
+    }
+  }
+  return totals;
+}
+
+/**
+ * @brief Counts how many elements of [first, last) fall in each of num_bins
+ * bins using the process-wide thread pool
+ */
+template <typename InIt, typename BinOf, enable_if_random_access_t<InIt> = 0>
+std::vector<size_t> parallel_histogram_threads(
+    InIt first, InIt last, size_t num_bins, BinOf bin_of,
+    unsigned int num_threads = kAutoThreads) {
+  return parallel_histogram_threads(default_thread_pool(), first, last,
+                                    num_bins, bin_of, num_threads);
+}
+
+// ---------------------------------------------------------------------------
+// Sparse matrix-vector product
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Sparse matrix in compressed sparse row format: the nonzeros of row
+ * i are values[k] at columns col_indices[k] for k in
+ * [row_offsets[i], row_offsets[i + 1])
+ */
+template <typename T>
+struct CsrMatrix {
+  size_t rows = 0;
+  size_t cols = 0;
+  std::vector<size_t> row_offsets{0};
+  std::vector<size_t> col_indices;
+  std::vector<T> values;
+
+  size_t nonzeros() const { return values.size(); }
+};
+
+/**
+ * @brief Builds a CSR matrix from (row, column, value) triplets
+ *
+ * Row lengths are counted serially and turned into row offsets by the
+ * parallel exclusive scan; the nonzeros of each row keep the order of the
+ * triplets. Duplicate entries are kept (they add up in a product).
+ * @throws std::invalid_argument if the triplet arrays differ in length or an
+ * index is out of range
+ */
+template <typename T>
+CsrMatrix<T> csr_from_triplets(ThreadPool& pool, size_t rows, size_t cols,
+                               const std::vector<size_t>& row_indices,
+                               const std::vector<size_t>& col_indices,
+                               const std::vector<T>& values) {
+  if (row_indices.size() != values.size() ||
+      col_indices.size() != values.size()) {
+    throw std::invalid_argument("Triplet arrays must be of the same size");
+  }
+  CsrMatrix<T> matrix;
+  matrix.rows = rows;
+  matrix.cols = cols;
+  matrix.row_offsets.assign(rows + 1, 0);
+  for (size_t k = 0; k < values.size(); ++k) {
+    if (row_indices[k] >= rows || col_indices[k] >= cols) {
+      throw std::invalid_argument("Triplet index out of range");
+    }
+    ++matrix.row_offsets[row_indices[k]];
+  }
+  parallel_exclusive_scan_threads(pool, matrix.row_offsets.begin(),
+                                  matrix.row_offsets.end(),
+                                  matrix.row_offsets.begin());
+
+  matrix.col_indices.resize(values.size());
+  matrix.values.resize(values.size());
+  std::vector<size_t> next(matrix.row_offsets.begin(),
+                           matrix.row_offsets.end() - 1);
+  for (size_t k = 0; k < values.size(); ++k) {
+    size_t slot = next[row_indices[k]]++;
+    matrix.col_indices[slot] = col_indices[k];
+    matrix.values[slot] = values[k];
+  }
+  return matrix;
+}
+
+/**
+ * @brief Builds a CSR matrix from triplets using the process-wide thread pool
+ */
+template <typename T>
+CsrMatrix<T> csr_from_triplets(size_t rows, size_t cols,
+                               const std::vector<size_t>& row_indices,
+                               const std::vector<size_t>& col_indices,
+                               const std::vector<T>& values) {
+  return csr_from_triplets(default_thread_pool(), rows, cols, row_indices,
+                           col_indices, values);
+}
+
+/**
+ * @brief Computes y[first_row, last_row) of y = A x
+ */
+template <typename T>
+void csr_rows_multiply(const CsrMatrix<T>& matrix, const T* x, T* y,
+                       size_t first_row, size_t last_row) {
+  for (size_t i = first_row; i < last_row; ++i) {
+    T sum = T(0);
+    for (size_t k = matrix.row_offsets[i]; k < matrix.row_offsets[i + 1];
+         ++k) {
+      sum += matrix.values[k] * x[matrix.col_indices[k]];
+    }
+    y[i] = sum;
+  }
+}
+
+/**
+ * @brief Computes y = A x on a persistent thread pool
+ *
+ * The rows are split into chunks of roughly equal nonzero counts (the row
+ * offsets are the running nonzero counts), so a few dense rows do not leave
+ * the other workers idle. Every row is summed in column order, so the result
+ * does not depend on the chunk count.
+ * @param pool The thread pool that executes the chunks
+ * @param matrix The CSR matrix A
+ * @param x Input vector of matrix.cols elements
+ * @param y Output vector; resized to matrix.rows elements
+ * @param num_threads Number of chunks to split the work into (kAutoThreads,
+ * the default, lets the auto-tuner choose)
+ * @throws std::invalid_argument if x does not have matrix.cols elements
+ */
+template <typename T>
+void parallel_spmv_threads(ThreadPool& pool, const CsrMatrix<T>& matrix,
+                           const std::vector<T>& x, std::vector<T>& y,
+                           unsigned int num_threads = kAutoThreads) {
+  if (x.size() != matrix.cols) {
+    throw std::invalid_argument("Vector size must match the matrix columns");
+  }
+  y.resize(matrix.rows);
+  const size_t nnz = matrix.nonzeros();
+  AMS562_TRACE_REGION("spmv_threads", nnz);
+
+  if (num_threads == kAutoThreads) {
+    num_threads = plan_chunks(inner_product_threads_profile<T>(pool), nnz,
+                              pool_workers(pool));
+  }
+  if (num_threads <= 1 || matrix.rows <= 1) {
+    csr_rows_multiply(matrix, x.data(), y.data(), 0, matrix.rows);
+    return;
+  }
+  // Rows are balanced like the pairs of a batched inner product
+  std::vector<size_t> bounds = batch_bounds(matrix.row_offsets, num_threads);
+  pool.parallel_for(num_threads, [&](size_t c) {
+    AMS562_TRACE_CHUNK("spmv_threads/rows", c,
+                       matrix.row_offsets[bounds[c + 1]] -
+                           matrix.row_offsets[bounds[c]]);
+    csr_rows_multiply(matrix, x.data(), y.data(), bounds[c], bounds[c + 1]);
+  });
+}
+
+/**
+ * @brief Computes y = A x using the process-wide thread pool
+ */
+template <typename T>
+void parallel_spmv_threads(const CsrMatrix<T>& matrix, const std::vector<T>& x,
+                           std::vector<T>& y,
+                           unsigned int num_threads = kAutoThreads) {
+  parallel_spmv_threads(default_thread_pool(), matrix, x, y, num_threads);
+}
+
+#endif  // SCAN_ALGORITHMS_HPP
@@ -0,0 +1,364 @@
+// src/scan_common.hpp
+
+#ifndef SCAN_COMMON_HPP
+#define SCAN_COMMON_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "padded_slots.hpp"
+#include "simd_scan.hpp"
+
+/**
+ * @brief This header file contains the pieces shared by the threads and
+ * OpenMP scans: the selectable scan algorithm, the per-chunk kernels and the
+ * single-pass decoupled look-back scan.
+ *
+ * The kernels are generic over the binary operation, which must be
+ * associative but need not be commutative: partial results are always
+ * combined left to right. Input and output may be the same range (in-place
+ * scan). Additions of arithmetic types over contiguous memory run the
+ * vectorized kernels of simd_scan.hpp.
+ */
+
+/**
+ * @brief Algorithm used by the parallel scans
+ */
+enum class ScanMode {
+  /// Local scan of every chunk, then add the preceding chunk sums to every
+  /// output element (two passes over the output).
+  ScanThenAdd,
+  /// Single pass: every block publishes its aggregate and inclusive prefix,
+  /// and later blocks fold them in through decoupled look-back.
+  DecoupledLookback,
+  /// Read-only reduction of every chunk, then a single scan of every chunk
+  /// seeded with the sum of the preceding chunks (one write per element).
+  ReduceThenScan
+};
+
+/**
+ * @brief Whether output element i includes input element i
+ */
+enum class ScanType {
+  Inclusive,  ///< output[i] = input[0] op ... op input[i]
+  Exclusive   ///< output[i] = identity op input[0] op ... op input[i - 1]
+};
+
+/**
+ * @brief Associative maximum, for running-maximum scans (identity: lowest)
+ */
+struct scan_maximum {
+  template <typename T>
+  T operator()(const T& a, const T& b) const {
+    return a < b ? b : a;
+  }
+};
+
+/**
+ * @brief Associative minimum, for running-minimum scans (identity: max)
+ */
+struct scan_minimum {
+  template <typename T>
+  T operator()(const T& a, const T& b) const {
+    return b < a ? b : a;
+  }
+};
+
+/**
+ * @brief True when It addresses contiguous elements of type T (raw pointers
+ * and std::vector iterators), so a chunk can be handed to the SIMD kernels
+ */
+template <typename It, typename T>
+constexpr bool is_contiguous_iterator_of_v =
+    !std::is_same_v<T, bool> &&
+    (std::is_same_v<It, T*> || std::is_same_v<It, const T*> ||
+     std::is_same_v<It, typename std::vector<T>::iterator> ||
+     std::is_same_v<It, typename std::vector<T>::const_iterator>);
+
+/**
+ * @brief True when a chunk scan can run the SIMD kernels: an addition of an
+ * arithmetic type over contiguous memory
+ */
+template <typename InIt, typename OutIt, typename T, typename BinaryOp>
+constexpr bool use_simd_scan_v =
+    std::is_arithmetic_v<T> &&
+    (std::is_same_v<BinaryOp, std::plus<T>> ||
+     std::is_same_v<BinaryOp, std::plus<>>) &&
+    is_contiguous_iterator_of_v<InIt, T> &&
+    is_contiguous_iterator_of_v<OutIt, T> &&
+    !std::is_same_v<OutIt, const T*> &&
+    !std::is_same_v<OutIt, typename std::vector<T>::const_iterator>;
+
+/**
+ * @brief Reduces input[start_idx, end_idx) with op; the range must not be
+ * empty
+ */
+template <typename InIt, typename BinaryOp>
+auto chunk_reduce(InIt input, size_t start_idx, size_t end_idx, BinaryOp op) {
+  typename std::iterator_traits<InIt>::value_type result = input[start_idx];
+  for (size_t i = start_idx + 1; i < end_idx; ++i) {
+    result = op(result, input[i]);
+  }
+  return result;
+}
+
+/**
+ * @brief Sums input[start_idx, end_idx); the range must not be empty
+ */
+template <typename T>
+T chunk_reduce(const T* input, size_t start_idx, size_t end_idx) {
+  return chunk_reduce(input, start_idx, end_idx, std::plus<T>());
+}
+
+/**
+ * @brief Scans input[start_idx, end_idx) into output with seed folded in
+ * front of every result; output may be the same range as input
+ * @return seed op input[start_idx] op ... op input[end_idx - 1]
+ */
+template <typename InIt, typename OutIt, typename T, typename BinaryOp>
+T seeded_scan(InIt input, OutIt output, size_t start_idx, size_t end_idx,
+              T seed, BinaryOp op, ScanType type) {
+  if constexpr (use_simd_scan_v<InIt, OutIt, T, BinaryOp>) {
+    if (type == ScanType::Inclusive) {
+      const T* in = &input[0];
+      T* out = &output[0];
+      return simd_inclusive_scan(in + start_idx, out + start_idx,
+                                 end_idx - start_idx, seed);
+    }
+  }
+  T running = seed;
+  if (type == ScanType::Inclusive) {
+    for (size_t i = start_idx; i < end_idx; ++i) {
+      running = op(running, input[i]);
+      output[i] = running;
+    }
+  } else {
+    for (size_t i = start_idx; i < end_idx; ++i) {
+      T value = input[i];  // read before the write, for in-place scans
+      output[i] = running;
+      running = op(running, value);
+    }
+  }
+  return running;
+}
+
+/**
+ * @brief Inclusive scan of input[start_idx, end_idx) into output, with every
+ * result offset by seed; runs the vectorized kernel of simd_scan.hpp
+ * @return The last value written (seed plus the sum of the range)
+ */
+template <typename T>
+T seeded_inclusive_scan(const T* input, T* output, size_t start_idx,
+                        size_t end_idx, T seed) {
+  return seeded_scan(input, output, start_idx, end_idx, seed, std::plus<T>(),
+                     ScanType::Inclusive);
+}
+
+/**
+ * @brief Folds prefix in front of every element of output[start_idx, end_idx)
+ */
+template <typename OutIt, typename T, typename BinaryOp>
+void chunk_prepend(OutIt output, size_t start_idx, size_t end_idx,
+                   const T& prefix, BinaryOp op) {
+  for (size_t i = start_idx; i < end_idx; ++i) {
+    output[i] = op(prefix, output[i]);
+  }
+}
+
+/**
+ * @brief Running value at the end of a chunk of a segmented scan
+ *
+ * When the chunk contains a segment head, value is the reduction from the
+ * last head to the end of the chunk and nothing before the chunk reaches past
+ * it. Carries combine left to right with combine_segment_carries().
+ */
+template <typename T>
+struct SegmentCarry {
+  bool has_head = false;
+  T value{};
+};
+
+/**
+ * @brief Combines the carry of a chunk with the carry of the chunk after it
+ */
+template <typename T, typename BinaryOp>
+SegmentCarry<T> combine_segment_carries(const SegmentCarry<T>& left,
+                                        const SegmentCarry<T>& right,
+                                        BinaryOp op) {
+  if (right.has_head) return right;
+  return {left.has_head, op(left.value, right.value)};
+}
+
+/**
+ * @brief Reduces one chunk of a segmented scan without writing any output
+ */
+template <typename InIt, typename FlagIt, typename T, typename BinaryOp>
+SegmentCarry<T> segmented_chunk_reduce(InIt input, FlagIt flags,
+                                       size_t start_idx, size_t end_idx,
+                                       const T& identity, BinaryOp op) {
+  SegmentCarry<T> carry{false, identity};
+  for (size_t i = start_idx; i < end_idx; ++i) {
+    carry.value = flags[i] ? T(input[i]) : op(carry.value, input[i]);
+    carry.has_head = carry.has_head || flags[i];
+  }
+  return carry;
+}
+
+/**
+ * @brief Segmented inclusive scan of one chunk seeded with the running value
+ * of the preceding chunks; a set flag starts a new segment at that element
+ */
+template <typename InIt, typename FlagIt, typename OutIt, typename T,
+          typename BinaryOp>
+void segmented_seeded_scan(InIt input, FlagIt flags, OutIt output,
+                           size_t start_idx, size_t end_idx, T seed,
+                           BinaryOp op) {
+  T running = seed;
+  for (size_t i = start_idx; i < end_idx; ++i) {
+    running = flags[i] ? T(input[i]) : op(running, input[i]);
+    output[i] = running;
+  }
+}
+
+/**
+ * @brief Number of elements per look-back block; a block of input stays in
+ * the L2 cache between its reduction and its scan.
+ */
+template <typename T>
+constexpr size_t lookback_block_size() {
+  return std::max<size_t>(1024, (size_t(64) * 1024) / sizeof(T));
+}
+
+/**
+ * @brief Status descriptor that a look-back block publishes to its successors;
+ * each descriptor has a cache line of its own, so publishing one does not
+ * disturb the workers polling its neighbours
+ */
+template <typename T>
+struct alignas(kCacheLineSize) LookbackBlockStatus {
+  static constexpr uint8_t kInvalid = 0;    ///< Nothing published yet
+  static constexpr uint8_t kAggregate = 1;  ///< Block aggregate available
+  static constexpr uint8_t kPrefix = 2;     ///< Inclusive prefix available
+
+  std::atomic<uint8_t> flag{kInvalid};
+  T aggregate{};
+  T inclusive_prefix{};
+};
+
+/**
+ * @brief Shared state of one decoupled look-back scan
+ * @param input Iterator to the first input element
+ * @param output Iterator to the first output element (may equal input)
+ * @param n Number of elements
+ * @param op Associative binary operation
+ * @param identity Identity element of op, or the seed the scan continues from
+ * @param type Inclusive or exclusive scan
+ *
+ * Workers call run() concurrently. Blocks are claimed in increasing order
+ * through an atomic ticket, so every block a worker waits for is already
+ * owned by a running worker and the scan always makes progress.
+ */
+template <typename InIt, typename OutIt, typename T,
+          typename BinaryOp = std::plus<T>>
+class LookbackScan {
+ public:
+  LookbackScan(InIt input, OutIt output, size_t n, BinaryOp op = BinaryOp(),
+               T identity = T(0), ScanType type = ScanType::Inclusive)
+      : input_(input),
+        output_(output),
+        n_(n),
+        op_(op),
+        identity_(identity),
+        type_(type),
+        block_size_(lookback_block_size<T>()),
+        num_blocks_((n + block_size_ - 1) / block_size_),
+        status_(new LookbackBlockStatus<T>[num_blocks_]) {}
+
+  /**
+   * @brief Returns the number of blocks the input is split into
+   */
+  size_t num_blocks() const { return num_blocks_; }
+
+  /**
+   * @brief Returns the seed folded with every input element; valid once every
+   * run() has returned
+   */
+  T total() const {
+    return num_blocks_ == 0 ? identity_
+                            : status_[num_blocks_ - 1].inclusive_prefix;
+  }
+
+  /**
+   * @brief Claims and scans blocks until none are left
+   */
+  void run() {
+    using Status = LookbackBlockStatus<T>;
+    for (size_t b = next_block_.fetch_add(1, std::memory_order_relaxed);
+         b < num_blocks_; b = next_block_.fetch_add(1, std::memory_order_relaxed)) {
+      const size_t start_idx = b * block_size_;
+      const size_t end_idx = std::min(n_, start_idx + block_size_);
+
+      if (b == 0) {
+        status_[0].inclusive_prefix = seeded_scan(
+            input_, output_, start_idx, end_idx, identity_, op_, type_);
+        status_[0].flag.store(Status::kPrefix, std::memory_order_release);
+        continue;
+      }
+
+      // Publish the block aggregate; this read also pulls the block into cache
+      T aggregate = chunk_reduce(input_, start_idx, end_idx, op_);
+      status_[b].aggregate = aggregate;
+      status_[b].flag.store(Status::kAggregate, std::memory_order_release);
+
+      // Look back over the predecessors until an inclusive prefix is found
+      T exclusive = identity_;
+      bool have_exclusive = false;
+      for (size_t j = b; j-- > 0;) {
+        uint8_t flag = wait_for_status(status_[j]);
+        T value = flag == Status::kPrefix ? status_[j].inclusive_prefix
+                                          : status_[j].aggregate;
+        exclusive = have_exclusive ? op_(value, exclusive) : value;
+        have_exclusive = true;
+        if (flag == Status::kPrefix) break;
+      }
+      status_[b].inclusive_prefix = op_(exclusive, aggregate);
+      status_[b].flag.store(Status::kPrefix, std::memory_order_release);
+
+      // Scan the (cached) block seeded with the exclusive prefix
+      seeded_scan(input_, output_, start_idx, end_idx, exclusive, op_, type_);
+    }
+  }
+
+ private:
+  static uint8_t wait_for_status(const LookbackBlockStatus<T>& status) {
+    uint8_t flag;
+    unsigned int spins = 0;
+    while ((flag = status.flag.load(std::memory_order_acquire)) ==
+           LookbackBlockStatus<T>::kInvalid) {
+      if (++spins > 64) std::this_thread::yield();
+    }
+    return flag;
+  }
+
+  InIt input_;
+  OutIt output_;
+  size_t n_;
+  BinaryOp op_;
+  T identity_;
+  ScanType type_;
+  size_t block_size_;
+  size_t num_blocks_;
+  std::unique_ptr<LookbackBlockStatus<T>[]> status_;
+  // The ticket is bumped by every worker; keep it off the line of the
+  // read-only members above
+  alignas(kCacheLineSize) std::atomic<size_t> next_block_{0};
+};
+
+#endif  // SCAN_COMMON_HPP
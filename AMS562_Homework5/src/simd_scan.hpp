@@ -0,0 +1,299 @@
+// src/simd_scan.hpp
+
+#ifndef SIMD_SCAN_HPP
+#define SIMD_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AMS562_SIMD_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define AMS562_SIMD_SCAN_X86 0
+#endif
+
+/**
+ * @brief This header file implements vectorized inclusive scan kernels for
+ * the per-chunk scans of the threads and OpenMP implementations.
+ *
+ * A register of W elements is scanned in log2(W) shift-and-add steps
+ * (Hillis-Steele within the register), then offset by the carry of the
+ * previous register, whose last lane becomes the next carry. Kernels exist
+ * for 32- and 64-bit integers, float and double with AVX2 and AVX-512; the
+ * widest instruction set the CPU supports is chosen at runtime. Other types
+ * and other CPUs use the scalar loop.
+ *
+ * Floating-point results may differ in the last bits from a sequential scan
+ * because the additions are reassociated (as in any parallel scan).
+ */
+
+/**
+ * @brief Instruction sets available to the scan kernels
+ */
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+/**
+ * @brief Returns the widest instruction set supported by the running CPU
+ * (detected once)
+ */
+inline SimdLevel detected_simd_level() {
+#if AMS562_SIMD_SCAN_X86
+  static const SimdLevel level = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    return SimdLevel::Scalar;
+  }();
+  return level;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+#if AMS562_SIMD_SCAN_X86
+namespace simd_scan_detail {
+
+// Each kernel scans the largest multiple of the register width, seeded with
+// seed, and returns the number of elements processed. The caller finishes
+// the tail with the scalar loop.
+
+__attribute__((target("avx2"))) inline size_t scan_avx2(const int32_t* in,
+                                                        int32_t* out, size_t n,
+                                                        int32_t seed) {
+  __m256i carry = _mm256_set1_epi32(seed);
+  const __m256i last = _mm256_set1_epi32(7);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    __m256i low = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    x = _mm256_add_epi32(x, _mm256_permute2x128_si256(low, low, 0x08));
+    x = _mm256_add_epi32(x, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+    carry = _mm256_permutevar8x32_epi32(x, last);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline size_t scan_avx2(const int64_t* in,
+                                                        int64_t* out, size_t n,
+                                                        int64_t seed) {
+  __m256i carry = _mm256_set1_epi64x(seed);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    __m256i low = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 2, 3, 2));
+    x = _mm256_add_epi64(x, _mm256_permute2x128_si256(low, low, 0x08));
+    x = _mm256_add_epi64(x, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+    carry = _mm256_permute4x64_epi64(x, 0xFF);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline size_t scan_avx2(const float* in,
+                                                        float* out, size_t n,
+                                                        float seed) {
+  __m256 carry = _mm256_set1_ps(seed);
+  const __m256i last = _mm256_set1_epi32(7);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_loadu_ps(in + i);
+    x = _mm256_add_ps(
+        x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+    x = _mm256_add_ps(
+        x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+    __m256 low = _mm256_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    x = _mm256_add_ps(x, _mm256_permute2f128_ps(low, low, 0x08));
+    x = _mm256_add_ps(x, carry);
+    _mm256_storeu_ps(out + i, x);
+    carry = _mm256_permutevar8x32_ps(x, last);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline size_t scan_avx2(const double* in,
+                                                        double* out, size_t n,
+                                                        double seed) {
+  __m256d carry = _mm256_set1_pd(seed);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(in + i);
+    x = _mm256_add_pd(
+        x, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(x), 8)));
+    __m256d low = _mm256_permute_pd(x, 0xF);
+    x = _mm256_add_pd(x, _mm256_permute2f128_pd(low, low, 0x08));
+    x = _mm256_add_pd(x, carry);
+    _mm256_storeu_pd(out + i, x);
+    carry = _mm256_permute4x64_pd(x, 0xFF);
+  }
+  return i;
+}
+
+// GCC 12 reports a false positive from inside the permutexvar intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// valign{d,q}(x, 0, W - k) shifts the register up by k lanes, filling zeros
+__attribute__((target("avx512f"))) inline size_t scan_avx512(const int32_t* in,
+                                                             int32_t* out,
+                                                             size_t n,
+                                                             int32_t seed) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i last = _mm512_set1_epi32(15);
+  __m512i carry = _mm512_set1_epi32(seed);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_loadu_si512(in + i);
+    x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 15));
+    x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 14));
+    x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 12));
+    x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 8));
+    x = _mm512_add_epi32(x, carry);
+    _mm512_storeu_si512(out + i, x);
+    carry = _mm512_permutexvar_epi32(last, x);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f"))) inline size_t scan_avx512(const int64_t* in,
+                                                             int64_t* out,
+                                                             size_t n,
+                                                             int64_t seed) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i last = _mm512_set1_epi64(7);
+  __m512i carry = _mm512_set1_epi64(seed);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512i x = _mm512_loadu_si512(in + i);
+    x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 7));
+    x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 6));
+    x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 4));
+    x = _mm512_add_epi64(x, carry);
+    _mm512_storeu_si512(out + i, x);
+    carry = _mm512_permutexvar_epi64(last, x);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f"))) inline size_t scan_avx512(const float* in,
+                                                             float* out,
+                                                             size_t n,
+                                                             float seed) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i last = _mm512_set1_epi32(15);
+  __m512 carry = _mm512_set1_ps(seed);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 x = _mm512_loadu_ps(in + i);
+    __m512i xi = _mm512_castps_si512(x);
+    x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(xi, zero, 15)));
+    xi = _mm512_castps_si512(x);
+    x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(xi, zero, 14)));
+    xi = _mm512_castps_si512(x);
+    x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(xi, zero, 12)));
+    xi = _mm512_castps_si512(x);
+    x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(xi, zero, 8)));
+    x = _mm512_add_ps(x, carry);
+    _mm512_storeu_ps(out + i, x);
+    carry = _mm512_permutexvar_ps(last, x);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f"))) inline size_t scan_avx512(const double* in,
+                                                             double* out,
+                                                             size_t n,
+                                                             double seed) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i last = _mm512_set1_epi64(7);
+  __m512d carry = _mm512_set1_pd(seed);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d x = _mm512_loadu_pd(in + i);
+    __m512i xi = _mm512_castpd_si512(x);
+    x = _mm512_add_pd(x, _mm512_castsi512_pd(_mm512_alignr_epi64(xi, zero, 7)));
+    xi = _mm512_castpd_si512(x);
+    x = _mm512_add_pd(x, _mm512_castsi512_pd(_mm512_alignr_epi64(xi, zero, 6)));
+    xi = _mm512_castpd_si512(x);
+    x = _mm512_add_pd(x, _mm512_castsi512_pd(_mm512_alignr_epi64(xi, zero, 4)));
+    x = _mm512_add_pd(x, carry);
+    _mm512_storeu_pd(out + i, x);
+    carry = _mm512_permutexvar_pd(last, x);
+  }
+  return i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Maps T to the element type of the kernel that handles it, or void
+template <typename T>
+using kernel_type_t = std::conditional_t<
+    std::is_same_v<T, float> || std::is_same_v<T, double>, T,
+    std::conditional_t<
+        std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) == 4,
+        int32_t,
+        std::conditional_t<std::is_integral_v<T> &&
+                               !std::is_same_v<T, bool> && sizeof(T) == 8,
+                           int64_t, void>>>;
+
+}  // namespace simd_scan_detail
+#endif  // AMS562_SIMD_SCAN_X86
+
+/**
+ * @brief Inclusive scan of in[0, n) into out, with every result offset by
+ * seed, using the given instruction set where a kernel exists for T
+ * @param in Pointer to the first input element
+ * @param out Pointer to the first output element (may equal in)
+ * @param n Number of elements
+ * @param seed Value added to every result (the sum of everything before in)
+ * @param level Instruction set to use; levels above the CPU's are clamped
+ * @return The last value written (seed if n is 0)
+ */
+template <typename T>
+T simd_inclusive_scan(const T* in, T* out, size_t n, T seed,
+                      SimdLevel level) {
+  size_t i = 0;
+#if AMS562_SIMD_SCAN_X86
+  using K = simd_scan_detail::kernel_type_t<T>;
+  if constexpr (!std::is_void_v<K>) {
+    if (level > detected_simd_level()) level = detected_simd_level();
+    const K* kin = reinterpret_cast<const K*>(in);
+    K* kout = reinterpret_cast<K*>(out);
+    if (level == SimdLevel::AVX512) {
+      i = simd_scan_detail::scan_avx512(kin, kout, n, static_cast<K>(seed));
+    } else if (level == SimdLevel::AVX2) {
+      i = simd_scan_detail::scan_avx2(kin, kout, n, static_cast<K>(seed));
+    }
+    if (i > 0) seed = out[i - 1];
+  }
+#else
+  (void)level;
+#endif
+  T running = seed;
+  for (; i < n; ++i) {
+    running = running + in[i];
+    out[i] = running;
+  }
+  return running;
+}
+
+/**
+ * @brief Inclusive scan of in[0, n) into out, offset by seed, using the widest
+ * instruction set of the running CPU
+ * @return The last value written (seed if n is 0)
+ */
+template <typename T>
+T simd_inclusive_scan(const T* in, T* out, size_t n, T seed) {
+  return simd_inclusive_scan(in, out, n, seed, detected_simd_level());
+}
+
+#endif  // SIMD_SCAN_HPP
@@ -0,0 +1,288 @@
+// src/stealing_primitives.hpp
+
+#ifndef STEALING_PRIMITIVES_HPP
+#define STEALING_PRIMITIVES_HPP
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "inner_product_common.hpp"
+#include "instrumentation.hpp"
+#include "padded_slots.hpp"
+#include "range_traits.hpp"
+#include "scan_common.hpp"
+#include "work_stealing.hpp"
+
+/**
+ * @brief This header file contains the inner product and the scans on the
+ * work-stealing scheduler of work_stealing.hpp.
+ *
+ * Instead of one equal chunk per thread, the input is cut into about
+ * kStealingLeavesPerWorker leaves per worker, and the leaves are handed out
+ * by recursive splitting and stealing. When a worker loses its core to
+ * another process, the others steal its pending leaves, so a call finishes
+ * at the pace of the workers that run.
+ *
+ * The inner product reduces the leaves in a fixed binary tree. The scan is a
+ * reduce-then-scan over blocks: a stolen read-only pass computes the block
+ * sums, a short serial pass turns them into block prefixes, and a second
+ * stolen pass scans every block seeded with its prefix.
+ */
+
+/**
+ * @brief Grain argument that lets the primitives choose the leaf size
+ */
+constexpr size_t kAutoGrain = 0;
+
+/**
+ * @brief Smallest leaf of the stealing primitives; smaller inputs run on the
+ * calling thread
+ */
+constexpr size_t kStealingMinGrain = 16384;
+
+/**
+ * @brief Number of leaves per thread the input is cut into; the slack lets
+ * the workers that run take over the leaves of the ones that do not
+ */
+constexpr size_t kStealingLeavesPerWorker = 8;
+
+/**
+ * @brief Leaf size for n elements on a scheduler (grain if given)
+ */
+inline size_t stealing_grain(const WorkStealingScheduler& scheduler, size_t n,
+                             size_t grain) {
+  if (grain != kAutoGrain) return grain;
+  size_t leaves = kStealingLeavesPerWorker * (scheduler.size() + 1);
+  return std::max(kStealingMinGrain, (n + leaves - 1) / leaves);
+}
+
+/**
+ * @brief Reduces [0, n) by recursive halving: leaf(begin, end) for ranges of
+ * at most grain elements, combined with combine(left, right)
+ *
+ * The split points depend only on n and grain, so the combination tree (and
+ * the rounding of a floating-point result) does not depend on the schedule.
+ */
+template <typename R, typename Leaf, typename Combine>
+R stealing_reduce(WorkStealingScheduler& scheduler, size_t begin, size_t end,
+                  size_t grain, const Leaf& leaf, const Combine& combine) {
+  if (end - begin <= grain) return leaf(begin, end);
+  size_t mid = begin + (end - begin) / 2;
+  R right{};
+  TaskGroup group(scheduler);
+  group.spawn([&]() {
+    right = stealing_reduce<R>(scheduler, mid, end, grain, leaf, combine);
+  });
+  R left = stealing_reduce<R>(scheduler, begin, mid, grain, leaf, combine);
+  group.sync();
+  return combine(left, right);
+}
+
+/**
+ * @brief Computes the inner product of two iterator ranges on a
+ * work-stealing scheduler
+ * @param scheduler The scheduler that runs the leaves
+ * @param first1 Iterator to the first element of the first range
+ * @param last1 Iterator past the last element of the first range
+ * @param first2 Start of the second range (at least last1 - first1 long)
+ * @param grain Elements per leaf (kAutoGrain, the default, chooses
+ * stealing_grain)
+ * @param mode How floating-point products are accumulated (see
+ * AccumulationMode); Reproducible matches the other backends bit for bit
+ * @return Inner product of the two ranges
+ */
+template <typename It1, typename It2, enable_if_random_access_t<It1> = 0>
+iter_value_t<It1> parallel_inner_product_stealing(
+    WorkStealingScheduler& scheduler, It1 first1, It1 last1, It2 first2,
+    size_t grain = kAutoGrain,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  using T = iter_value_t<It1>;
+  const size_t n = static_cast<size_t>(last1 - first1);
+  AMS562_TRACE_REGION("inner_product_stealing", n);
+  grain = stealing_grain(scheduler, n, grain);
+
+  if (mode == AccumulationMode::Reproducible) {
+    // Fixed blocks summed by a fixed tree; the leaves only decide who sums
+    // which blocks
+    const size_t num_blocks = reproducible_block_count(n);
+    std::vector<T> block_sums(num_blocks);
+    const size_t blocks_per_leaf =
+        std::max<size_t>(1, grain / kReproducibleBlockSize);
+    scheduler.parallel_range(num_blocks, blocks_per_leaf,
+                             [&](size_t begin, size_t end) {
+                               reproducible_block_sums(first1, first2, n,
+                                                       begin, end,
+                                                       block_sums.data());
+                             });
+    return pairwise_sum(block_sums);
+  }
+  if (n == 0) return T(0);
+  if (mode == AccumulationMode::Compensated) {
+    return stealing_reduce<CompensatedSum<T>>(
+               scheduler, 0, n, grain,
+               [&](size_t begin, size_t end) {
+                 return compensated_inner_product(first1 + begin,
+                                                  first1 + end,
+                                                  first2 + begin,
+                                                  CompensatedSum<T>());
+               },
+               [](CompensatedSum<T> left, const CompensatedSum<T>& right) {
+                 left.add(right);
+                 return left;
+               })
+        .value();
+  }
+  return stealing_reduce<T>(
+      scheduler, 0, n, grain,
+      [&](size_t begin, size_t end) {
+        AMS562_TRACE_CHUNK("inner_product_stealing/leaf", -1, end - begin);
+        return std::inner_product(first1 + begin, first1 + end,
+                                  first2 + begin, T(0));
+      },
+      [](const T& left, const T& right) { return left + right; });
+}
+
+/**
+ * @brief Computes the inner product of two vectors on a work-stealing
+ * scheduler
+ * @throws std::invalid_argument if the vectors differ in size
+ */
+template <typename T>
+T parallel_inner_product_stealing(
+    WorkStealingScheduler& scheduler, const std::vector<T>& a,
+    const std::vector<T>& b, size_t grain = kAutoGrain,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("Vectors must be of the same size");
+  }
+  return parallel_inner_product_stealing(scheduler, a.begin(), a.end(),
+                                         b.begin(), grain, mode);
+}
+
+/**
+ * @brief Computes the inner product of two vectors on the process-wide
+ * work-stealing scheduler
+ * @throws std::invalid_argument if the vectors differ in size
+ */
+template <typename T>
+T parallel_inner_product_stealing(
+    const std::vector<T>& a, const std::vector<T>& b,
+    size_t grain = kAutoGrain,
+    AccumulationMode mode = AccumulationMode::Fast) {
+  return parallel_inner_product_stealing(default_work_stealing_scheduler(), a,
+                                         b, grain, mode);
+}
+
+/**
+ * @brief Performs a parallel scan with an associative operation on a
+ * work-stealing scheduler (reduce-then-scan over blocks of grain elements)
+ * @param scheduler The scheduler that runs the blocks
+ * @param first Iterator to the first input element
+ * @param last Iterator past the last input element
+ * @param d_first Iterator to the first output element; may equal first
+ * @param op Associative binary operation (need not be commutative)
+ * @param identity Identity element of op
+ * @param type Inclusive or exclusive scan
+ * @param grain Elements per block (kAutoGrain, the default, chooses
+ * stealing_grain)
+ */
+template <typename InIt, typename OutIt, typename BinaryOp,
+          enable_if_random_access_t<InIt> = 0>
+void parallel_scan_stealing(WorkStealingScheduler& scheduler, InIt first,
+                            InIt last, OutIt d_first, BinaryOp op,
+                            iter_value_t<InIt> identity, ScanType type,
+                            size_t grain = kAutoGrain) {
+  using T = iter_value_t<InIt>;
+  const size_t n = static_cast<size_t>(last - first);
+  if (n == 0) return;
+  AMS562_TRACE_REGION("scan_stealing", n);
+  grain = stealing_grain(scheduler, n, grain);
+  const size_t num_blocks = (n + grain - 1) / grain;
+  if (num_blocks == 1) {
+    seeded_scan(first, d_first, 0, n, identity, op, type);
+    return;
+  }
+
+  // Pass 1: read-only reduction of every block but the last
+  PaddedSlots<T> block_sums(num_blocks, identity);
+  scheduler.parallel_range(num_blocks - 1, 1, [&](size_t begin, size_t end) {
+    for (size_t blk = begin; blk < end; ++blk) {
+      block_sums[blk] = chunk_reduce(first, blk * grain, (blk + 1) * grain, op);
+    }
+  });
+
+  // Turn the block sums into exclusive block prefixes
+  T running = identity;
+  for (size_t blk = 0; blk < num_blocks; ++blk) {
+    T sum = block_sums[blk];
+    block_sums[blk] = running;
+    running = op(running, sum);
+  }
+
+  // Pass 2: scan every block once, seeded with its prefix
+  scheduler.parallel_range(num_blocks, 1, [&](size_t begin, size_t end) {
+    for (size_t blk = begin; blk < end; ++blk) {
+      AMS562_TRACE_CHUNK("scan_stealing/block", blk, grain);
+      seeded_scan(first, d_first, blk * grain, std::min(n, (blk + 1) * grain),
+                  block_sums[blk], op, type);
+    }
+  });
+}
+
+/**
+ * @brief Performs a parallel inclusive scan of an iterator range on a
+ * work-stealing scheduler; d_first may equal first
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_inclusive_scan_stealing(WorkStealingScheduler& scheduler,
+                                      InIt first, InIt last, OutIt d_first,
+                                      size_t grain = kAutoGrain) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_stealing(scheduler, first, last, d_first, std::plus<T>(), T(0),
+                         ScanType::Inclusive, grain);
+}
+
+/**
+ * @brief Performs a parallel inclusive scan of a vector on a work-stealing
+ * scheduler
+ * @param output Resized to the input size; may be the input vector itself
+ */
+template <typename T>
+void parallel_inclusive_scan_stealing(WorkStealingScheduler& scheduler,
+                                      const std::vector<T>& input,
+                                      std::vector<T>& output,
+                                      size_t grain = kAutoGrain) {
+  output.resize(input.size());
+  parallel_inclusive_scan_stealing(scheduler, input.begin(), input.end(),
+                                   output.begin(), grain);
+}
+
+/**
+ * @brief Performs a parallel inclusive scan of a vector on the process-wide
+ * work-stealing scheduler
+ */
+template <typename T>
+void parallel_inclusive_scan_stealing(const std::vector<T>& input,
+                                      std::vector<T>& output,
+                                      size_t grain = kAutoGrain) {
+  parallel_inclusive_scan_stealing(default_work_stealing_scheduler(), input,
+                                   output, grain);
+}
+
+/**
+ * @brief Performs a parallel exclusive scan of an iterator range on a
+ * work-stealing scheduler; d_first may equal first
+ */
+template <typename InIt, typename OutIt, enable_if_random_access_t<InIt> = 0>
+void parallel_exclusive_scan_stealing(WorkStealingScheduler& scheduler,
+                                      InIt first, InIt last, OutIt d_first,
+                                      size_t grain = kAutoGrain) {
+  using T = iter_value_t<InIt>;
+  parallel_scan_stealing(scheduler, first, last, d_first, std::plus<T>(), T(0),
+                         ScanType::Exclusive, grain);
+}
+
+#endif  // STEALING_PRIMITIVES_HPP
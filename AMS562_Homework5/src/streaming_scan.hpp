@@ -0,0 +1,202 @@
+// src/streaming_scan.hpp
+
+#ifndef STREAMING_SCAN_HPP
+#define STREAMING_SCAN_HPP
+
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "auto_tune.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "range_traits.hpp"
+#include "scan_common.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief This header file contains a stateful scanner for inputs that arrive
+ * as a stream of chunks, so that a prefix sum never needs the whole input in
+ * memory. Each chunk is scanned in parallel on a thread pool, and the running
+ * value is carried into the next chunk:
+ *
+ *   StreamingScanner<long> scanner(pool);
+ *   std::vector<long> buffer;
+ *   while (read_chunk(buffer)) {
+ *     buffer = scanner.push(std::move(buffer));  // previous chunk, scanned
+ *     consume(buffer);
+ *   }
+ *   consume(scanner.finish());
+ *
+ * push() starts the scan of its chunk in the background and returns the
+ * chunk pushed before it once that one is scanned, so the next chunk can be
+ * read into the returned storage while the pool scans (double buffering).
+ * At most one chunk is held by the scanner at a time. scan() is the blocking
+ * form for callers that bring their own output storage.
+ *
+ * A scanner is used from one thread at a time, which must not be a worker of
+ * its pool.
+ */
+
+/**
+ * @brief Scans a stream of chunks as one sequence, carrying the running value
+ * between chunks
+ */
+template <typename T, typename BinaryOp = std::plus<T>>
+class StreamingScanner {
+ public:
+  /**
+   * @brief Creates a scanner that runs on the given pool
+   * @param pool The thread pool that scans the chunks
+   * @param type Inclusive or exclusive scan of the whole stream
+   * @param op Associative binary operation
+   * @param identity Identity element of op; the initial running value
+   * @param num_threads Number of chunks each push is split into
+   * (kAutoThreads, the default, lets the auto-tuner choose)
+   * @param mode Scan algorithm (see ScanMode)
+   */
+  explicit StreamingScanner(ThreadPool& pool,
+                            ScanType type = ScanType::Inclusive,
+                            BinaryOp op = BinaryOp(), T identity = T(0),
+                            unsigned int num_threads = kAutoThreads,
+                            ScanMode mode = ScanMode::ScanThenAdd)
+      : pool_(&pool),
+        type_(type),
+        op_(op),
+        identity_(identity),
+        carry_(identity),
+        num_threads_(num_threads),
+        mode_(mode) {}
+
+  /**
+   * @brief Creates a scanner that runs on the process-wide thread pool
+   */
+  explicit StreamingScanner(ScanType type = ScanType::Inclusive,
+                            BinaryOp op = BinaryOp(), T identity = T(0),
+                            unsigned int num_threads = kAutoThreads,
+                            ScanMode mode = ScanMode::ScanThenAdd)
+      : StreamingScanner(default_thread_pool(), type, op, identity,
+                         num_threads, mode) {}
+
+  StreamingScanner(const StreamingScanner&) = delete;
+  StreamingScanner& operator=(const StreamingScanner&) = delete;
+
+  // Waits for the chunk in flight, whose task refers to this scanner
+  ~StreamingScanner() {
+    if (pending_.valid()) pending_.wait();
+  }
+
+  /**
+   * @brief Scans [first, last) as the next part of the stream into d_first
+   * (which may equal first) and waits for it; a pushed chunk still in the
+   * scanner is scanned first and stays there for finish()
+   * @return Iterator past the last element written
+   */
+  template <typename InIt, typename OutIt,
+            enable_if_random_access_t<InIt> = 0>
+  OutIt scan(InIt first, InIt last, OutIt d_first) {
+    wait();
+    carry_ = parallel_seeded_scan_threads(*pool_, first, last, d_first, op_,
+                                          identity_, carry_, type_,
+                                          num_threads_, mode_);
+    elements_ += static_cast<size_t>(last - first);
+    return d_first + (last - first);
+  }
+
+  /**
+   * @brief Scans a chunk in place as the next part of the stream and waits
+   * for it
+   */
+  void scan(std::vector<T>& chunk) {
+    scan(chunk.begin(), chunk.end(), chunk.begin());
+  }
+
+  /**
+   * @brief Starts the in-place scan of chunk as the next part of the stream
+   * and returns without waiting for it
+   * @return The chunk of the previous push, scanned (empty if there is none);
+   * its storage can be reused for the next chunk
+   * @throws Whatever the scan of the previous chunk threw
+   */
+  std::vector<T> push(std::vector<T> chunk) {
+    std::vector<T> previous = finish();
+    if (!chunk.empty()) {
+      elements_ += chunk.size();
+      in_flight_ = std::move(chunk);
+      pending_ = pool_->submit([this]() {
+        carry_ = parallel_seeded_scan_threads(
+            *pool_, in_flight_.begin(), in_flight_.end(), in_flight_.begin(),
+            op_, identity_, carry_, type_, num_threads_, mode_);
+      });
+    }
+    return previous;
+  }
+
+  /**
+   * @brief Waits for the chunk of the last push
+   * @return That chunk, scanned (empty if there is none)
+   * @throws Whatever its scan threw
+   */
+  std::vector<T> finish() {
+    wait();
+    std::vector<T> chunk = std::move(in_flight_);
+    in_flight_ = std::vector<T>();
+    return chunk;
+  }
+
+  /**
+   * @brief Running value after every element pushed or scanned so far (the
+   * seed of the next chunk); waits for the chunk in flight
+   */
+  T carry() {
+    wait();
+    return carry_;
+  }
+
+  /**
+   * @brief Number of elements pushed or scanned so far
+   */
+  size_t size() const { return elements_; }
+
+  /**
+   * @brief Starts a new stream whose running value begins at seed; waits for
+   * the chunk in flight, which is discarded
+   */
+  void reset(T seed) {
+    finish();
+    carry_ = seed;
+    elements_ = 0;
+  }
+
+  /**
+   * @brief Starts a new stream from the identity
+   */
+  void reset() { reset(identity_); }
+
+ private:
+  // Waits for the chunk in flight but leaves it in the scanner for finish();
+  // a chunk whose scan failed is dropped
+  void wait() {
+    if (!pending_.valid()) return;
+    std::future<void> pending = std::move(pending_);
+    try {
+      pending.get();
+    } catch (...) {
+      in_flight_ = std::vector<T>();
+      throw;
+    }
+  }
+
+  ThreadPool* pool_;
+  ScanType type_;
+  BinaryOp op_;
+  T identity_;
+  T carry_;
+  unsigned int num_threads_;
+  ScanMode mode_;
+  size_t elements_ = 0;
+  std::vector<T> in_flight_;
+  std::future<void> pending_;
+};
+
+#endif  // STREAMING_SCAN_HPP
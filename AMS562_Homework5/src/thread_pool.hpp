@@ -0,0 +1,272 @@
+// src/thread_pool.hpp
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief This header file implements a persistent work-stealing thread pool
+ * shared by the threads-based parallel primitives. Worker threads are created
+ * once and reused, so the per-call cost of a parallel operation is a few queue
+ * operations instead of one thread creation per chunk.
+ *
+ * Every worker owns a deque of tasks. A worker pops tasks from the back of its
+ * own deque and, when that is empty, steals from the front of the other
+ * workers' deques.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Creates a pool with the given number of worker threads
+   * @param num_threads Number of worker threads (at least one is created)
+   */
+  explicit ThreadPool(
+      unsigned int num_threads = std::thread::hardware_concurrency())
+      : ThreadPool(num_threads, nullptr) {}
+
+  /**
+   * @brief Creates a pool whose workers run an initialization function first
+   * @param num_threads Number of worker threads (at least one is created)
+   * @param worker_init Called on every worker thread with its index before it
+   * takes tasks, e.g. to pin the thread to a set of CPUs (may be empty)
+   */
+  ThreadPool(unsigned int num_threads,
+             std::function<void(unsigned int)> worker_init)
+      : queues_(std::max(1u, num_threads)) {
+    workers_.reserve(queues_.size());
+    for (unsigned int i = 0; i < queues_.size(); ++i) {
+      workers_.emplace_back([this, i, worker_init]() {
+        if (worker_init) worker_init(i);
+        worker_loop(i);
+      });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Stops the workers after all queued tasks have run
+   */
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief Returns the number of worker threads in the pool
+   */
+  unsigned int size() const { return static_cast<unsigned int>(queues_.size()); }
+
+  /**
+   * @brief Submits a task to the pool
+   * @param f Callable taking no arguments
+   * @return A future holding the result (or exception) of the task
+   */
+  template <typename F>
+  auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using R = std::invoke_result_t<std::decay_t<F>>;
+    auto task =
+        std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+    std::future<R> result = task->get_future();
+    push([task]() { (*task)(); });
+    return result;
+  }
+
+  /**
+   * @brief Runs f(0), ..., f(num_tasks - 1) on the pool and waits for them
+   * @param num_tasks Number of task indices to run
+   * @param f Callable taking the task index
+   *
+   * The calling thread claims task indices as well, so a parallel_for issued
+   * from inside a pool task cannot deadlock, and a single-task call runs
+   * inline. The first exception thrown by a task is rethrown here.
+   */
+  template <typename F>
+  void parallel_for(size_t num_tasks, F&& f) {
+    if (num_tasks == 0) return;
+    if (num_tasks == 1) {
+      f(size_t(0));
+      return;
+    }
+
+    auto state = std::make_shared<ForState>();
+    state->num_tasks = num_tasks;
+    state->body = [&f](size_t i) { f(i); };
+
+    size_t helpers = std::min<size_t>(num_tasks - 1, queues_.size());
+    for (size_t h = 0; h < helpers; ++h) {
+      push([state]() { state->run(); });
+    }
+    state->run();
+
+    // Help with other queued work while the remaining tasks finish
+    while (state->done.load(std::memory_order_acquire) < num_tasks) {
+      if (!run_pending_task()) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&]() {
+          return state->done.load(std::memory_order_acquire) >= num_tasks;
+        });
+      }
+    }
+    if (state->error) std::rethrow_exception(state->error);
+  }
+
+ private:
+  using Task = std::function<void()>;
+
+  struct alignas(64) WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Shared state of one parallel_for call; helper tasks that start late find
+  // no indices left and return, so the state must outlive the call
+  struct ForState {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    size_t num_tasks = 0;
+    std::function<void(size_t)> body;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+
+    void run() {
+      size_t finished = 0;
+      for (size_t i = next.fetch_add(1, std::memory_order_relaxed);
+           i < num_tasks; i = next.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+          body(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) error = std::current_exception();
+        }
+        ++finished;
+      }
+      if (finished == 0) return;
+      if (done.fetch_add(finished, std::memory_order_acq_rel) + finished ==
+          num_tasks) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_all();
+      }
+    }
+  };
+
+  // Index of the current thread's queue if it is a worker of this pool
+  static thread_local const ThreadPool* current_pool_;
+  static thread_local size_t current_index_;
+
+  void push(Task task) {
+    size_t index;
+    if (current_pool_ == this) {
+      index = current_index_;
+    } else {
+      index = next_queue_.fetch_add(1, std::memory_order_relaxed) %
+              queues_.size();
+    }
+    {
+      std::lock_guard<std::mutex> lock(queues_[index].mutex);
+      queues_[index].tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+  }
+
+  // Pops from the back of the own queue, otherwise steals from the front of
+  // another queue
+  bool try_pop(size_t index, Task& task) {
+    {
+      std::lock_guard<std::mutex> lock(queues_[index].mutex);
+      if (!queues_[index].tasks.empty()) {
+        task = std::move(queues_[index].tasks.back());
+        queues_[index].tasks.pop_back();
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    for (size_t k = 1; k < queues_.size(); ++k) {
+      WorkerQueue& victim = queues_[(index + k) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool run_pending_task() {
+    if (pending_.load(std::memory_order_acquire) == 0) return false;
+    size_t index = current_pool_ == this ? current_index_ : 0;
+    Task task;
+    if (!try_pop(index, task)) return false;
+    task();
+    return true;
+  }
+
+  void worker_loop(size_t index) {
+    current_pool_ = this;
+    current_index_ = index;
+    Task task;
+    while (true) {
+      if (try_pop(index, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [&]() {
+        return stop_ || pending_.load(std::memory_order_acquire) > 0;
+      });
+      if (stop_ && pending_.load(std::memory_order_acquire) == 0) return;
+    }
+  }
+
+  std::vector<WorkerQueue> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<size_t> pending_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stop_ = false;
+};
+
+inline thread_local const ThreadPool* ThreadPool::current_pool_ = nullptr;
+inline thread_local size_t ThreadPool::current_index_ = 0;
+
+/**
+ * @brief Returns the process-wide pool used by the threads-based primitives
+ *
+ * The pool has one worker less than the hardware concurrency because the
+ * calling thread takes part in every parallel_for.
+ */
+inline ThreadPool& default_thread_pool() {
+  static ThreadPool pool(
+      std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
+
+#endif  // THREAD_POOL_HPP
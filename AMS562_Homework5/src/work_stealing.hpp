@@ -0,0 +1,478 @@
+// src/work_stealing.hpp
+
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief This header file implements a fork-join task scheduler on lock-free
+ * Chase-Lev work-stealing deques.
+ *
+ * ThreadPool::parallel_for hands out a fixed number of equal chunks, so a
+ * worker that is descheduled (e.g. because other processes share its core)
+ * holds up the whole call. Here work is split recursively instead: a task
+ * spawns the right half of its range and keeps the left half, and idle
+ * workers steal the oldest, i.e. largest, pending pieces. Whichever workers
+ * make progress take over the work of the ones that do not.
+ *
+ *   TaskGroup group(scheduler);
+ *   group.spawn([&]() { left = fib(n - 1); });
+ *   right = fib(n - 2);
+ *   group.sync();  // runs or steals other tasks while it waits
+ *
+ * Every worker owns a ChaseLevDeque: the owner pushes and pops at the bottom
+ * without locks, thieves take from the top with one compare-and-swap. Tasks
+ * spawned by threads outside the scheduler go through a shared injection
+ * queue. A thread waiting in sync() never blocks while there is work it can
+ * run, so nested fork-join cannot deadlock.
+ */
+
+/**
+ * @brief Lock-free single-owner work-stealing deque of trivially copyable
+ * values (Chase and Lev, SPAA 2005, with the C11 memory orders of Le et al.,
+ * PPoPP 2013)
+ *
+ * push() and pop() may only be called by the owner thread; steal() may be
+ * called by any thread. The circular buffer grows when full; the buffers it
+ * outgrows are kept until destruction, since a thief may still read them.
+ */
+template <typename T>
+class ChaseLevDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ChaseLevDeque holds trivially copyable values");
+
+ public:
+  explicit ChaseLevDeque(size_t capacity = 256)
+      : buffer_(new Buffer(std::max<size_t>(2, round_up_pow2(capacity)))) {
+    buffers_.emplace_back(buffer_.load(std::memory_order_relaxed));
+  }
+
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  /**
+   * @brief Pushes a value at the bottom (owner only)
+   */
+  void push(T value) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (b - t >= static_cast<int64_t>(buffer->capacity)) {
+      buffer = grow(buffer, t, b);
+    }
+    buffer->put(b, value);
+    // Release store (rather than a fence) pairs with the acquire load of
+    // bottom_ in steal(), publishing the value with the new bottom
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Pops the most recently pushed value (owner only)
+   * @return Whether a value was taken
+   */
+  bool pop(T& value) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {  // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = buffer->get(b);
+    if (t < b) return true;
+    // Last element: race the thieves for it
+    bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  /**
+   * @brief Takes the oldest value (any thread)
+   * @return Whether a value was taken; false if the deque was empty or
+   * another thread took the value first
+   */
+  bool steal(T& value) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T candidate = buffer->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    value = candidate;
+    return true;
+  }
+
+  /**
+   * @brief Approximate number of values (exact when no thread is operating)
+   */
+  size_t size() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(size_t cap) : capacity(cap), slots(new std::atomic<T>[cap]) {}
+    T get(int64_t i) const {
+      return slots[static_cast<size_t>(i) & (capacity - 1)].load(
+          std::memory_order_relaxed);
+    }
+    void put(int64_t i, T value) {
+      slots[static_cast<size_t>(i) & (capacity - 1)].store(
+          value, std::memory_order_relaxed);
+    }
+    size_t capacity;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  static size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  // Copies the live range into a buffer of twice the capacity (owner only)
+  Buffer* grow(Buffer* old, int64_t t, int64_t b) {
+    Buffer* bigger = new Buffer(old->capacity * 2);
+    for (int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+    buffers_.emplace_back(bigger);
+    buffer_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  alignas(64) std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;  // owner only
+};
+
+class TaskGroup;
+
+/**
+ * @brief Fork-join scheduler whose workers balance load by stealing from
+ * each other's Chase-Lev deques
+ */
+class WorkStealingScheduler {
+ public:
+  /**
+   * @brief Creates a scheduler with the given number of worker threads
+   * @param num_threads Number of worker threads (at least one is created)
+   */
+  explicit WorkStealingScheduler(
+      unsigned int num_threads = std::thread::hardware_concurrency())
+      : workers_(std::max(1u, num_threads)) {
+    for (unsigned int i = 0; i < workers_.size(); ++i) {
+      workers_[i].thread = std::thread([this, i]() { worker_loop(i); });
+    }
+  }
+
+  WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+  WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+  /**
+   * @brief Stops the workers; every task group must have been synced
+   */
+  ~WorkStealingScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_.store(true, std::memory_order_relaxed);
+    }
+    sleep_cv_.notify_all();
+    for (Worker& worker : workers_) worker.thread.join();
+  }
+
+  /**
+   * @brief Returns the number of worker threads
+   */
+  unsigned int size() const {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+  /**
+   * @brief Runs body(begin, end) over subranges that cover [0, n) and waits
+   * for them
+   * @param n Number of indices
+   * @param grain Largest subrange that is not split further (at least 1)
+   * @param body Callable taking the bounds of a subrange
+   *
+   * The range is halved recursively; the calling thread keeps the left half
+   * and spawns the right one, so idle workers steal the largest pieces.
+   */
+  template <typename F>
+  void parallel_range(size_t n, size_t grain, F&& body);
+
+  /**
+   * @brief Number of tasks taken from another worker's deque so far
+   */
+  size_t steal_count() const {
+    return steals_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class TaskGroup;
+
+  // A spawned task; runs once and deletes itself
+  struct Job {
+    virtual ~Job() = default;
+    virtual void execute() = 0;
+  };
+
+  struct Worker {
+    ChaseLevDeque<Job*> deque;
+    std::thread thread;
+    uint64_t rng = 0;
+  };
+
+  // Worker index of the calling thread in this scheduler, or -1
+  int current_index() const {
+    return current_scheduler_ == this ? current_index_ : -1;
+  }
+
+  void schedule(Job* job) {
+    int index = current_index();
+    if (index >= 0) {
+      workers_[index].deque.push(job);
+    } else {
+      std::lock_guard<std::mutex> lock(inject_mutex_);
+      injected_.push_back(job);
+      injected_count_.fetch_add(1, std::memory_order_release);
+    }
+    // Wake a sleeping worker; see worker_loop for the handshake
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.notify_one();
+    }
+  }
+
+  // Takes a job: the own deque first, then other deques, then the injection
+  // queue
+  bool find_job(int index, Job*& job) {
+    if (index >= 0 && workers_[index].deque.pop(job)) return true;
+    const size_t n = workers_.size();
+    size_t start;
+    if (index >= 0) {
+      uint64_t& x = workers_[index].rng;  // xorshift victim selection
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      start = static_cast<size_t>(x % n);
+    } else {
+      start = external_victim_.fetch_add(1, std::memory_order_relaxed) % n;
+    }
+    for (size_t k = 0; k < n; ++k) {
+      size_t victim = (start + k) % n;
+      if (static_cast<int>(victim) == index) continue;
+      if (workers_[victim].deque.steal(job)) {
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    if (injected_count_.load(std::memory_order_acquire) > 0) {
+      std::lock_guard<std::mutex> lock(inject_mutex_);
+      if (!injected_.empty()) {
+        job = injected_.front();
+        injected_.pop_front();
+        injected_count_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Runs one job if there is one; used by threads waiting in TaskGroup::sync
+  bool run_one() {
+    Job* job;
+    if (!find_job(current_index(), job)) return false;
+    job->execute();
+    return true;
+  }
+
+  void worker_loop(unsigned int index) {
+    current_scheduler_ = this;
+    current_index_ = static_cast<int>(index);
+    workers_[index].rng = 0x9E3779B97F4A7C15ull * (index + 1);
+    Job* job;
+    while (true) {
+      uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+      bool found = false;
+      for (int spin = 0; spin < 64 && !found; ++spin) {
+        found = find_job(static_cast<int>(index), job);
+        if (!found) std::this_thread::yield();
+      }
+      if (found) {
+        job->execute();
+        continue;
+      }
+      if (stop_.load(std::memory_order_relaxed)) return;
+
+      // Sleep until a job is scheduled. A scheduler that saw sleepers_ == 0
+      // published its job before this worker's check of epoch_, so either
+      // the check sees the new epoch or the scheduler sees the sleeper.
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      sleep_cv_.wait(lock, [&]() {
+        return stop_.load(std::memory_order_relaxed) ||
+               epoch_.load(std::memory_order_seq_cst) != epoch;
+      });
+      sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  static thread_local const WorkStealingScheduler* current_scheduler_;
+  static thread_local int current_index_;
+
+  std::vector<Worker> workers_;
+  std::mutex inject_mutex_;
+  std::deque<Job*> injected_;
+  std::atomic<size_t> injected_count_{0};
+  std::atomic<size_t> external_victim_{0};
+  std::atomic<size_t> steals_{0};
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<unsigned int> sleepers_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::atomic<bool> stop_{false};
+};
+
+inline thread_local const WorkStealingScheduler*
+    WorkStealingScheduler::current_scheduler_ = nullptr;
+inline thread_local int WorkStealingScheduler::current_index_ = -1;
+
+/**
+ * @brief Set of spawned tasks that a thread waits for with sync()
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(WorkStealingScheduler& scheduler)
+      : scheduler_(&scheduler) {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Waits for the spawned tasks, whose jobs refer to this group
+  ~TaskGroup() {
+    wait();
+  }
+
+  /**
+   * @brief Spawns f() as a task that any worker may run
+   */
+  template <typename F>
+  void spawn(F&& f) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    scheduler_->schedule(new GroupJob<std::decay_t<F>>(this, std::forward<F>(f)));
+  }
+
+  /**
+   * @brief Runs or steals tasks until every task spawned into this group has
+   * finished
+   * @throws The first exception thrown by a task of the group
+   */
+  void sync() {
+    wait();
+    if (error_) {
+      std::exception_ptr error = std::exchange(error_, nullptr);
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  template <typename F>
+  struct GroupJob : WorkStealingScheduler::Job {
+    GroupJob(TaskGroup* group, F f) : group(group), f(std::move(f)) {}
+    void execute() override {
+      TaskGroup* owner = group;
+      try {
+        f();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(owner->error_mutex_);
+        if (!owner->error_) owner->error_ = std::current_exception();
+      }
+      delete this;
+      // Last access to the group: sync() may return as soon as it sees zero
+      owner->pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    TaskGroup* group;
+    F f;
+  };
+
+  void wait() {
+    unsigned int idle = 0;
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      if (scheduler_->run_one()) {
+        idle = 0;
+      } else if (++idle < 1024) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+  }
+
+  WorkStealingScheduler* scheduler_;
+  std::atomic<size_t> pending_{0};
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+template <typename F>
+void WorkStealingScheduler::parallel_range(size_t n, size_t grain, F&& body) {
+  grain = std::max<size_t>(1, grain);
+  if (n <= grain) {
+    if (n > 0) body(size_t(0), n);
+    return;
+  }
+  struct Splitter {
+    WorkStealingScheduler* scheduler;
+    size_t grain;
+    std::remove_reference_t<F>* body;
+    void operator()(size_t begin, size_t end) const {
+      TaskGroup group(*scheduler);
+      while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        Splitter right = *this;
+        group.spawn([right, mid, end]() { right(mid, end); });
+        end = mid;
+      }
+      (*body)(begin, end);
+      group.sync();
+    }
+  };
+  Splitter{this, grain, &body}(0, n);
+}
+
+/**
+ * @brief Returns the process-wide work-stealing scheduler
+ *
+ * Like default_thread_pool(), it has one worker less than the hardware
+ * concurrency because the calling thread helps while it waits.
+ */
+inline WorkStealingScheduler& default_work_stealing_scheduler() {
+  static WorkStealingScheduler scheduler(
+      std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return scheduler;
+}
+
+#endif  // WORK_STEALING_HPP
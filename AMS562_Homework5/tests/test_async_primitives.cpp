@@ -0,0 +1,147 @@
+// tests/test_async_primitives.cpp
+
+// Overview:
+// This file contains unit tests for the C++20 coroutine API: the awaitable
+// inner product and scans must match the blocking primitives, exceptions must
+// reach the awaiting coroutine, AsyncTasks must compose, and the caller must
+// be able to do other work while a result is pending.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "async_primitives.hpp"
+#include "thread_pool.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Coroutine that awaits an inner product and a scan of the same data
+AsyncTask<long long> dot_and_scan(ThreadPool& pool, const std::vector<long long>& a,
+                                  std::vector<long long>& scanned) {
+    AsyncResult<long long> dot = async_inner_product(pool, a, a);
+    AsyncResult<void> scan = async_inclusive_scan(pool, a.begin(), a.end(), scanned.begin());
+    co_await scan;
+    co_return co_await dot;
+}
+
+// Primitives Test
+// This test verifies that the awaitable inner product and scans give the
+// results of the std algorithms, both through co_await and through get().
+TEST(AsyncPrimitivesTest, MatchesStd) {
+    ThreadPool pool(3);
+    std::vector<long long> a(100003);
+    for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<long long>(i % 13) - 6;
+    std::vector<long long> expected_scan(a.size());
+    std::inclusive_scan(a.begin(), a.end(), expected_scan.begin());
+    long long expected_dot = std::inner_product(a.begin(), a.end(), a.begin(), 0LL);
+
+    std::vector<long long> scanned(a.size());
+    EXPECT_EQ(expected_dot, sync_wait(dot_and_scan(pool, a, scanned)));
+    EXPECT_EQ(expected_scan, scanned);
+
+    EXPECT_EQ(expected_dot, async_inner_product(a, a).get());
+    std::vector<long long> in_place = a;
+    async_inclusive_scan(pool, in_place, 4).get();
+    EXPECT_EQ(expected_scan, in_place);
+
+    std::vector<long long> expected_exclusive(a.size());
+    std::exclusive_scan(a.begin(), a.end(), expected_exclusive.begin(), 0LL);
+    async_exclusive_scan(pool, a.begin(), a.end(), scanned.begin()).get();
+    EXPECT_EQ(expected_exclusive, scanned);
+}
+
+// Coroutine that rethrows the exception of an awaited pool task
+AsyncTask<int> await_failure(ThreadPool& pool) {
+    co_return co_await async_run(pool, []() -> int { throw std::runtime_error("failed"); });
+}
+
+// Exceptions Test
+// This test verifies that exceptions thrown on the pool reach the awaiting
+// coroutine and sync_wait, and that a size mismatch is reported immediately.
+TEST(AsyncPrimitivesTest, PropagatesExceptions) {
+    ThreadPool pool(2);
+    EXPECT_THROW(sync_wait(await_failure(pool)), std::runtime_error);
+    AsyncResult<void> failed = async_run(pool, []() { throw std::logic_error("failed"); });
+    EXPECT_THROW(failed.get(), std::logic_error);
+    std::vector<double> a(10), b(3);
+    EXPECT_THROW((void)async_inner_product(pool, a, b), std::invalid_argument);
+}
+
+// Coroutine that sums the inner products of the first count prefixes of v
+AsyncTask<double> prefix_dots(ThreadPool& pool, const std::vector<double>& v, size_t count) {
+    double sum = 0.0;
+    for (size_t k = 1; k <= count; ++k) {
+        sum += co_await async_inner_product(pool, v.begin(), v.begin() + k * 1000, v.begin());
+    }
+    co_return sum;
+}
+
+// Coroutine that awaits two nested tasks
+AsyncTask<double> nested(ThreadPool& pool, const std::vector<double>& v) {
+    double first = co_await prefix_dots(pool, v, 8);
+    double second = co_await prefix_dots(pool, v, 8);
+    co_return first + second;
+}
+
+// Composition Test
+// This test verifies that AsyncTasks can await each other and many pool
+// results in sequence, on pools of one and several workers.
+TEST(AsyncPrimitivesTest, TasksCompose) {
+    std::vector<double> v(8000, 0.5);
+    for (unsigned int workers : {1u, 4u}) {
+        ThreadPool pool(workers);
+        double expected = 0.0;
+        for (size_t k = 1; k <= 8; ++k) expected += 0.25 * static_cast<double>(k * 1000);
+        EXPECT_DOUBLE_EQ(2 * expected, sync_wait(nested(pool, v))) << workers << " workers";
+    }
+}
+
+// Overlap Test
+// This test verifies that the caller keeps running while a result is pending,
+// and compares a blocking inner product followed by other work with the
+// same work overlapped with an asynchronous inner product.
+TEST(AsyncPrimitivesTest, OverlapsOtherWork) {
+    ThreadPool pool(2);
+    std::atomic<bool> release{false};
+    AsyncResult<int> gated = async_run(pool, [&]() {
+        while (!release.load()) std::this_thread::yield();
+        return 7;
+    });
+    EXPECT_FALSE(gated.ready());
+    release.store(true);
+    EXPECT_EQ(7, gated.get());
+
+    std::vector<double> a(1 << 20, 1.0), b(a.size(), 2.0);
+    auto other_work = []() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); };
+    double blocking_sum = 0.0, async_sum = 0.0;
+    double blocking = measure_time([&]() {
+        blocking_sum += parallel_inner_product_threads(pool, a, b);
+        other_work();
+    });
+    double overlapped = measure_time([&]() {
+        AsyncResult<double> dot = async_inner_product(pool, a, b);
+        other_work();
+        async_sum += dot.get();
+    });
+    EXPECT_DOUBLE_EQ(blocking_sum, async_sum);
+
+    std::cout << "\nAverage execution times (ms) over 10 runs (2^20 doubles, 2 ms other work):\n"
+              << "Blocking inner product, then work: " << blocking << " ms\n"
+              << "Async inner product during work:   " << overlapped << " ms\n";
+}
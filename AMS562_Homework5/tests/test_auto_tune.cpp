@@ -0,0 +1,196 @@
+// tests/test_auto_tune.cpp
+
+// Overview:
+// This file contains unit tests for the auto-tuning layer: the cost model,
+// the chunk planning, the persisted profiles, and the primitives running with
+// tuned (kAutoThreads) and forced profiles.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "auto_tune.hpp"
+#include "inner_product_threads.hpp"
+#include "inner_product_openmp.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inclusive_scan_openmp.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Plan Test
+// This test verifies that inputs below the cutoff run serially and that the
+// chunk count follows the grain size, bounded by the number of workers.
+TEST(AutoTuneTest, PlanChunks) {
+    TuningProfile profile{10000, 4096};
+    EXPECT_EQ(1u, plan_chunks(profile, 9999, 8));
+    EXPECT_EQ(2u, plan_chunks(profile, 10000, 8));
+    EXPECT_EQ(8u, plan_chunks(profile, 1 << 20, 8));
+    EXPECT_EQ(1u, plan_chunks(profile, 1 << 20, 1));
+    EXPECT_EQ(1u, plan_chunks(TuningProfile{0, 1 << 20}, 1000, 8));
+}
+
+// Cost Model Test
+// This test verifies the cost model: a single worker never runs in parallel,
+// and a more expensive dispatch raises both the cutoff and the grain size.
+TEST(AutoTuneTest, ModelProfile) {
+    TuningProfile single = model_profile(1e-9, 1e-5, 1);
+    EXPECT_EQ(std::numeric_limits<size_t>::max(), single.serial_cutoff);
+
+    TuningProfile cheap = model_profile(1e-9, 1e-6, 8);
+    TuningProfile expensive = model_profile(1e-9, 1e-4, 8);
+    EXPECT_LT(cheap.serial_cutoff, expensive.serial_cutoff);
+    EXPECT_LE(cheap.grain_size, expensive.grain_size);
+    EXPECT_GE(cheap.grain_size, 1024u);
+    EXPECT_LE(expensive.grain_size, size_t(1) << 22);
+}
+
+// Calibration Test
+// This test verifies that a profile is calibrated once and then served from
+// the table, and that clear() forces a new calibration.
+TEST(AutoTuneTest, CalibratesOnce) {
+    AutoTuner tuner;
+    int calibrations = 0;
+    auto calibrate = [&]() {
+        ++calibrations;
+        return TuningProfile{123, 456};
+    };
+    EXPECT_EQ(123u, tuner.profile("key", calibrate).serial_cutoff);
+    EXPECT_EQ(456u, tuner.profile("key", calibrate).grain_size);
+    EXPECT_EQ(1, calibrations);
+    tuner.clear();
+    EXPECT_FALSE(tuner.contains("key"));
+    tuner.profile("key", calibrate);
+    EXPECT_EQ(2, calibrations);
+}
+
+// Per-Pool Profile Test
+// This test verifies that pools of different sizes are calibrated and cached
+// separately, and that a profile set under the plain key applies to all of
+// them.
+TEST(AutoTuneTest, ProfilesPerPoolSize) {
+    auto_tuner().clear();
+    ThreadPool small(2), large(5);
+    const std::string key = profile_key<float>("inner_product_threads");
+    inner_product_threads_profile<float>(small);
+    EXPECT_TRUE(auto_tuner().contains(worker_profile_key(key, 2)));
+    EXPECT_FALSE(auto_tuner().contains(worker_profile_key(key, 5)));
+    inner_product_threads_profile<float>(large);
+    EXPECT_TRUE(auto_tuner().contains(worker_profile_key(key, 5)));
+
+    // The call-site cache must not hand one pool's profile to the other
+    auto_tuner().set(worker_profile_key(key, 2), {111, 1024});
+    auto_tuner().set(worker_profile_key(key, 5), {555, 2048});
+    EXPECT_EQ(111u, inner_product_threads_profile<float>(small).serial_cutoff);
+    EXPECT_EQ(555u, inner_product_threads_profile<float>(large).serial_cutoff);
+    EXPECT_EQ(111u, inner_product_threads_profile<float>(small).serial_cutoff);
+
+    auto_tuner().set(key, {777, 4096});
+    EXPECT_EQ(777u, inner_product_threads_profile<float>(small).serial_cutoff);
+    EXPECT_EQ(777u, inner_product_threads_profile<float>(large).serial_cutoff);
+    auto_tuner().clear();
+}
+
+// Persistence Test
+// This test verifies that profiles written by save() are restored by a tuner
+// constructed with the same file, which then skips the calibration.
+TEST(AutoTuneTest, PersistedProfileRoundTrip) {
+    std::string path = ::testing::TempDir() + "ams562_tuning_profile.txt";
+    {
+        AutoTuner tuner;
+        tuner.set(profile_key<double>("inner_product_threads"), {5000, 2048});
+        tuner.set(profile_key<int>("scan_openmp"), {7000, 1024});
+        ASSERT_TRUE(tuner.save(path));
+    }
+    AutoTuner restored(path);
+    TuningProfile profile = restored.profile(
+        profile_key<double>("inner_product_threads"), []() {
+            ADD_FAILURE() << "persisted profile was calibrated again";
+            return TuningProfile{};
+        });
+    EXPECT_EQ(5000u, profile.serial_cutoff);
+    EXPECT_EQ(2048u, profile.grain_size);
+    EXPECT_TRUE(restored.contains(profile_key<int>("scan_openmp")));
+    EXPECT_FALSE(restored.load(path + ".missing"));
+    std::remove(path.c_str());
+}
+
+// Forced Profile Test
+// This test verifies that the primitives stay correct whether the tuner picks
+// a serial run or many small chunks.
+TEST(AutoTuneTest, PrimitivesWithForcedProfiles) {
+    std::vector<long long> input(100003);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<long long>(i % 17) - 8;
+    }
+    std::vector<long long> expected(input.size());
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+    long long expected_dot = std::inner_product(input.begin(), input.end(),
+                                                input.begin(), 0LL);
+
+    using Plus = std::plus<long long>;
+    for (TuningProfile forced : {TuningProfile{0, 1024},
+                                 TuningProfile{std::numeric_limits<size_t>::max(), 1024}}) {
+        auto_tuner().set(profile_key<long long, Plus>("scan_threads"), forced);
+        auto_tuner().set(profile_key<long long, Plus>("scan_openmp"), forced);
+        auto_tuner().set(profile_key<long long>("inner_product_threads"), forced);
+        auto_tuner().set(profile_key<long long>("inner_product_openmp"), forced);
+
+        for (ScanMode mode : {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback,
+                              ScanMode::ReduceThenScan}) {
+            std::vector<long long> output;
+            parallel_inclusive_scan_threads(input, output, kAutoThreads, mode);
+            EXPECT_EQ(expected, output);
+            parallel_inclusive_scan_openmp(input, output, mode);
+            EXPECT_EQ(expected, output);
+        }
+        EXPECT_EQ(expected_dot, parallel_inner_product_threads(input, input));
+        EXPECT_EQ(expected_dot, parallel_inner_product_openmp(input, input));
+    }
+    auto_tuner().clear();
+}
+
+// Small Vector Performance Test
+// This test compares the tuned inner product with std::inner_product and with
+// a fixed hardware-concurrency split on a small vector, where the parallel
+// dispatch costs more than it saves.
+TEST(AutoTuneTest, SmallVectorsTiming) {
+    std::vector<double> a(1000, 1.0);
+    std::vector<double> b(1000, 2.0);
+    unsigned int hw = std::max(2u, std::thread::hardware_concurrency());
+    EXPECT_DOUBLE_EQ(2000.0, parallel_inner_product_threads(a, b));
+
+    double std_time = measure_time([&]() {
+        volatile double r = std::inner_product(a.begin(), a.end(), b.begin(), 0.0);
+        (void)r;
+    }, 1000);
+    double tuned_time = measure_time([&]() {
+        volatile double r = parallel_inner_product_threads(a, b);
+        (void)r;
+    }, 1000);
+    double fixed_time = measure_time([&]() {
+        volatile double r = parallel_inner_product_threads(a, b, hw);
+        (void)r;
+    }, 1000);
+
+    std::cout << "Average execution times (ms) over 1000 runs, n = 1000:" << std::endl;
+    std::cout << "std::inner_product: " << std_time << " ms" << std::endl;
+    std::cout << "Auto-tuned threads: " << tuned_time << " ms" << std::endl;
+    std::cout << "Fixed " << hw << " chunks: " << fixed_time << " ms" << std::endl;
+}
@@ -0,0 +1,169 @@
+// tests/test_execution_policy.cpp
+
+// Overview:
+// This file contains unit tests for the policy-dispatched front end: every
+// policy (seq, threads, on(pool), openmp, runtime and the std::execution
+// policies) must give the results of the std algorithms, the policy options
+// must reach the backends, and the runtime backend must follow the
+// AMS562_BACKEND configuration.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "execution_policy.hpp"
+#include "thread_pool.hpp"
+
+namespace ex = ams562::execution;
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Helper that checks both primitives under one policy against std
+template <typename Policy>
+void expect_matches_std(const Policy& policy, const char* name) {
+    std::vector<long long> a(100003), b(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<long long>(i % 13) - 6;
+        b[i] = static_cast<long long>(i % 7);
+    }
+    long long expected_dot = std::inner_product(a.begin(), a.end(), b.begin(), 5LL);
+    EXPECT_EQ(expected_dot, ams562::inner_product(policy, a.begin(), a.end(), b.begin(), 5LL))
+        << name;
+    EXPECT_EQ(expected_dot - 5, ams562::inner_product(policy, a, b)) << name;
+
+    std::vector<long long> expected_scan(a.size());
+    std::inclusive_scan(a.begin(), a.end(), expected_scan.begin());
+    std::vector<long long> out(a.size());
+    auto end = ams562::inclusive_scan(policy, a.begin(), a.end(), out.begin());
+    EXPECT_EQ(out.end(), end) << name;
+    EXPECT_EQ(expected_scan, out) << name;
+
+    std::vector<long long> resized;
+    ams562::inclusive_scan(policy, a, resized);
+    EXPECT_EQ(expected_scan, resized) << name;
+    std::vector<long long> in_place = a;
+    ams562::inclusive_scan(policy, in_place);
+    EXPECT_EQ(expected_scan, in_place) << name;
+}
+
+// Policies Test
+// This test verifies that every policy dispatches to a backend that matches
+// std::inner_product and std::inclusive_scan.
+TEST(ExecutionPolicyTest, EveryPolicyMatchesStd) {
+    ThreadPool pool(3);
+    expect_matches_std(ex::seq, "seq");
+    expect_matches_std(ex::threads, "threads");
+    expect_matches_std(ex::threads.with_threads(5), "threads(5)");
+    expect_matches_std(ex::on(pool).with_threads(4), "on(pool)");
+    expect_matches_std(ex::openmp, "openmp");
+    expect_matches_std(ex::stealing, "stealing");
+    expect_matches_std(ex::runtime, "runtime");
+    expect_matches_std(ex::threads.with_mode(ScanMode::DecoupledLookback), "lookback");
+#if __cpp_lib_execution
+    expect_matches_std(std::execution::seq, "std::execution::seq");
+    expect_matches_std(std::execution::par, "std::execution::par");
+#endif
+}
+
+// Options Test
+// This test verifies that the accumulation mode of a policy reaches every
+// backend: the reproducible mode gives bitwise identical sums.
+TEST(ExecutionPolicyTest, AccumulationModeReachesBackends) {
+    std::vector<double> a(50000), b(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = 1.0 / static_cast<double>(i + 1);
+        b[i] = (i % 2 == 0 ? 1.0 : -1.0) * 1e8 / static_cast<double>(i % 97 + 1);
+    }
+    auto reproducible = [&](const auto& policy) {
+        return ams562::inner_product(policy.with_mode(AccumulationMode::Reproducible), a, b);
+    };
+    double golden = reproducible(ex::seq);
+    EXPECT_EQ(golden, reproducible(ex::threads.with_threads(3)));
+    EXPECT_EQ(golden, reproducible(ex::threads.with_threads(8)));
+    EXPECT_EQ(golden, reproducible(ex::openmp));
+    EXPECT_EQ(golden, reproducible(ex::stealing));
+    EXPECT_EQ(golden, parallel_inner_product_threads(a, b, 2, AccumulationMode::Reproducible));
+    EXPECT_EQ(parallel_inner_product_threads(a, b, 1, AccumulationMode::Compensated),
+              ams562::inner_product(ex::seq.with_mode(AccumulationMode::Compensated), a, b));
+}
+
+// Init Type Test
+// This test verifies that every backend accumulates in the element type and
+// adds init at the end, also when init has a different type.
+TEST(ExecutionPolicyTest, InitTypeDoesNotDependOnBackend) {
+    ThreadPool pool(2);
+    std::vector<double> a{0.5, 0.5, 0.5, 0.5}, b{1.0, 1.0, 1.0, 1.0};
+    EXPECT_EQ(2, ams562::inner_product(ex::seq, a.begin(), a.end(), b.begin(), 0));
+    EXPECT_EQ(2, ams562::inner_product(ex::threads, a.begin(), a.end(), b.begin(), 0));
+    EXPECT_EQ(2, ams562::inner_product(ex::on(pool), a.begin(), a.end(), b.begin(), 0));
+    EXPECT_EQ(2, ams562::inner_product(ex::openmp, a.begin(), a.end(), b.begin(), 0));
+    EXPECT_EQ(2, ams562::inner_product(ex::stealing, a.begin(), a.end(), b.begin(), 0));
+    EXPECT_EQ(3, ams562::inner_product(ex::seq.with_mode(AccumulationMode::Compensated),
+                                       a.begin(), a.end(), b.begin(), 1));
+}
+
+// Runtime Backend Test
+// This test verifies backend name parsing, the AMS562_BACKEND variable and the
+// runtime override, and that a pool policy without a pool is rejected.
+TEST(ExecutionPolicyTest, RuntimeBackendConfiguration) {
+    EXPECT_EQ(ex::Backend::Sequential, ex::parse_backend("seq"));
+    EXPECT_EQ(ex::Backend::OpenMP, ex::parse_backend("omp"));
+    EXPECT_EQ(ex::Backend::Stealing, ex::parse_backend("stealing"));
+    EXPECT_EQ(ex::Backend::Threads, ex::parse_backend(ex::backend_name(ex::Backend::Threads)));
+    EXPECT_FALSE(ex::parse_backend("cuda").has_value());
+
+    setenv("AMS562_BACKEND", "openmp", 1);
+    EXPECT_EQ(ex::Backend::OpenMP, ex::backend_from_env());
+    setenv("AMS562_BACKEND", "bogus", 1);
+    EXPECT_EQ(ex::Backend::Threads, ex::backend_from_env());
+    unsetenv("AMS562_BACKEND");
+    EXPECT_EQ(ex::Backend::Threads, ex::backend_from_env());
+
+    ex::Backend saved = ex::runtime_backend();
+    for (ex::Backend backend : {ex::Backend::Sequential, ex::Backend::OpenMP,
+                                ex::Backend::Stealing, ex::Backend::Threads}) {
+        ex::set_runtime_backend(backend);
+        EXPECT_EQ(backend, ex::resolve(ex::runtime).backend);
+        expect_matches_std(ex::runtime, ex::backend_name(backend));
+    }
+    ex::set_runtime_backend(saved);
+
+    std::vector<int> v(10, 1);
+    EXPECT_THROW(ams562::inner_product(ex::PoolPolicy(), v, v), std::invalid_argument);
+    EXPECT_THROW(ams562::inner_product(ex::seq, v, std::vector<int>(3)), std::invalid_argument);
+}
+
+// Dispatch Overhead Test
+// This test compares a policy call with a direct backend call on a small
+// input, where the dispatch overhead would show.
+TEST(ExecutionPolicyTest, DispatchOverhead) {
+    std::vector<double> a(1000, 1.0), b(1000, 2.0);
+    double direct_sum = 0.0, policy_sum = 0.0;
+    double direct = measure_time([&]() {
+        for (int i = 0; i < 1000; ++i) direct_sum += parallel_inner_product_threads(a, b);
+    });
+    double policy = measure_time([&]() {
+        for (int i = 0; i < 1000; ++i) policy_sum += ams562::inner_product(ex::runtime, a, b);
+    });
+    EXPECT_DOUBLE_EQ(direct_sum, policy_sum);
+
+    std::cout << "\nAverage execution times (ms) of 1000 calls over 10 runs:\n"
+              << "Direct threads call: " << direct << " ms\n"
+              << "Runtime policy call (" << ex::backend_name(ex::runtime_backend())
+              << "): " << policy << " ms\n";
+}
@@ -5,6 +5,9 @@
 #include <numeric>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 
 #include "inclusive_scan_threads.hpp"
 #include "inclusive_scan_openmp.hpp"
@@ -106,3 +109,317 @@ TEST(InclusiveScanTest, LargeVectorsTestOpenMP) {
             << "Standard inclusive_scan: " << std_time << "\n"
             << "OpenMP: " << openmp_time << "\n";
 }
+
+// Test case: Verifies the single-pass decoupled look-back scan of both
+// backends against std::inclusive_scan for sizes that do not divide evenly
+// into blocks and for several thread counts
+TEST(InclusiveScanTest, CorrectnessTestDecoupledLookback) {
+  for (size_t n : {size_t(1), size_t(1000), size_t(100003), size_t(1000003)}) {
+    std::vector<long long> input(n);
+    for (size_t i = 0; i < n; ++i) {
+      input[i] = static_cast<long long>(i % 13) - 5;
+    }
+    std::vector<long long> expected(n);
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+    for (unsigned int threads : {1u, 3u, 8u}) {
+      std::vector<long long> output_threads;
+      parallel_inclusive_scan_threads(input, output_threads, threads,
+                                      ScanMode::DecoupledLookback);
+      EXPECT_EQ(expected, output_threads) << "n = " << n << ", threads = " << threads;
+    }
+
+    std::vector<long long> output_openmp;
+    parallel_inclusive_scan_openmp(input, output_openmp,
+                                   ScanMode::DecoupledLookback);
+    EXPECT_EQ(expected, output_openmp) << "n = " << n;
+  }
+}
+
+// Test case: Verifies the reduce-then-scan mode of both backends, including
+// inputs where ceiling division would leave trailing chunks empty
+TEST(InclusiveScanTest, CorrectnessTestReduceThenScan) {
+  for (size_t n : {size_t(1), size_t(5), size_t(1000), size_t(100003)}) {
+    std::vector<long long> input(n);
+    for (size_t i = 0; i < n; ++i) {
+      input[i] = static_cast<long long>(i % 11) - 4;
+    }
+    std::vector<long long> expected(n);
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+    for (unsigned int threads : {1u, 4u, 7u}) {
+      std::vector<long long> output_threads;
+      parallel_inclusive_scan_threads(input, output_threads, threads,
+                                      ScanMode::ReduceThenScan);
+      EXPECT_EQ(expected, output_threads) << "n = " << n << ", threads = " << threads;
+
+      parallel_inclusive_scan_threads(input, output_threads, threads);
+      EXPECT_EQ(expected, output_threads) << "n = " << n << ", threads = " << threads;
+    }
+
+    std::vector<long long> output_openmp;
+    parallel_inclusive_scan_openmp(input, output_openmp,
+                                   ScanMode::ReduceThenScan);
+    EXPECT_EQ(expected, output_openmp) << "n = " << n;
+  }
+}
+
+// Test case: Verifies the exclusive scans of both backends and every scan
+// mode against std::exclusive_scan
+TEST(InclusiveScanTest, CorrectnessTestExclusiveScan) {
+  const ScanMode modes[] = {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback,
+                            ScanMode::ReduceThenScan};
+  for (size_t n : {size_t(1), size_t(5), size_t(1000), size_t(100003)}) {
+    std::vector<long long> input(n);
+    for (size_t i = 0; i < n; ++i) {
+      input[i] = static_cast<long long>(i % 7) - 2;
+    }
+    std::vector<long long> expected(n);
+    std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0LL);
+
+    for (ScanMode mode : modes) {
+      for (unsigned int threads : {1u, 4u}) {
+        std::vector<long long> output_threads;
+        parallel_exclusive_scan_threads(input, output_threads, threads, mode);
+        EXPECT_EQ(expected, output_threads) << "n = " << n << ", threads = " << threads;
+      }
+      std::vector<long long> output_openmp;
+      parallel_exclusive_scan_openmp(input, output_openmp, mode);
+      EXPECT_EQ(expected, output_openmp) << "n = " << n;
+    }
+  }
+}
+
+// Affine map x -> a * x + b; composition is associative but not commutative
+struct Affine {
+  long long a = 1;
+  long long b = 0;
+  bool operator==(const Affine& other) const {
+    return a == other.a && b == other.b;
+  }
+};
+
+// Applies f, then g
+struct ComposeAffine {
+  Affine operator()(const Affine& f, const Affine& g) const {
+    return {g.a * f.a, g.a * f.b + g.b};
+  }
+};
+
+// Test case: Verifies max/min scans and a non-commutative operation, so that
+// partial results must be combined in order, for every scan mode
+TEST(InclusiveScanTest, CorrectnessTestCustomOperations) {
+  const ScanMode modes[] = {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback,
+                            ScanMode::ReduceThenScan};
+  size_t n = 100003;
+  std::vector<int> input(n);
+  std::vector<Affine> maps(n);
+  for (size_t i = 0; i < n; ++i) {
+    input[i] = static_cast<int>((i * 7919) % 100003) - 50000;
+    maps[i] = {(i % 3 == 0) ? -1 : 1, static_cast<long long>(i % 5)};
+  }
+  std::vector<int> expected_max(n), expected_min(n);
+  std::inclusive_scan(input.begin(), input.end(), expected_max.begin(),
+                      scan_maximum());
+  std::inclusive_scan(input.begin(), input.end(), expected_min.begin(),
+                      scan_minimum());
+  std::vector<Affine> expected_maps(n);
+  std::inclusive_scan(maps.begin(), maps.end(), expected_maps.begin(),
+                      ComposeAffine());
+
+  for (ScanMode mode : modes) {
+    std::vector<int> output;
+    parallel_scan_threads(input, output, scan_maximum(),
+                          std::numeric_limits<int>::lowest(),
+                          ScanType::Inclusive, 4, mode);
+    EXPECT_EQ(expected_max, output);
+    parallel_scan_openmp(input, output, scan_minimum(),
+                         std::numeric_limits<int>::max(), ScanType::Inclusive,
+                         mode);
+    EXPECT_EQ(expected_min, output);
+
+    std::vector<Affine> output_maps;
+    parallel_scan_threads(maps, output_maps, ComposeAffine(), Affine(),
+                          ScanType::Inclusive, 4, mode);
+    EXPECT_TRUE(expected_maps == output_maps);
+    parallel_scan_openmp(maps, output_maps, ComposeAffine(), Affine(),
+                         ScanType::Inclusive, mode);
+    EXPECT_TRUE(expected_maps == output_maps);
+  }
+}
+
+// Test case: Verifies the segmented scans of both backends against a serial
+// reference, with segment heads that fall on and between chunk boundaries
+TEST(InclusiveScanTest, CorrectnessTestSegmentedScan) {
+  for (size_t n : {size_t(1), size_t(8), size_t(1000), size_t(100003)}) {
+    std::vector<long long> input(n);
+    std::vector<unsigned char> flags(n);
+    for (size_t i = 0; i < n; ++i) {
+      input[i] = static_cast<long long>(i % 9) - 3;
+      flags[i] = (i % 97 == 0) || (i % 250 == 0);
+    }
+    std::vector<long long> expected(n);
+    long long running = 0;
+    for (size_t i = 0; i < n; ++i) {
+      running = flags[i] ? input[i] : running + input[i];
+      expected[i] = running;
+    }
+
+    for (unsigned int threads : {1u, 4u, 8u}) {
+      std::vector<long long> output_threads;
+      parallel_segmented_scan_threads(input, flags, output_threads,
+                                      std::plus<long long>(), 0LL, threads);
+      EXPECT_EQ(expected, output_threads) << "n = " << n << ", threads = " << threads;
+    }
+    std::vector<long long> output_openmp;
+    parallel_segmented_scan_openmp(input, flags, output_openmp,
+                                   std::plus<long long>(), 0LL);
+    EXPECT_EQ(expected, output_openmp) << "n = " << n;
+  }
+
+  // No segment head at all behaves like a plain inclusive scan
+  std::vector<int> ones(10000, 1);
+  std::vector<int> no_flags(ones.size(), 0);
+  std::vector<int> output;
+  parallel_segmented_scan_threads(ones, no_flags, output, std::plus<int>(), 0,
+                                  4);
+  EXPECT_EQ(10000, output.back());
+
+  std::vector<int> short_flags(ones.size() - 1, 0);
+  EXPECT_THROW(parallel_segmented_scan_threads(ones, short_flags, output,
+                                               std::plus<int>(), 0),
+               std::invalid_argument);
+}
+
+// Test case: Verifies the iterator-range overloads on a sub-range of a
+// vector, on raw pointers into a plain buffer and in place, for every mode
+TEST(InclusiveScanTest, CorrectnessTestIteratorRanges) {
+  const ScanMode modes[] = {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback,
+                            ScanMode::ReduceThenScan};
+  size_t n = 100003;
+  std::vector<int> input(n);
+  for (size_t i = 0; i < n; ++i) {
+    input[i] = static_cast<int>(i % 10) - 4;
+  }
+  std::vector<int> expected(n), expected_exclusive(n);
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+  std::exclusive_scan(input.begin(), input.end(), expected_exclusive.begin(), 0);
+
+  for (ScanMode mode : modes) {
+    // Sub-range through vector iterators into a larger, pre-sized output
+    std::vector<int> output(n + 2, -7);
+    parallel_inclusive_scan_threads(input.begin(), input.end(),
+                                    output.begin() + 1, 4, mode);
+    EXPECT_EQ(-7, output.front());
+    EXPECT_EQ(-7, output.back());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), output.begin() + 1));
+
+    // Raw pointers into a buffer that is not a std::vector
+    std::unique_ptr<int[]> buffer(new int[n]);
+    parallel_exclusive_scan_openmp(input.data(), input.data() + n,
+                                   buffer.get(), mode);
+    EXPECT_TRUE(std::equal(expected_exclusive.begin(), expected_exclusive.end(),
+                           buffer.get()));
+
+    // In place, through the vector, iterator and pointer interfaces
+    std::vector<int> data = input;
+    parallel_inclusive_scan_threads(data, 4, mode);
+    EXPECT_EQ(expected, data);
+
+    data = input;
+    parallel_exclusive_scan_threads(data.begin(), data.end(), data.begin(), 3,
+                                    mode);
+    EXPECT_EQ(expected_exclusive, data);
+
+    data = input;
+    parallel_inclusive_scan_openmp(data.data(), data.data() + n, data.data(),
+                                   mode);
+    EXPECT_EQ(expected, data);
+
+    data = input;
+    parallel_exclusive_scan_openmp(data, mode);
+    EXPECT_EQ(expected_exclusive, data);
+  }
+
+#ifdef __cpp_lib_span
+  std::vector<int> span_output(n);
+  parallel_inclusive_scan_threads(std::span<const int>(input),
+                                  std::span<int>(span_output));
+  EXPECT_EQ(expected, span_output);
+  parallel_exclusive_scan_openmp(std::span<int>(span_output),
+                                 std::span<int>(span_output));
+  std::vector<int> expected_twice(n);
+  std::exclusive_scan(expected.begin(), expected.end(),
+                      expected_twice.begin(), 0);
+  EXPECT_EQ(expected_twice, span_output);
+#endif
+}
+
+// Test case: Compares the in-place scan with the out-of-place scan on a large
+// vector (16M elements); the in-place scan touches half the memory
+TEST(InclusiveScanTest, LargeVectorsTestInPlace) {
+  size_t n = 1 << 24;
+  std::vector<int> input(n, 1);
+  std::vector<int> output(n);
+  std::vector<int> data(n, 1);
+
+  double out_of_place = measure_time(
+      [&]() { parallel_inclusive_scan_threads(input, output); });
+  double in_place = measure_time([&]() {
+    std::fill(data.begin(), data.end(), 1);
+    parallel_inclusive_scan_threads(data.begin(), data.end(), data.begin());
+  });
+  std::fill(data.begin(), data.end(), 1);
+  parallel_inclusive_scan_threads(data);
+
+  EXPECT_EQ(output, data);
+  std::cout << "Out-of-place scan time: " << out_of_place << " ms" << std::endl;
+  std::cout << "In-place scan time (incl. refill): " << in_place << " ms"
+            << std::endl;
+}
+
+// Test case: Compares the two-pass scan-then-add algorithm with the
+// single-pass decoupled look-back and reduce-then-scan algorithms on a large
+// vector (16M elements)
+TEST(InclusiveScanTest, LargeVectorsTestScanModes) {
+  size_t n = 1 << 24;
+  std::vector<int> input(n, 1);
+  std::vector<int> expected(n);
+  std::vector<int> output(n);
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+  double two_pass_threads = measure_time(
+      [&]() { parallel_inclusive_scan_threads(input, output); });
+  double single_pass_threads = measure_time([&]() {
+    parallel_inclusive_scan_threads(input, output,
+                                    std::thread::hardware_concurrency(),
+                                    ScanMode::DecoupledLookback);
+  });
+  EXPECT_EQ(expected, output);
+  double reduce_then_scan_threads = measure_time([&]() {
+    parallel_inclusive_scan_threads(input, output,
+                                    std::thread::hardware_concurrency(),
+                                    ScanMode::ReduceThenScan);
+  });
+  EXPECT_EQ(expected, output);
+
+  double two_pass_openmp = measure_time(
+      [&]() { parallel_inclusive_scan_openmp(input, output); });
+  double single_pass_openmp = measure_time([&]() {
+    parallel_inclusive_scan_openmp(input, output, ScanMode::DecoupledLookback);
+  });
+  EXPECT_EQ(expected, output);
+  double reduce_then_scan_openmp = measure_time([&]() {
+    parallel_inclusive_scan_openmp(input, output, ScanMode::ReduceThenScan);
+  });
+  EXPECT_EQ(expected, output);
+
+  // Print timing results
+  std::cout << "\nAverage execution times (ms) over 10 runs, n = " << n << ":\n"
+            << "Threads scan-then-add: " << two_pass_threads << "\n"
+            << "Threads decoupled look-back: " << single_pass_threads << "\n"
+            << "Threads reduce-then-scan: " << reduce_then_scan_threads << "\n"
+            << "OpenMP scan-then-add: " << two_pass_openmp << "\n"
+            << "OpenMP decoupled look-back: " << single_pass_openmp << "\n"
+            << "OpenMP reduce-then-scan: " << reduce_then_scan_openmp << "\n";
+}
@@ -7,8 +7,12 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include <numeric>
+#include <cmath>
+#include <utility>
 #include <chrono>
 #include <iostream>
+#include <random>
+#include <cstdint>
 
 #include "inner_product_threads.hpp"
 #include "inner_product_openmp.hpp"
@@ -51,6 +55,45 @@ TEST(InnerProductTest, CorrectnessTest_OpenMP) {
     EXPECT_DOUBLE_EQ(expected, result_openmp);
 }
 
+// Small Vectors Test for Threads
+// This test verifies inputs with fewer elements per chunk than threads, where
+// ceiling division would otherwise produce chunks past the end of the input.
+TEST(InnerProductTest, SmallVectorsTest_Threads) {
+    for (size_t n : {0, 1, 5, 9}) {
+        std::vector<double> a(n, 1.0);
+        std::vector<double> b(n, 3.0);
+        for (unsigned int threads : {1u, 4u, 8u}) {
+            EXPECT_DOUBLE_EQ(3.0 * n, parallel_inner_product_threads(a, b, threads));
+        }
+    }
+}
+
+// Test case: Verifies the iterator-range overloads of both backends on
+// sub-ranges of vectors and on raw pointers
+TEST(InnerProductTest, IteratorRangeTest) {
+    std::vector<long long> a(10001), b(10001);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<long long>(i % 7);
+        b[i] = static_cast<long long>(i % 5) - 2;
+    }
+    long long expected = std::inner_product(a.begin() + 1, a.end(),
+                                            b.begin(), 0LL);
+    for (unsigned int threads : {1u, 3u, 8u}) {
+        EXPECT_EQ(expected, parallel_inner_product_threads(
+                                a.begin() + 1, a.end(), b.begin(), threads));
+    }
+    EXPECT_EQ(expected, parallel_inner_product_openmp(
+                            a.data() + 1, a.data() + a.size(), b.data()));
+    EXPECT_EQ(0LL, parallel_inner_product_threads(a.data(), a.data(), b.data()));
+
+#ifdef __cpp_lib_span
+    std::span<const long long> sa(a.data() + 1, a.size() - 1);
+    std::span<const long long> sb(b.data(), b.size() - 1);
+    EXPECT_EQ(expected, parallel_inner_product_threads(sa, sb));
+    EXPECT_EQ(expected, parallel_inner_product_openmp(sa, sb));
+#endif
+}
+
 // Large Vectors Test for Threads
 // This test evaluates the performance of parallel_inner_product_threads with large vectors
 // and ensures the result is correct.
@@ -106,3 +149,374 @@ TEST(InnerProductTest, LargeVectorsTest_OpenMP) {
                 << "Standard inner_product: " << std_time << " ms\n"
                 << "Parallel OpenMP: " << openmp_time << " ms\n";
 }
+
+// Fused Inner Product Test
+// This test verifies that several inner products sharing one operand match the
+// separate inner products, for every chunk count and both backends.
+TEST(InnerProductTest, FusedTest) {
+    std::vector<long long> a(100003), b(a.size()), c(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<long long>(i % 7) - 3;
+        b[i] = static_cast<long long>(i % 5);
+        c[i] = static_cast<long long>(i % 11) - 5;
+    }
+    std::vector<long long> expected = {
+        std::inner_product(a.begin(), a.end(), b.begin(), 0LL),
+        std::inner_product(a.begin(), a.end(), c.begin(), 0LL),
+        std::inner_product(a.begin(), a.end(), a.begin(), 0LL)};
+
+    for (unsigned int threads : {kAutoThreads, 1u, 3u, 8u}) {
+        EXPECT_EQ(expected, parallel_fused_inner_product_threads(a, {&b, &c, &a}, threads));
+    }
+    EXPECT_EQ(expected, parallel_fused_inner_product_openmp(a, {&b, &c, &a}));
+
+    std::vector<const long long*> operands = {b.data(), c.data(), a.data()};
+    EXPECT_EQ(expected, parallel_fused_inner_product_threads(
+                            a.data(), a.data() + a.size(), operands));
+    EXPECT_TRUE(parallel_fused_inner_product_threads(a, {}).empty());
+
+    std::vector<long long> shorter(a.size() - 1);
+    EXPECT_THROW(parallel_fused_inner_product_threads(a, {&b, &shorter}),
+                 std::invalid_argument);
+    EXPECT_THROW(parallel_fused_inner_product_openmp(a, {&shorter}),
+                 std::invalid_argument);
+}
+
+// Batched Inner Product Test
+// This test verifies the inner products of a batch of pairs of very different
+// sizes, including empty pairs and an empty batch.
+TEST(InnerProductTest, BatchedTest) {
+    std::vector<std::vector<long long>> a, b;
+    std::vector<long long> expected;
+    for (size_t i = 0; i < 500; ++i) {
+        size_t size = (i % 50 == 0) ? 20000 : i % 13;
+        a.emplace_back(size);
+        b.emplace_back(size);
+        for (size_t j = 0; j < size; ++j) {
+            a.back()[j] = static_cast<long long>((i + j) % 7);
+            b.back()[j] = static_cast<long long>(j % 5) - 2;
+        }
+        expected.push_back(std::inner_product(a.back().begin(), a.back().end(),
+                                              b.back().begin(), 0LL));
+    }
+
+    for (unsigned int threads : {kAutoThreads, 1u, 3u, 8u, 1000u}) {
+        EXPECT_EQ(expected, parallel_batched_inner_product_threads(a, b, threads));
+    }
+    EXPECT_EQ(expected, parallel_batched_inner_product_openmp(a, b));
+
+    std::vector<std::vector<long long>> none;
+    EXPECT_TRUE(parallel_batched_inner_product_threads(none, none, 4).empty());
+    EXPECT_TRUE(parallel_batched_inner_product_openmp(none, none).empty());
+
+    b.pop_back();
+    EXPECT_THROW(parallel_batched_inner_product_threads(a, b), std::invalid_argument);
+    b.emplace_back(1);
+    EXPECT_THROW(parallel_batched_inner_product_openmp(a, b), std::invalid_argument);
+}
+
+// Fused Inner Product Performance Test
+// This test compares a . b, a . c and a . a computed by three separate calls
+// with one fused call, which streams a once instead of three times.
+TEST(InnerProductTest, FusedVectorsTiming) {
+    size_t n = 1 << 22;
+    std::vector<double> a(n, 1.0), b(n, 2.0), c(n, 3.0);
+    std::vector<double> separate(3), fused;
+
+    double separate_threads = measure_time([&]() {
+        separate[0] = parallel_inner_product_threads(a, b);
+        separate[1] = parallel_inner_product_threads(a, c);
+        separate[2] = parallel_inner_product_threads(a, a);
+    });
+    double fused_threads = measure_time([&]() {
+        fused = parallel_fused_inner_product_threads(a, {&b, &c, &a});
+    });
+    EXPECT_EQ(separate, fused);
+
+    double separate_openmp = measure_time([&]() {
+        separate[0] = parallel_inner_product_openmp(a, b);
+        separate[1] = parallel_inner_product_openmp(a, c);
+        separate[2] = parallel_inner_product_openmp(a, a);
+    });
+    double fused_openmp = measure_time([&]() {
+        fused = parallel_fused_inner_product_openmp(a, {&b, &c, &a});
+    });
+    EXPECT_EQ(separate, fused);
+
+    // Many small pairs: one call per pair against one batched call
+    std::vector<std::vector<double>> xs(20000, std::vector<double>(64, 1.0));
+    std::vector<std::vector<double>> ys(20000, std::vector<double>(64, 0.5));
+    std::vector<double> batched;
+    double per_pair = measure_time([&]() {
+        batched.resize(xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) {
+            batched[i] = parallel_inner_product_threads(xs[i], ys[i]);
+        }
+    });
+    double batched_time = measure_time([&]() {
+        batched = parallel_batched_inner_product_threads(xs, ys);
+    });
+    EXPECT_DOUBLE_EQ(32.0, batched.back());
+
+    std::cout << "\nAverage execution times (ms) over 10 runs, n = " << n << ":\n"
+              << "Threads, 3 separate calls: " << separate_threads << " ms\n"
+              << "Threads, fused: " << fused_threads << " ms\n"
+              << "OpenMP, 3 separate calls: " << separate_openmp << " ms\n"
+              << "OpenMP, fused: " << fused_openmp << " ms\n"
+              << "20000 pairs of 64, one call each: " << per_pair << " ms\n"
+              << "20000 pairs of 64, batched: " << batched_time << " ms\n";
+}
+
+// Reproducible Mode Test
+// This test verifies that AccumulationMode::Reproducible gives bitwise
+// identical results for every thread count and for both backends.
+TEST(InnerProductTest, ReproducibleModeTest) {
+    std::mt19937 gen(562);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-20, 20);
+    std::vector<double> a(1000003), b(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = std::ldexp(mantissa(gen), exponent(gen));
+        b[i] = std::ldexp(mantissa(gen), exponent(gen));
+    }
+
+    const AccumulationMode mode = AccumulationMode::Reproducible;
+    double reference = parallel_inner_product_threads(a, b, 1, mode);
+    for (unsigned int threads : {kAutoThreads, 2u, 3u, 5u, 8u, 64u}) {
+        EXPECT_EQ(reference, parallel_inner_product_threads(a, b, threads, mode));
+    }
+
+    // Force the OpenMP version to split the input for every thread count
+    int max_threads = omp_get_max_threads();
+    auto_tuner().set(profile_key<double>("inner_product_openmp"), {0, 1024});
+    for (int threads : {1, 2, 3, 4}) {
+        omp_set_num_threads(threads);
+        EXPECT_EQ(reference, parallel_inner_product_openmp(a, b, mode));
+    }
+    omp_set_num_threads(max_threads);
+    auto_tuner().clear();
+
+    std::vector<long long> x(10001, 3), y(10001, -2);
+    for (AccumulationMode m : {AccumulationMode::Fast, AccumulationMode::Compensated,
+                               AccumulationMode::Reproducible}) {
+        EXPECT_EQ(-60006LL, parallel_inner_product_threads(x, y, 4, m));
+        EXPECT_EQ(-60006LL, parallel_inner_product_openmp(x, y, m));
+    }
+    std::vector<double> empty;
+    EXPECT_EQ(0.0, parallel_inner_product_threads(empty, empty, 4, mode));
+}
+
+// Compensated Mode Test
+// This test verifies that AccumulationMode::Compensated recovers the small
+// terms that a plain sum loses next to large ones.
+TEST(InnerProductTest, CompensatedModeTest) {
+    std::vector<double> a(100000), b(a.size(), 1.0);
+    for (size_t i = 0; i < a.size(); i += 4) {
+        a[i] = 1e16;
+        a[i + 1] = 1.0;
+        a[i + 2] = -1e16;
+        a[i + 3] = 1.0;
+    }
+    const double exact = 50000.0;
+    EXPECT_NE(exact, parallel_inner_product_threads(a, b, 1));
+
+    const AccumulationMode mode = AccumulationMode::Compensated;
+    for (unsigned int threads : {kAutoThreads, 1u, 3u, 8u}) {
+        EXPECT_EQ(exact, parallel_inner_product_threads(a, b, threads, mode));
+    }
+    EXPECT_EQ(exact, parallel_inner_product_openmp(a, b, mode));
+}
+
+// Accumulation Mode Performance Test
+// This test measures what the compensated and reproducible modes cost compared
+// with the fast mode on both backends.
+TEST(InnerProductTest, AccumulationModesTiming) {
+    size_t n = 1 << 22;
+    std::vector<double> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = 1.0 / static_cast<double>(i + 1);
+        b[i] = static_cast<double>(i % 3) - 1.0;
+    }
+
+    std::cout << "\nAverage execution times (ms) over 10 runs, n = " << n << ":\n";
+    for (auto [mode, name] : {std::make_pair(AccumulationMode::Fast, "Fast"),
+                              std::make_pair(AccumulationMode::Compensated, "Compensated"),
+                              std::make_pair(AccumulationMode::Reproducible, "Reproducible")}) {
+        double threads_result = 0.0, openmp_result = 0.0;
+        double threads_time = measure_time([&]() {
+            threads_result = parallel_inner_product_threads(a, b, kAutoThreads, mode);
+        });
+        double openmp_time = measure_time([&]() {
+            openmp_result = parallel_inner_product_openmp(a, b, mode);
+        });
+        EXPECT_NEAR(threads_result, openmp_result, 1e-9);
+        std::cout << name << ": threads " << threads_time << " ms, OpenMP "
+                  << openmp_time << " ms\n";
+    }
+}
+
+// Matrix Inner Product Test
+// This test verifies strided column inner products, row and column products
+// of two matrices and the Gram matrix against products of copied rows and
+// columns, for both backends and for a view into a wider matrix.
+TEST(InnerProductTest, MatrixProductsTest) {
+    const size_t rows = 70, cols = 301, stride = 310;
+    std::vector<long long> storage_a(rows * stride), storage_b(rows * stride);
+    for (size_t i = 0; i < storage_a.size(); ++i) {
+        storage_a[i] = static_cast<long long>(i % 17) - 8;
+        storage_b[i] = static_cast<long long>((i * 7) % 13) - 6;
+    }
+    MatrixView<long long> a{storage_a.data(), rows, cols, stride};
+    MatrixView<long long> b{storage_b.data(), rows, cols, stride};
+    auto row_of = [&](const MatrixView<long long>& m, size_t i) {
+        return std::vector<long long>(m.row(i), m.row(i) + m.cols);
+    };
+    auto column_of = [&](const MatrixView<long long>& m, size_t j) {
+        std::vector<long long> column(m.rows);
+        for (size_t i = 0; i < m.rows; ++i) column[i] = m.row(i)[j];
+        return column;
+    };
+    auto dot = [](const std::vector<long long>& x, const std::vector<long long>& y) {
+        return std::inner_product(x.begin(), x.end(), y.begin(), 0LL);
+    };
+
+    std::vector<long long> expected_rows(rows), expected_columns(cols), expected_gram(rows * rows);
+    for (size_t i = 0; i < rows; ++i) expected_rows[i] = dot(row_of(a, i), row_of(b, i));
+    for (size_t j = 0; j < cols; ++j) expected_columns[j] = dot(column_of(a, j), column_of(b, j));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < rows; ++j) expected_gram[i * rows + j] = dot(row_of(a, i), row_of(a, j));
+    }
+
+    // Strided iterators feed the plain inner products directly
+    for (AccumulationMode mode : {AccumulationMode::Fast, AccumulationMode::Reproducible}) {
+        EXPECT_EQ(expected_columns[5], parallel_inner_product_threads(
+                                           a.column(5), a.column(5) + rows, b.column(5), 3u, mode));
+        EXPECT_EQ(expected_columns[5], parallel_inner_product_openmp(
+                                           a.column(5), a.column(5) + rows, b.column(5), mode));
+    }
+
+    for (unsigned int threads : {kAutoThreads, 1u, 3u, 8u, 100u}) {
+        EXPECT_EQ(expected_rows, parallel_row_inner_products_threads(a, b, threads));
+        EXPECT_EQ(expected_columns, parallel_column_inner_products_threads(a, b, threads));
+        EXPECT_EQ(expected_gram, parallel_gram_matrix_threads(a, threads));
+    }
+    EXPECT_EQ(expected_rows, parallel_row_inner_products_openmp(a, b));
+    EXPECT_EQ(expected_columns, parallel_column_inner_products_openmp(a, b));
+    EXPECT_EQ(expected_gram, parallel_gram_matrix_openmp(a));
+
+    // A few long rows are split inside each row product
+    std::vector<long long> wide(2 * 100000, 3);
+    EXPECT_EQ((std::vector<long long>{900000, 900000}),
+              parallel_row_inner_products_threads(matrix_view(wide, 2, 100000),
+                                                  matrix_view(wide, 2, 100000), 4));
+
+    MatrixView<long long> narrower{storage_b.data(), rows, cols - 1, stride};
+    EXPECT_THROW(parallel_row_inner_products_threads(a, narrower), std::invalid_argument);
+    EXPECT_THROW(parallel_column_inner_products_openmp(a, narrower), std::invalid_argument);
+    EXPECT_THROW(matrix_view(wide, 3, 100000), std::invalid_argument);
+    EXPECT_TRUE(parallel_gram_matrix_threads(MatrixView<long long>{}).empty());
+}
+
+// Matrix Inner Product Performance Test
+// This test compares column products computed from copied columns with the
+// in-place column kernel, and a Gram matrix computed pair by pair with the
+// cache-blocked Gram kernel.
+TEST(InnerProductTest, MatrixProductsTiming) {
+    const size_t rows = 2048, cols = 1024;
+    std::vector<double> storage_a(rows * cols), storage_b(rows * cols);
+    for (size_t i = 0; i < storage_a.size(); ++i) {
+        storage_a[i] = static_cast<double>(i % 5);
+        storage_b[i] = static_cast<double>(i % 3);
+    }
+    MatrixView<double> a = matrix_view(storage_a, rows, cols);
+    MatrixView<double> b = matrix_view(storage_b, rows, cols);
+
+    std::vector<double> copied(cols), in_place;
+    double copied_time = measure_time([&]() {
+        std::vector<double> x(rows), y(rows);
+        for (size_t j = 0; j < cols; ++j) {
+            for (size_t i = 0; i < rows; ++i) {
+                x[i] = storage_a[i * cols + j];
+                y[i] = storage_b[i * cols + j];
+            }
+            copied[j] = parallel_inner_product_threads(x, y);
+        }
+    });
+    double in_place_time = measure_time([&]() {
+        in_place = parallel_column_inner_products_threads(a, b);
+    });
+    EXPECT_EQ(copied, in_place);
+
+    MatrixView<double> tall{storage_a.data(), 256, cols * 8, cols * 8};
+    std::vector<double> pairwise(tall.rows * tall.rows), blocked;
+    double pairwise_time = measure_time([&]() {
+        for (size_t i = 0; i < tall.rows; ++i) {
+            for (size_t j = 0; j < tall.rows; ++j) {
+                pairwise[i * tall.rows + j] = std::inner_product(
+                    tall.row(i), tall.row(i) + tall.cols, tall.row(j), 0.0);
+            }
+        }
+    }, 3);
+    double blocked_time = measure_time([&]() {
+        blocked = parallel_gram_matrix_threads(tall);
+    }, 3);
+    for (size_t i = 0; i < pairwise.size(); ++i) {
+        EXPECT_NEAR(pairwise[i], blocked[i], 1e-9 * std::abs(pairwise[i]));
+    }
+
+    std::cout << "\nAverage execution times (ms), " << rows << " x " << cols << " matrices:\n"
+              << "Column products from copied columns: " << copied_time << " ms\n"
+              << "Column products in place: " << in_place_time << " ms\n"
+              << "Gram matrix of 256 rows of " << tall.cols << ", pair by pair: " << pairwise_time << " ms\n"
+              << "Gram matrix, blocked: " << blocked_time << " ms\n";
+}
+
+// Padded Aggregates Test
+// This test verifies that every per-worker slot and every row of per-worker
+// sums starts on a cache line of its own, and that the fused products that
+// accumulate into those rows still match std::inner_product at many chunks.
+TEST(InnerProductTest, PaddedAggregatesTest) {
+    auto line_of = [](const void* p) {
+        return reinterpret_cast<uintptr_t>(p) / kCacheLineSize;
+    };
+    PaddedSlots<double> slots(9, 1.5);
+    PaddedSlots<CompensatedSum<double>> sums(4);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        EXPECT_EQ(1.5, slots[i]);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(&slots[i]) % kCacheLineSize);
+        if (i > 0) {
+            EXPECT_NE(line_of(&slots[i - 1]), line_of(&slots[i]));
+        }
+    }
+    EXPECT_EQ(0.0, sums[3].value());
+
+    struct Triple { double x, y, z; };  // 24 bytes, does not divide a line
+    PaddedRows<Triple> triples(5, 3, Triple{1.0, 2.0, 3.0});
+    PaddedRows<float> rows(7, 2, 0.5f);
+    EXPECT_EQ(7u, rows.rows());
+    EXPECT_EQ(2u, rows.cols());
+    for (size_t i = 0; i < 7; ++i) {
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(rows.row(i)) % kCacheLineSize);
+        EXPECT_EQ(0.5f, rows.row(i)[1]);
+        if (i > 0) {
+            EXPECT_NE(line_of(rows.row(i - 1) + 1), line_of(rows.row(i)));
+        }
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(triples.row(i)) % kCacheLineSize);
+        EXPECT_EQ(3.0, triples.row(i)[2].z);
+    }
+
+    std::vector<long long> a(100003), b(a.size()), c(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<long long>(i % 11);
+        b[i] = static_cast<long long>(i % 5) - 2;
+        c[i] = static_cast<long long>(i % 3);
+    }
+    std::vector<long long> expected = {
+        std::inner_product(a.begin(), a.end(), b.begin(), 0LL),
+        std::inner_product(a.begin(), a.end(), c.begin(), 0LL)};
+    ThreadPool pool(3);
+    EXPECT_EQ(expected, parallel_fused_inner_product_threads(pool, a, {&b, &c}, 64));
+    EXPECT_EQ(expected, parallel_fused_inner_product_openmp(a, {&b, &c}));
+}
@@ -0,0 +1,184 @@
+// tests/test_instrumentation.cpp
+
+// Overview:
+// This file contains unit tests for the instrumentation layer. It is built
+// with AMS562_INSTRUMENTATION=1 and checks the region and chunk events that
+// the primitives record, the Chrome trace output, the imbalance summary and
+// the perf_event counters (when the kernel allows them).
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "inner_product_threads.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inclusive_scan_openmp.hpp"
+
+static_assert(AMS562_INSTRUMENTATION, "this test must be built with instrumentation");
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Returns the recorded events with the given name
+static std::vector<TraceEvent> events_named(const std::string& name) {
+    std::vector<TraceEvent> matching;
+    for (const TraceEvent& event : Tracer::instance().events()) {
+        if (name == event.name) matching.push_back(event);
+    }
+    return matching;
+}
+
+// Event Recording Test
+// This test verifies that the primitives record one region per call and one
+// event per chunk, covering every element.
+TEST(InstrumentationTest, RecordsRegionsAndChunks) {
+    Tracer::instance().clear();
+    std::vector<double> a(100000, 1.0), b(100000, 2.0), out;
+    EXPECT_DOUBLE_EQ(200000.0, parallel_inner_product_threads(a, b, 4));
+    parallel_inclusive_scan_threads(a, out, 4, ScanMode::ReduceThenScan);
+    parallel_inclusive_scan_openmp(a, out);
+
+    std::vector<TraceEvent> regions = events_named("inner_product_threads");
+    ASSERT_EQ(1u, regions.size());
+    EXPECT_STREQ("region", regions[0].category);
+    EXPECT_EQ(a.size(), regions[0].elements);
+
+    std::vector<TraceEvent> chunks = events_named("inner_product_threads/fast");
+    ASSERT_EQ(4u, chunks.size());
+    uint64_t elements = 0;
+    std::vector<bool> seen(4, false);
+    for (const TraceEvent& chunk : chunks) {
+        EXPECT_STREQ("chunk", chunk.category);
+        ASSERT_GE(chunk.chunk, 0);
+        ASSERT_LT(chunk.chunk, 4);
+        seen[chunk.chunk] = true;
+        elements += chunk.elements;
+        // Chunks run inside their region
+        EXPECT_GE(chunk.start_us, regions[0].start_us);
+        EXPECT_LE(chunk.start_us + chunk.duration_us,
+                  regions[0].start_us + regions[0].duration_us + 1.0);
+    }
+    EXPECT_EQ(std::vector<bool>(4, true), seen);
+    EXPECT_EQ(a.size(), elements);
+
+    EXPECT_EQ(1u, events_named("scan_threads").size());
+    EXPECT_EQ(3u, events_named("scan_threads/reduce").size());
+    EXPECT_EQ(4u, events_named("scan_threads/scan").size());
+    EXPECT_EQ(1u, events_named("scan_openmp").size());
+
+    Tracer::instance().clear();
+    EXPECT_TRUE(Tracer::instance().events().empty());
+}
+
+// Chrome Trace Test
+// This test verifies the structure of the Chrome trace output and that it can
+// be written to a file.
+TEST(InstrumentationTest, WritesChromeTrace) {
+    Tracer::instance().clear();
+    std::vector<long long> data(50000, 1);
+    parallel_inclusive_scan_threads(data, 3);
+    size_t num_events = Tracer::instance().events().size();
+    ASSERT_GT(num_events, 1u);
+
+    std::ostringstream out;
+    Tracer::instance().write_chrome_trace(out);
+    std::string trace = out.str();
+    EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"scan_threads/add\""));
+    EXPECT_NE(std::string::npos, trace.find("\"chunk\":2"));
+    size_t complete_events = 0;
+    for (size_t pos = trace.find("\"ph\":\"X\""); pos != std::string::npos;
+         pos = trace.find("\"ph\":\"X\"", pos + 1)) {
+        ++complete_events;
+    }
+    EXPECT_EQ(num_events, complete_events);
+    EXPECT_EQ("}\n", trace.substr(trace.size() - 2));
+
+    std::string path = ::testing::TempDir() + "ams562_trace.json";
+    ASSERT_TRUE(Tracer::instance().write_chrome_trace(path));
+    std::ifstream in(path);
+    std::stringstream written;
+    written << in.rdbuf();
+    EXPECT_EQ(trace, written.str());
+    std::remove(path.c_str());
+    EXPECT_FALSE(Tracer::instance().write_chrome_trace("/nonexistent/dir/trace.json"));
+}
+
+// Summary Test
+// This test verifies the per-name summary: event counts, elements, and a load
+// imbalance that is zero when a single thread did all the work.
+TEST(InstrumentationTest, SummarizesImbalance) {
+    Tracer::instance().clear();
+    std::vector<double> a(200000, 1.0);
+    parallel_inner_product_threads(a, a, 8);
+
+    bool found = false;
+    for (const TraceSummary& s : Tracer::instance().summary()) {
+        EXPECT_GE(s.imbalance, 0.0);
+        EXPECT_GE(s.threads, 1u);
+        EXPECT_LE(s.max_thread_us, s.total_us + 1e-9);
+        if (s.name == "inner_product_threads/fast") {
+            found = true;
+            EXPECT_EQ(8u, s.events);
+            EXPECT_EQ(a.size(), s.elements);
+            if (s.threads == 1) {
+                EXPECT_DOUBLE_EQ(0.0, s.imbalance);
+            }
+        }
+        std::cout << s.name << ": " << s.events << " events on " << s.threads
+                  << " threads, " << s.total_us << " us, imbalance "
+                  << s.imbalance << ", LLC bytes " << s.bytes_moved << std::endl;
+    }
+    EXPECT_TRUE(found);
+    Tracer::instance().clear();
+}
+
+// Hardware Counter Test
+// This test verifies that the perf_event counters advance over a loop when
+// the kernel allows them, and prints the recording cost of one event.
+TEST(InstrumentationTest, HardwareCounters) {
+    const PerfCounters& counters = PerfCounters::this_thread();
+    std::cout << "perf_event counters: cycles "
+              << counters.available(PerfCounters::kCycles) << ", instructions "
+              << counters.available(PerfCounters::kInstructions)
+              << ", LLC misses " << counters.available(PerfCounters::kLlcMisses)
+              << std::endl;
+
+    PerfSample before = counters.read();
+    std::vector<double> a(1 << 20, 1.0);
+    volatile double sum = std::accumulate(a.begin(), a.end(), 0.0);
+    (void)sum;
+    PerfSample after = counters.read();
+    if (counters.available(PerfCounters::kInstructions)) {
+        EXPECT_GT(after.instructions, before.instructions + (1u << 20));
+    }
+    if (counters.available(PerfCounters::kCycles)) {
+        EXPECT_GT(after.cycles, before.cycles);
+    }
+
+    Tracer::instance().clear();
+    double scope_time = measure_time([]() {
+        for (int i = 0; i < 1000; ++i) {
+            AMS562_TRACE_CHUNK("overhead", i, 0);
+        }
+    });
+    EXPECT_EQ(10000u, events_named("overhead").size());
+    Tracer::instance().clear();
+    std::cout << "Average cost of one trace event: " << scope_time << " us" << std::endl;
+}
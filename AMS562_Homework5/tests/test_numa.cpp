@@ -0,0 +1,120 @@
+// tests/test_numa.cpp
+
+// Overview:
+// This file contains unit tests for the NUMA layer: topology parsing, the
+// page-aligned node partition, the first-touch helpers and the NUMA-aware
+// inner product and scan. The NUMA gain is measured by the numa/ runs of
+// benchmarks/primitives_benchmark.cpp.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "numa.hpp"
+
+// CPU List Test
+// This test verifies the parsing of sysfs CPU lists, including malformed ones.
+TEST(NumaTest, ParseCpuList) {
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}), parse_cpu_list("0-3,8,10-11\n"));
+    EXPECT_EQ((std::vector<int>{5}), parse_cpu_list("5"));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+    EXPECT_TRUE(parse_cpu_list("3-1").empty());
+    EXPECT_TRUE(parse_cpu_list("a-b").empty());
+}
+
+// Topology Test
+// This test verifies that a fake two-node sysfs tree is read, and that a
+// missing tree falls back to a single node.
+TEST(NumaTest, ReadTopology) {
+    std::string root = ::testing::TempDir() + "ams562_fake_node";
+    std::filesystem::create_directories(root + "/node0");
+    std::filesystem::create_directories(root + "/node1");
+    std::ofstream(root + "/online") << "0-1\n";
+    std::ofstream(root + "/node0/cpulist") << "0-3\n";
+    std::ofstream(root + "/node1/cpulist") << "4-7\n";
+
+    NumaTopology two = read_numa_topology(root);
+    ASSERT_EQ(2u, two.num_nodes());
+    EXPECT_EQ((std::vector<int>{4, 5, 6, 7}), two.node_cpus[1]);
+
+    NumaTopology fallback = read_numa_topology(root + "/missing");
+    EXPECT_EQ(1u, fallback.num_nodes());
+    EXPECT_FALSE(fallback.node_cpus[0].empty());
+    EXPECT_GE(numa_topology().num_nodes(), 1u);
+}
+
+// Partition Test
+// This test verifies that the node ranges cover the array without gaps and
+// that every inner boundary falls on a page boundary.
+TEST(NumaTest, NodeRangesArePageAligned) {
+    size_t per_page = numa_page_size() / sizeof(double);
+    for (size_t n : {size_t(0), size_t(10), size_t(1000003)}) {
+        for (size_t nodes : {1u, 2u, 3u, 4u}) {
+            size_t expected_begin = 0;
+            for (size_t k = 0; k < nodes; ++k) {
+                NumaRange r = numa_node_range(n, sizeof(double), nodes, k);
+                EXPECT_EQ(expected_begin, r.begin);
+                EXPECT_LE(r.begin, r.end);
+                if (k + 1 < nodes) {
+                    EXPECT_EQ(0u, r.end % per_page);
+                }
+                expected_begin = r.end;
+            }
+            EXPECT_EQ(n, expected_begin);
+        }
+    }
+}
+
+// Two-Node Executor Test
+// This test runs the NUMA primitives on an executor built from a fake
+// two-node topology, so the multi-node code path runs on any machine.
+TEST(NumaTest, PrimitivesOnTwoNodes) {
+    NumaTopology fake;
+    fake.node_cpus = {{0}, {0}};
+    NumaExecutor executor(fake);
+    ASSERT_EQ(2u, executor.num_nodes());
+
+    size_t n = 1000003;
+    NumaBuffer<int64_t> a = numa_allocate<int64_t>(n, 3, executor);
+    std::vector<int64_t> values(n);
+    for (size_t i = 0; i < n; ++i) values[i] = static_cast<int64_t>(i % 7) - 3;
+    NumaBuffer<int64_t> b = numa_copy(values.begin(), values.end(), executor);
+    ASSERT_EQ(n, b.size());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b.data()) % numa_page_size());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), b.begin()));
+
+    int64_t expected = 3 * std::accumulate(values.begin(), values.end(), int64_t(0));
+    EXPECT_EQ(expected, numa_inner_product(a, b, executor));
+
+    std::vector<int64_t> expected_scan(n);
+    std::inclusive_scan(values.begin(), values.end(), expected_scan.begin());
+    numa_inclusive_scan(b, executor);
+    EXPECT_TRUE(std::equal(expected_scan.begin(), expected_scan.end(), b.begin()));
+}
+
+// Default Executor Test
+// This test verifies the primitives on the executor of this machine,
+// including the single-node fallback and empty inputs.
+TEST(NumaTest, PrimitivesOnDefaultExecutor) {
+    for (size_t n : {size_t(0), size_t(1), size_t(4097), size_t(300001)}) {
+        NumaBuffer<double> a = numa_allocate(n, 0.5);
+        NumaBuffer<double> b = numa_allocate(n, 4.0);
+        EXPECT_DOUBLE_EQ(2.0 * n, numa_inner_product(a, b));
+
+        std::vector<double> out(n);
+        numa_inclusive_scan(a.data(), out.data(), n);
+        for (size_t i = 0; i < n; i += 997) {
+            EXPECT_DOUBLE_EQ(0.5 * (i + 1), out[i]);
+        }
+    }
+#ifdef _OPENMP
+    std::vector<double> x(100000), y(100000, 2.0);
+    numa_fill_openmp(x.data(), x.size(), 1.5);
+    EXPECT_DOUBLE_EQ(300000.0, numa_inner_product_openmp(x.data(), y.data(), x.size()));
+#endif
+}
@@ -0,0 +1,206 @@
+// tests/test_radix_sort.cpp
+
+// Overview:
+// This file contains unit tests for the parallel LSD radix sort: the order of
+// the radix keys, sorting of signed, unsigned and floating-point keys for
+// several chunk counts, stable key-value sorting, and a timing comparison
+// with std::sort (and std::sort with std::execution::par when the parallel
+// STL is available).
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if AMS562_PARALLEL_STL
+#include <execution>
+#endif
+
+#include "radix_sort.hpp"
+#include "thread_pool.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Helper function that fills a vector with reproducible pseudo-random keys
+template <typename T>
+std::vector<T> random_keys(size_t n, unsigned seed = 562) {
+    std::mt19937_64 gen(seed);
+    std::vector<T> v(n);
+    for (T& x : v) {
+        if constexpr (std::is_floating_point_v<T>) {
+            x = std::uniform_real_distribution<T>(-1e6, 1e6)(gen);
+        } else {
+            x = static_cast<T>(gen());
+        }
+    }
+    return v;
+}
+
+// Helper that checks the radix sort against std::sort for several chunk counts
+template <typename T>
+void expect_sorts_like_std(ThreadPool& pool, const std::vector<T>& input) {
+    std::vector<T> expected = input;
+    std::sort(expected.begin(), expected.end());
+    for (unsigned int chunks : {1u, 2u, 3u, 8u, kAutoThreads}) {
+        std::vector<T> data = input;
+        parallel_radix_sort_threads(pool, data, chunks);
+        EXPECT_EQ(expected, data) << "n=" << input.size() << " chunks=" << chunks;
+    }
+}
+
+// Radix Key Test
+// This test verifies that radix_key preserves the order of signed integers and
+// floats, including negative zero, infinities and NaNs.
+TEST(RadixSortTest, RadixKeyOrder) {
+    EXPECT_LT(radix_key(int32_t(-5)), radix_key(int32_t(-1)));
+    EXPECT_LT(radix_key(int32_t(-1)), radix_key(int32_t(0)));
+    EXPECT_LT(radix_key(std::numeric_limits<int64_t>::min()), radix_key(int64_t(0)));
+    EXPECT_LT(radix_key(int64_t(0)), radix_key(std::numeric_limits<int64_t>::max()));
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> ordered = {-nan, -inf, -2.5f, -1e-30f, -0.0f, 0.0f, 1e-30f, 3.0f, inf, nan};
+    for (size_t i = 1; i < ordered.size(); ++i) {
+        EXPECT_LT(radix_key(ordered[i - 1]), radix_key(ordered[i])) << "i=" << i;
+    }
+    EXPECT_LT(radix_key(-1.0), radix_key(0.5));
+}
+
+// Integer Keys Test
+// This test verifies that 32- and 64-bit signed and unsigned keys sort like
+// std::sort, including small inputs and keys that only use their low digits.
+TEST(RadixSortTest, IntegerKeys) {
+    ThreadPool pool(3);
+    expect_sorts_like_std(pool, random_keys<int32_t>(100003));
+    expect_sorts_like_std(pool, random_keys<uint32_t>(100003));
+    expect_sorts_like_std(pool, random_keys<int64_t>(70001));
+    expect_sorts_like_std(pool, random_keys<uint64_t>(70001));
+    expect_sorts_like_std(pool, random_keys<int16_t>(5000));
+    expect_sorts_like_std(pool, random_keys<int32_t>(37));
+    expect_sorts_like_std(pool, std::vector<int32_t>());
+
+    std::vector<uint64_t> small(50000);
+    for (size_t i = 0; i < small.size(); ++i) small[i] = (i * 7919) % 1000;
+    expect_sorts_like_std(pool, small);
+    expect_sorts_like_std(pool, std::vector<int64_t>(4096, -3));
+}
+
+// Floating-Point Keys Test
+// This test verifies that float and double keys with mixed signs sort like
+// std::sort.
+TEST(RadixSortTest, FloatingPointKeys) {
+    ThreadPool pool(3);
+    expect_sorts_like_std(pool, random_keys<float>(100003));
+    expect_sorts_like_std(pool, random_keys<double>(100003));
+
+    std::vector<double> special = random_keys<double>(4000);
+    special[10] = std::numeric_limits<double>::infinity();
+    special[20] = -std::numeric_limits<double>::infinity();
+    special[30] = std::numeric_limits<double>::denorm_min();
+    special[40] = -std::numeric_limits<double>::max();
+    expect_sorts_like_std(pool, special);
+}
+
+// Key-Value Test
+// This test verifies that sorting by key moves the values along and keeps the
+// values of equal keys in input order (stability), and that mismatched sizes
+// are rejected.
+TEST(RadixSortTest, KeyValuePairsAreStable) {
+    ThreadPool pool(3);
+    for (size_t n : {size_t(500), size_t(200003)}) {
+        std::vector<int32_t> keys(n);
+        std::vector<uint32_t> values(n);
+        std::mt19937 gen(11);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<int32_t>(gen() % 2001) - 1000;
+            values[i] = static_cast<uint32_t>(i);
+        }
+        std::vector<std::pair<int32_t, uint32_t>> expected(n);
+        for (size_t i = 0; i < n; ++i) expected[i] = {keys[i], values[i]};
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (unsigned int chunks : {1u, 4u, kAutoThreads}) {
+            std::vector<int32_t> k = keys;
+            std::vector<uint32_t> v = values;
+            parallel_radix_sort_by_key_threads(pool, k, v, chunks);
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(expected[i].first, k[i]) << "i=" << i;
+                ASSERT_EQ(expected[i].second, v[i]) << "i=" << i;
+            }
+        }
+    }
+    std::vector<int32_t> keys(10);
+    std::vector<double> values(9);
+    EXPECT_THROW(parallel_radix_sort_by_key_threads(keys, values), std::invalid_argument);
+}
+
+// Large Input Test
+// This test compares the radix sort with std::sort on 10 million keys and
+// verifies that the results match.
+TEST(RadixSortTest, LargeInputVsStdSort) {
+    size_t n = 10000000;
+    std::vector<uint32_t> u32 = random_keys<uint32_t>(n);
+    std::vector<double> f64 = random_keys<double>(n);
+    std::vector<uint32_t> u32_data;
+    std::vector<double> f64_data;
+
+    // Every run sorts a fresh copy, so the copy is part of all timings
+    double std_u32 = measure_time([&]() {
+        u32_data = u32;
+        std::sort(u32_data.begin(), u32_data.end());
+    }, 3);
+    std::vector<uint32_t> u32_expected = u32_data;
+    double radix_u32 = measure_time([&]() {
+        u32_data = u32;
+        parallel_radix_sort_threads(u32_data);
+    }, 3);
+    EXPECT_EQ(u32_expected, u32_data);
+
+    double std_f64 = measure_time([&]() {
+        f64_data = f64;
+        std::sort(f64_data.begin(), f64_data.end());
+    }, 3);
+    std::vector<double> f64_expected = f64_data;
+    double radix_f64 = measure_time([&]() {
+        f64_data = f64;
+        parallel_radix_sort_threads(f64_data);
+    }, 3);
+    EXPECT_EQ(f64_expected, f64_data);
+
+    std::cout << "\nAverage execution times (ms) over 3 runs, n = " << n << ":\n"
+              << "std::sort uint32: " << std_u32 << " ms\n"
+              << "Parallel radix sort uint32: " << radix_u32 << " ms\n"
+              << "std::sort double: " << std_f64 << " ms\n"
+              << "Parallel radix sort double: " << radix_f64 << " ms\n";
+
+#if AMS562_PARALLEL_STL
+    double par_u32 = measure_time([&]() {
+        u32_data = u32;
+        std::sort(std::execution::par, u32_data.begin(), u32_data.end());
+    }, 3);
+    double par_f64 = measure_time([&]() {
+        f64_data = f64;
+        std::sort(std::execution::par, f64_data.begin(), f64_data.end());
+    }, 3);
+    std::cout << "std::sort (par) uint32: " << par_u32 << " ms\n"
+              << "std::sort (par) double: " << par_f64 << " ms\n";
+#endif
+}
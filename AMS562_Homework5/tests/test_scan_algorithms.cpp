@@ -0,0 +1,238 @@
+// tests/test_scan_algorithms.cpp
+
+// Overview:
+// This file contains unit tests for the algorithms built on the chunked scan:
+// stream compaction, stable partition, chunked histograms with their radix
+// scatter offsets, and CSR sparse matrix-vector products. Each is checked
+// against its serial std counterpart for several chunk counts, and timed
+// against the std::execution::par equivalent when the parallel STL is
+// available.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#if AMS562_PARALLEL_STL
+#include <execution>
+#endif
+
+#include "scan_algorithms.hpp"
+#include "thread_pool.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Helper function that fills a vector with reproducible pseudo-random integers
+std::vector<int> random_ints(size_t n, int max_value, unsigned seed = 562) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, max_value);
+    std::vector<int> v(n);
+    for (int& x : v) x = dist(gen);
+    return v;
+}
+
+// Helper function that builds a banded CSR matrix whose first rows are dense,
+// so that balancing by rows alone would be uneven
+CsrMatrix<double> skewed_matrix(size_t rows, size_t cols) {
+    std::vector<size_t> r, c;
+    std::vector<double> v;
+    for (size_t i = 0; i < rows; ++i) {
+        size_t width = i < 4 ? cols : 3;
+        for (size_t k = 0; k < width; ++k) {
+            r.push_back(i);
+            c.push_back((i + k) % cols);
+            v.push_back(static_cast<double>((i + k) % 5) - 2.0);
+        }
+    }
+    return csr_from_triplets(rows, cols, r, c, v);
+}
+
+// Stream Compaction Test
+// This test verifies that parallel_copy_if_threads matches std::copy_if for
+// every chunk count, including empty inputs and predicates that keep nothing.
+TEST(ScanAlgorithmsTest, CopyIfMatchesStd) {
+    ThreadPool pool(3);
+    auto is_even = [](int x) { return x % 2 == 0; };
+    for (size_t n : {size_t(0), size_t(1), size_t(17), size_t(100003)}) {
+        std::vector<int> input = random_ints(n, 1000);
+        std::vector<int> expected;
+        std::copy_if(input.begin(), input.end(), std::back_inserter(expected), is_even);
+        for (unsigned int chunks : {1u, 2u, 3u, 7u, 64u, kAutoThreads}) {
+            EXPECT_EQ(expected, parallel_copy_if_threads(pool, input, is_even, chunks))
+                << "n=" << n << " chunks=" << chunks;
+        }
+        std::vector<int> output(n, -1);
+        auto end = parallel_copy_if_threads(input.begin(), input.end(), output.begin(),
+                                            [](int) { return false; }, 4);
+        EXPECT_EQ(output.begin(), end);
+    }
+}
+
+// Partition Test
+// This test verifies that parallel_partition_threads is a stable partition:
+// it matches std::stable_partition and returns the partition point.
+TEST(ScanAlgorithmsTest, PartitionIsStable) {
+    ThreadPool pool(3);
+    auto small = [](int x) { return x < 300; };
+    std::vector<int> input = random_ints(50021, 1000);
+    std::vector<int> expected = input;
+    auto expected_point = std::stable_partition(expected.begin(), expected.end(), small);
+    for (unsigned int chunks : {1u, 2u, 5u, 16u, kAutoThreads}) {
+        std::vector<int> data = input;
+        size_t point = parallel_partition_threads(pool, data, small, chunks);
+        EXPECT_EQ(static_cast<size_t>(expected_point - expected.begin()), point);
+        EXPECT_EQ(expected, data) << "chunks=" << chunks;
+    }
+}
+
+// Histogram Test
+// This test verifies the chunked histogram of radix digits: the per-bin totals
+// match a serial count, and the scatter offsets place every chunk's elements
+// in a stable counting sort.
+TEST(ScanAlgorithmsTest, HistogramAndScatterOffsets) {
+    ThreadPool pool(3);
+    std::vector<uint32_t> keys(40000);
+    std::mt19937 gen(7);
+    for (uint32_t& k : keys) k = gen();
+    auto digit = [](uint32_t k) { return k & 0xFF; };
+
+    std::vector<size_t> expected(256, 0);
+    for (uint32_t k : keys) ++expected[digit(k)];
+    EXPECT_EQ(expected, parallel_histogram_threads(pool, keys.begin(), keys.end(), 256, digit, 5));
+    EXPECT_EQ(expected, parallel_histogram_threads(keys.begin(), keys.end(), 256, digit));
+
+    // One stable counting-sort pass through the offsets
+    ChunkedHistogram histogram =
+        parallel_chunked_histogram_threads(pool, keys.begin(), keys.end(), 256, digit, 5);
+    ASSERT_EQ(5u, histogram.plan.num_chunks);
+    EXPECT_EQ(keys.size(), histogram_scatter_offsets(pool, histogram));
+    std::vector<uint32_t> sorted(keys.size());
+    pool.parallel_for(histogram.plan.num_chunks, [&](size_t c) {
+        for (size_t i = histogram.plan.begin(c); i < histogram.plan.end(c); ++i) {
+            sorted[histogram.at(digit(keys[i]), c)++] = keys[i];
+        }
+    });
+    std::vector<uint32_t> reference = keys;
+    std::stable_sort(reference.begin(), reference.end(),
+                     [&](uint32_t x, uint32_t y) { return digit(x) < digit(y); });
+    EXPECT_EQ(reference, sorted);
+}
+
+// CSR Construction Test
+// This test verifies that triplets are converted to CSR with the row offsets
+// of the scan, and that malformed triplets are rejected.
+TEST(ScanAlgorithmsTest, CsrFromTriplets) {
+    CsrMatrix<double> m = csr_from_triplets<double>(
+        3, 4, {2, 0, 2, 0}, {1, 3, 0, 0}, {1.0, 2.0, 3.0, 4.0});
+    EXPECT_EQ((std::vector<size_t>{0, 2, 2, 4}), m.row_offsets);
+    EXPECT_EQ((std::vector<size_t>{3, 0, 1, 0}), m.col_indices);
+    EXPECT_EQ((std::vector<double>{2.0, 4.0, 1.0, 3.0}), m.values);
+
+    EXPECT_THROW(csr_from_triplets<double>(3, 4, {0}, {0, 1}, {1.0}),
+                 std::invalid_argument);
+    EXPECT_THROW(csr_from_triplets<double>(3, 4, {3}, {0}, {1.0}),
+                 std::invalid_argument);
+}
+
+// SpMV Test
+// This test verifies that parallel_spmv_threads matches a serial product on a
+// matrix with a few dense rows, for every chunk count, and that a mismatched
+// vector is rejected.
+TEST(ScanAlgorithmsTest, SpmvMatchesSerial) {
+    ThreadPool pool(3);
+    CsrMatrix<double> m = skewed_matrix(2000, 500);
+    std::vector<double> x(m.cols);
+    for (size_t j = 0; j < x.size(); ++j) x[j] = static_cast<double>(j % 7) - 3.0;
+
+    std::vector<double> expected(m.rows, 0.0);
+    for (size_t i = 0; i < m.rows; ++i) {
+        for (size_t k = m.row_offsets[i]; k < m.row_offsets[i + 1]; ++k) {
+            expected[i] += m.values[k] * x[m.col_indices[k]];
+        }
+    }
+    for (unsigned int chunks : {1u, 2u, 3u, 8u, kAutoThreads}) {
+        std::vector<double> y;
+        parallel_spmv_threads(pool, m, x, y, chunks);
+        EXPECT_EQ(expected, y) << "chunks=" << chunks;
+    }
+    std::vector<double> y;
+    EXPECT_THROW(parallel_spmv_threads(m, std::vector<double>(3), y),
+                 std::invalid_argument);
+}
+
+// Throughput Test
+// This test compares the scan-based algorithms with the serial std algorithms
+// and, when available, with their std::execution::par equivalents.
+TEST(ScanAlgorithmsTest, ThroughputVsStd) {
+    size_t n = 10000000;
+    std::vector<int> input = random_ints(n, 1000);
+    std::vector<int> output(n);
+    auto keep = [](int x) { return x < 500; };
+
+    double std_copy_if = measure_time([&]() {
+        std::copy_if(input.begin(), input.end(), output.begin(), keep);
+    });
+    double threads_copy_if = measure_time([&]() {
+        parallel_copy_if_threads(input.begin(), input.end(), output.begin(), keep);
+    });
+    std::vector<int> rejected(n);
+    double std_partition = measure_time([&]() {
+        std::partition_copy(input.begin(), input.end(), output.begin(), rejected.begin(), keep);
+    });
+    double threads_partition = measure_time([&]() {
+        parallel_partition_threads(input.begin(), input.end(), output.begin(), keep);
+    });
+
+    CsrMatrix<double> m = skewed_matrix(1000000, 1000000);
+    std::vector<double> x(m.cols, 1.0), y(m.rows);
+    double serial_spmv = measure_time([&]() {
+        csr_rows_multiply(m, x.data(), y.data(), 0, m.rows);
+    });
+    double threads_spmv = measure_time([&]() {
+        parallel_spmv_threads(m, x, y);
+    });
+
+    std::cout << "\nAverage execution times (ms) over 10 runs, n = " << n << ":\n"
+              << "std::copy_if: " << std_copy_if << " ms\n"
+              << "Parallel threads copy_if: " << threads_copy_if << " ms\n"
+              << "std::partition_copy: " << std_partition << " ms\n"
+              << "Parallel threads partition: " << threads_partition << " ms\n"
+              << "Serial SpMV (" << m.nonzeros() << " nonzeros): " << serial_spmv << " ms\n"
+              << "Parallel threads SpMV: " << threads_spmv << " ms\n";
+
+#if AMS562_PARALLEL_STL
+    double par_copy_if = measure_time([&]() {
+        std::copy_if(std::execution::par, input.begin(), input.end(), output.begin(), keep);
+    });
+    double par_partition = measure_time([&]() {
+        std::partition_copy(std::execution::par, input.begin(), input.end(),
+                            output.begin(), rejected.begin(), keep);
+    });
+    std::vector<size_t> row_ids(m.rows);
+    std::iota(row_ids.begin(), row_ids.end(), size_t(0));
+    double par_spmv = measure_time([&]() {
+        std::for_each(std::execution::par, row_ids.begin(), row_ids.end(), [&](size_t i) {
+            csr_rows_multiply(m, x.data(), y.data(), i, i + 1);
+        });
+    });
+    std::cout << "std::copy_if (par): " << par_copy_if << " ms\n"
+              << "std::partition_copy (par): " << par_partition << " ms\n"
+              << "std::for_each SpMV (par): " << par_spmv << " ms\n";
+#endif
+}
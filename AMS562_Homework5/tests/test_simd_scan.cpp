@@ -0,0 +1,124 @@
+// tests/test_simd_scan.cpp
+
+// Overview:
+// This file contains unit tests for the vectorized per-chunk scan kernels,
+// checking every instruction set supported by the running CPU against
+// std::inclusive_scan.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "simd_scan.hpp"
+#include "inclusive_scan_threads.hpp"
+#include "inclusive_scan_openmp.hpp"
+
+// Helper function that measures the average execution time of a function over
+// multiple runs. Returns the average time in milliseconds.
+template <typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < num_runs; ++i) {
+    func();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double total_time =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  return total_time / num_runs;
+}
+
+// Instruction sets the running CPU supports, from scalar upwards
+std::vector<SimdLevel> supported_levels() {
+  std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+  if (detected_simd_level() >= SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+  if (detected_simd_level() >= SimdLevel::AVX512) levels.push_back(SimdLevel::AVX512);
+  return levels;
+}
+
+template <typename T>
+class SimdScanTest : public ::testing::Test {};
+
+using ScanTypes = ::testing::Types<int32_t, int64_t, uint32_t, float, double, int16_t>;
+TYPED_TEST_SUITE(SimdScanTest, ScanTypes);
+
+// Test case: Verifies every kernel against std::inclusive_scan with a seed,
+// for lengths around the register widths
+TYPED_TEST(SimdScanTest, MatchesStdInclusiveScan) {
+  using T = TypeParam;
+  for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(17),
+                   size_t(64), size_t(1001)}) {
+    std::vector<T> input(n);
+    for (size_t i = 0; i < n; ++i) {
+      input[i] = static_cast<T>((i * 7) % 19);
+    }
+    const T seed = static_cast<T>(3);
+    std::vector<T> expected(n);
+    std::inclusive_scan(input.begin(), input.end(), expected.begin(),
+                        std::plus<T>(), seed);
+
+    for (SimdLevel level : supported_levels()) {
+      std::vector<T> output(n);
+      T last = simd_inclusive_scan(input.data(), output.data(), n, seed, level);
+      EXPECT_EQ(expected, output) << "n = " << n << ", level = " << int(level);
+      EXPECT_EQ(n == 0 ? seed : expected.back(), last);
+    }
+  }
+}
+
+// Test case: Verifies that the kernels can scan in place
+TYPED_TEST(SimdScanTest, InPlace) {
+  using T = TypeParam;
+  std::vector<T> input(100, static_cast<T>(1));
+  std::vector<T> expected(100);
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+  for (SimdLevel level : supported_levels()) {
+    std::vector<T> data = input;
+    simd_inclusive_scan(data.data(), data.data(), data.size(), T(0), level);
+    EXPECT_EQ(expected, data) << "level = " << int(level);
+  }
+}
+
+// Test case: Verifies the floating-point parallel scans that now use the
+// kernels, within a relative tolerance
+TEST(SimdScanTest, FloatingPointParallelScans) {
+  size_t n = 100003;
+  std::vector<double> input(n);
+  for (size_t i = 0; i < n; ++i) {
+    input[i] = std::sin(0.1 * i);
+  }
+  std::vector<double> expected(n);
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+
+  std::vector<double> output_threads, output_openmp;
+  parallel_inclusive_scan_threads(input, output_threads, 4);
+  parallel_inclusive_scan_openmp(input, output_openmp);
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_NEAR(expected[i], output_threads[i], 1e-9);
+    EXPECT_NEAR(expected[i], output_openmp[i], 1e-9);
+  }
+}
+
+// Test case: Compares the throughput of the kernels on an L2-resident chunk
+TEST(SimdScanTest, KernelPerformance) {
+  size_t n = 1 << 14;
+  std::vector<int> input(n, 1);
+  std::vector<int> output(n);
+
+  std::cout << "\nAverage execution times (ms) over 1000 runs, n = " << n << ":\n";
+  double std_time = measure_time([&]() {
+    std::partial_sum(input.begin(), input.end(), output.begin());
+  }, 1000);
+  std::cout << "std::partial_sum: " << std_time << "\n";
+  const char* names[] = {"Scalar", "AVX2", "AVX-512"};
+  for (SimdLevel level : supported_levels()) {
+    double time = measure_time([&]() {
+      simd_inclusive_scan(input.data(), output.data(), n, 0, level);
+    }, 1000);
+    EXPECT_EQ(output.back(), static_cast<int>(n));
+    std::cout << names[int(level)] << ": " << time << "\n";
+  }
+}
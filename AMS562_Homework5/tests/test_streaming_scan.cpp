@@ -0,0 +1,188 @@
+// tests/test_streaming_scan.cpp
+
+// Overview:
+// This file contains unit tests for StreamingScanner and the seeded parallel
+// scan underneath it: a stream of chunks of any sizes must scan to the same
+// values as one scan of the concatenated input, for every scan mode, scan
+// type and operation, whether the chunks are pushed (double buffered) or
+// scanned in place.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "streaming_scan.hpp"
+#include "thread_pool.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Helper that returns deterministic test values
+std::vector<long long> make_input(size_t n) {
+    std::vector<long long> input(n);
+    for (size_t i = 0; i < n; ++i) input[i] = static_cast<long long>((i * 37) % 101) - 50;
+    return input;
+}
+
+// Helper that splits input into chunks of the given sizes, cycling through them
+std::vector<std::vector<long long>> split(const std::vector<long long>& input,
+                                          const std::vector<size_t>& sizes) {
+    std::vector<std::vector<long long>> chunks;
+    size_t offset = 0;
+    for (size_t k = 0; offset < input.size(); ++k) {
+        size_t n = std::min(sizes[k % sizes.size()], input.size() - offset);
+        chunks.emplace_back(input.begin() + offset, input.begin() + offset + n);
+        offset += n;
+    }
+    return chunks;
+}
+
+// Seeded Scan Test
+// This test verifies that the seeded parallel scan folds its seed into every
+// output and returns the seed of the next scan, in every mode.
+TEST(StreamingScanTest, SeededScanReturnsCarry) {
+    ThreadPool pool(3);
+    std::vector<long long> input = make_input(300001);
+    for (ScanMode mode : {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback,
+                          ScanMode::ReduceThenScan}) {
+        for (unsigned int chunks : {1u, 4u, 7u}) {
+            std::vector<long long> expected(input.size());
+            std::inclusive_scan(input.begin(), input.end(), expected.begin(), std::plus<>(), 1000LL);
+            std::vector<long long> output(input.size());
+            long long carry = parallel_seeded_scan_threads(
+                pool, input.begin(), input.end(), output.begin(), std::plus<long long>(), 0LL,
+                1000LL, ScanType::Inclusive, chunks, mode);
+            EXPECT_EQ(expected, output) << chunks << " chunks";
+            EXPECT_EQ(expected.back(), carry) << chunks << " chunks";
+
+            std::exclusive_scan(input.begin(), input.end(), expected.begin(), 1000LL);
+            carry = parallel_seeded_scan_threads(
+                pool, input.begin(), input.end(), output.begin(), std::plus<long long>(), 0LL,
+                1000LL, ScanType::Exclusive, chunks, mode);
+            EXPECT_EQ(expected, output) << chunks << " chunks";
+            EXPECT_EQ(expected.back() + input.back(), carry) << chunks << " chunks";
+        }
+    }
+}
+
+// Pushed Stream Test
+// This test verifies that pushed chunks of irregular sizes (including single
+// elements) come back in order and scanned as one sequence.
+TEST(StreamingScanTest, PushedChunksMatchWholeScan) {
+    ThreadPool pool(2);
+    std::vector<long long> input = make_input(250000);
+    for (ScanType type : {ScanType::Inclusive, ScanType::Exclusive}) {
+        std::vector<long long> expected(input.size());
+        if (type == ScanType::Inclusive) {
+            std::inclusive_scan(input.begin(), input.end(), expected.begin());
+        } else {
+            std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0LL);
+        }
+        for (ScanMode mode : {ScanMode::ScanThenAdd, ScanMode::DecoupledLookback}) {
+            StreamingScanner<long long> scanner(pool, type, std::plus<long long>(), 0LL,
+                                                kAutoThreads, mode);
+            std::vector<long long> streamed;
+            for (std::vector<long long>& chunk : split(input, {1, 70000, 3, 9999})) {
+                std::vector<long long> done = scanner.push(std::move(chunk));
+                streamed.insert(streamed.end(), done.begin(), done.end());
+            }
+            std::vector<long long> last = scanner.finish();
+            streamed.insert(streamed.end(), last.begin(), last.end());
+            EXPECT_EQ(expected, streamed);
+            EXPECT_EQ(input.size(), scanner.size());
+            EXPECT_EQ(std::accumulate(input.begin(), input.end(), 0LL), scanner.carry());
+            EXPECT_TRUE(scanner.finish().empty());
+        }
+    }
+}
+
+// Blocking Scan Test
+// This test verifies the blocking scan into caller storage with a custom
+// operation, mixed with pushes, and that reset starts a new stream.
+TEST(StreamingScanTest, BlockingScanAndReset) {
+    ThreadPool pool(3);
+    std::vector<long long> input = make_input(120000);
+    std::vector<long long> expected(input.size());
+    std::inclusive_scan(input.begin(), input.end(), expected.begin(),
+                        [](long long a, long long b) { return std::max(a, b); });
+
+    auto max_op = [](long long a, long long b) { return std::max(a, b); };
+    StreamingScanner<long long, decltype(max_op)> scanner(
+        pool, ScanType::Inclusive, max_op, std::numeric_limits<long long>::lowest(), 3);
+    std::vector<long long> output(input.size());
+    scanner.scan(input.begin(), input.begin() + 50000, output.begin());
+    std::vector<long long> pushed(input.begin() + 50000, input.begin() + 90000);
+    EXPECT_TRUE(scanner.push(std::move(pushed)).empty());
+    scanner.scan(input.begin() + 90000, input.end(), output.begin() + 90000);
+    pushed = scanner.finish();
+    std::copy(pushed.begin(), pushed.end(), output.begin() + 50000);
+    EXPECT_EQ(expected, output);
+
+    StreamingScanner<long long> sums(pool);
+    std::vector<long long> chunk = {1, 2, 3};
+    sums.scan(chunk);
+    sums.reset(100);
+    chunk = {1, 2, 3};
+    sums.scan(chunk);
+    EXPECT_EQ((std::vector<long long>{101, 103, 106}), chunk);
+    EXPECT_EQ(3u, sums.size());
+    sums.reset();
+    EXPECT_EQ(0, sums.carry());
+}
+
+// Overlap Test
+// This test compares the blocking stream (fill, then scan) with the pushed
+// stream, where filling the next chunk overlaps the scan of the previous one,
+// and with one scan of the whole input.
+TEST(StreamingScanTest, DoubleBufferingOverlap) {
+    const size_t total = size_t(1) << 23, chunk_size = size_t(1) << 19;
+    auto fill = [](std::vector<double>& chunk, size_t offset) {
+        chunk.resize(chunk_size);
+        for (size_t i = 0; i < chunk.size(); ++i) chunk[i] = static_cast<double>((offset + i) % 7);
+    };
+    double blocking_last = 0.0, pushed_last = 0.0;
+    double blocking = measure_time([&]() {
+        StreamingScanner<double> scanner;
+        std::vector<double> chunk;
+        for (size_t offset = 0; offset < total; offset += chunk_size) {
+            fill(chunk, offset);
+            scanner.scan(chunk);
+        }
+        blocking_last = chunk.back();
+    });
+    double pushed = measure_time([&]() {
+        StreamingScanner<double> scanner;
+        std::vector<double> chunk;
+        for (size_t offset = 0; offset < total; offset += chunk_size) {
+            fill(chunk, offset);
+            chunk = scanner.push(std::move(chunk));
+        }
+        pushed_last = scanner.finish().back();
+    });
+    std::vector<double> whole(total);
+    for (size_t i = 0; i < total; ++i) whole[i] = static_cast<double>(i % 7);
+    double whole_time = measure_time([&]() {
+        std::vector<double> output(total);
+        parallel_inclusive_scan_threads(whole, output);
+    });
+    EXPECT_EQ(blocking_last, pushed_last);
+
+    std::cout << "\nAverage execution times (ms) over 10 runs (2^23 doubles, chunks of 2^19):\n"
+              << "Fill then scan each chunk: " << blocking << " ms\n"
+              << "Fill while previous chunk is scanned: " << pushed << " ms\n"
+              << "Scan of the whole input (no fill): " << whole_time << " ms\n";
+}
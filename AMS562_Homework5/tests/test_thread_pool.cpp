@@ -0,0 +1,134 @@
+// tests/test_thread_pool.cpp
+
+// Overview:
+// This file contains unit tests for the persistent work-stealing thread pool
+// and for the pool-aware overloads of the threads-based primitives.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "thread_pool.hpp"
+#include "inner_product_threads.hpp"
+#include "inclusive_scan_threads.hpp"
+
+// Helper function for timing measurements
+// This function measures the average execution time of a given function over a specified number of runs.
+template<typename Func>
+double measure_time(Func&& func, int num_runs = 10) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_runs; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_time = std::chrono::duration<double, std::milli>(end - start).count();
+    return total_time / num_runs;
+}
+
+// Reference inner product that launches one std::async task per chunk, as the
+// threads backend did before the pool was introduced
+double async_inner_product(const std::vector<double>& a, const std::vector<double>& b,
+                           unsigned int num_threads) {
+    size_t chunk_size = (a.size() + num_threads - 1) / num_threads;
+    std::vector<std::future<double>> futures;
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        size_t start_idx = std::min(a.size(), i * chunk_size);
+        size_t end_idx = std::min(a.size(), start_idx + chunk_size);
+        futures.emplace_back(std::async(std::launch::async, [&, start_idx, end_idx]() {
+            return std::inner_product(a.begin() + start_idx, a.begin() + end_idx,
+                                      b.begin() + start_idx, 0.0);
+        }));
+    }
+    double result = 0.0;
+    for (auto& f : futures) {
+        result += f.get();
+    }
+    return result;
+}
+
+// Submit Test
+// This test verifies that submitted tasks run and return their results through futures.
+TEST(ThreadPoolTest, SubmitReturnsResults) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.submit([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(futures[i].get(), i * i);
+    }
+}
+
+// Parallel For Test
+// This test verifies that parallel_for runs every task index exactly once.
+TEST(ThreadPoolTest, ParallelForCoversAllIndices) {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> hits(1000);
+    pool.parallel_for(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+    for (const auto& h : hits) {
+        EXPECT_EQ(h.load(), 1);
+    }
+}
+
+// Nested Parallel For Test
+// This test verifies that a parallel_for issued from inside a pool task completes
+// even when every worker is busy.
+TEST(ThreadPoolTest, NestedParallelForDoesNotDeadlock) {
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    pool.parallel_for(8, [&](size_t) {
+        pool.parallel_for(8, [&](size_t) { total.fetch_add(1); });
+    });
+    EXPECT_EQ(total.load(), 64);
+}
+
+// Exception Test
+// This test verifies that an exception thrown by a task is rethrown to the caller.
+TEST(ThreadPoolTest, ParallelForPropagatesExceptions) {
+    ThreadPool pool(2);
+    EXPECT_THROW(pool.parallel_for(16, [](size_t i) {
+        if (i == 7) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    EXPECT_THROW(pool.submit([]() { throw std::runtime_error("task failed"); }).get(),
+                 std::runtime_error);
+}
+
+// Pool-aware Overload Test
+// This test verifies that the primitives produce correct results on an explicit pool.
+TEST(ThreadPoolTest, PoolAwareOverloads) {
+    ThreadPool pool(3);
+    std::vector<double> a(10007, 1.0);
+    std::vector<double> b(10007, 2.0);
+    EXPECT_DOUBLE_EQ(parallel_inner_product_threads(pool, a, b, 5), 2.0 * 10007);
+
+    std::vector<int> input(10007, 1);
+    std::vector<int> expected(10007);
+    std::vector<int> output;
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+    parallel_inclusive_scan_threads(pool, input, output, 5);
+    EXPECT_EQ(expected, output);
+}
+
+// Small Input Latency Test
+// This test compares the per-call latency of the pool against launching one
+// std::async task per chunk on a small input.
+TEST(ThreadPoolTest, SmallInputLatency) {
+    std::vector<double> a(1000, 1.0);
+    std::vector<double> b(1000, 2.0);
+    unsigned int num_threads = std::max(2u, std::thread::hardware_concurrency());
+
+    double async_time = measure_time([&]() { async_inner_product(a, b, num_threads); }, 100);
+    double pool_time = measure_time([&]() { parallel_inner_product_threads(a, b, num_threads); }, 100);
+
+    EXPECT_DOUBLE_EQ(parallel_inner_product_threads(a, b, num_threads), 2000.0);
+
+    // Print timing results
+    std::cout << "\nAverage execution times (ms) over 100 runs, n = 1000:\n"
+              << "std::async per chunk: " << async_time << " ms\n"
+              << "Thread pool: " << pool_time << " ms\n";
+}
@@ -0,0 +1,169 @@
+// tests/test_work_stealing.cpp
+
+// Overview:
+// This file contains unit tests for the work-stealing scheduler: the
+// Chase-Lev deque must hand every value to exactly one thread, spawn/sync
+// must support recursive fork-join and propagate exceptions, and the
+// inner product and scans ported onto the scheduler must match std, also while
+// a background thread competes for the cores.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "inclusive_scan_threads.hpp"
+#include "inner_product_threads.hpp"
+#include "stealing_primitives.hpp"
+#include "work_stealing.hpp"
+
+// Deque Test
+// This test verifies the owner's LIFO and the thieves' FIFO order, growth
+// past the initial capacity, and that under concurrent pops and steals every
+// value is taken exactly once.
+TEST(WorkStealingTest, ChaseLevDeque) {
+    ChaseLevDeque<int> deque(4);
+    for (int i = 0; i < 100; ++i) deque.push(i);
+    EXPECT_EQ(100u, deque.size());
+    int value = -1;
+    ASSERT_TRUE(deque.steal(value));
+    EXPECT_EQ(0, value);
+    ASSERT_TRUE(deque.pop(value));
+    EXPECT_EQ(99, value);
+    while (deque.pop(value)) {}
+    EXPECT_FALSE(deque.steal(value));
+
+    const int count = 200000;
+    ChaseLevDeque<int> shared;
+    std::vector<std::atomic<int>> taken(count);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&]() {
+            int v;
+            while (!done.load()) {
+                if (shared.steal(v)) taken[v].fetch_add(1);
+            }
+            while (shared.steal(v)) taken[v].fetch_add(1);
+        });
+    }
+    for (int i = 0; i < count; ++i) {
+        shared.push(i);
+        if (i % 3 == 0 && shared.pop(value)) taken[value].fetch_add(1);
+    }
+    while (shared.pop(value)) taken[value].fetch_add(1);
+    done.store(true);
+    for (std::thread& thief : thieves) thief.join();
+    for (int i = 0; i < count; ++i) ASSERT_EQ(1, taken[i].load()) << i;
+}
+
+// Helper that computes Fibonacci numbers by recursive fork-join
+long long fib(WorkStealingScheduler& scheduler, int n) {
+    if (n < 15) {
+        long long a = 0, b = 1;
+        for (int i = 0; i < n; ++i) b = std::exchange(a, b) + b;
+        return a;
+    }
+    long long left = 0;
+    TaskGroup group(scheduler);
+    group.spawn([&]() { left = fib(scheduler, n - 1); });
+    long long right = fib(scheduler, n - 2);
+    group.sync();
+    return left + right;
+}
+
+// Fork-Join Test
+// This test verifies recursive spawn/sync, parallel_range coverage and
+// exception propagation, on schedulers of one and several workers.
+TEST(WorkStealingTest, SpawnAndSync) {
+    for (unsigned int workers : {1u, 4u}) {
+        WorkStealingScheduler scheduler(workers);
+        EXPECT_EQ(832040, fib(scheduler, 30)) << workers << " workers";
+
+        std::vector<std::atomic<int>> hits(100003);
+        scheduler.parallel_range(hits.size(), 7, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+        });
+        for (const std::atomic<int>& hit : hits) ASSERT_EQ(1, hit.load());
+
+        TaskGroup group(scheduler);
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 50; ++i) {
+            group.spawn([&, i]() {
+                ran.fetch_add(1);
+                if (i == 17) throw std::runtime_error("task failed");
+            });
+        }
+        EXPECT_THROW(group.sync(), std::runtime_error);
+        EXPECT_EQ(50, ran.load());
+        group.sync();  // the error is reported once
+    }
+}
+
+// Ported Primitives Test
+// This test verifies the inner product (every accumulation mode) and the
+// scans on the scheduler against std, for several grains.
+TEST(WorkStealingTest, PrimitivesMatchStd) {
+    WorkStealingScheduler scheduler(3);
+    std::vector<long long> a(1000003), b(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<long long>(i % 13) - 6;
+        b[i] = static_cast<long long>(i % 7);
+    }
+    long long expected_dot = std::inner_product(a.begin(), a.end(), b.begin(), 0LL);
+    std::vector<long long> expected_scan(a.size()), expected_exclusive(a.size());
+    std::inclusive_scan(a.begin(), a.end(), expected_scan.begin());
+    std::exclusive_scan(a.begin(), a.end(), expected_exclusive.begin(), 0LL);
+
+    for (size_t grain : {kAutoGrain, size_t(1000), size_t(5000000)}) {
+        EXPECT_EQ(expected_dot, parallel_inner_product_stealing(scheduler, a, b, grain));
+        std::vector<long long> out;
+        parallel_inclusive_scan_stealing(scheduler, a, out, grain);
+        EXPECT_EQ(expected_scan, out) << grain;
+        parallel_exclusive_scan_stealing(scheduler, a.begin(), a.end(), out.begin(), grain);
+        EXPECT_EQ(expected_exclusive, out) << grain;
+    }
+
+    std::vector<double> x(300000), y(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = 1.0 / static_cast<double>(i + 1);
+        y[i] = (i % 2 == 0 ? 1.0 : -1.0) * 1e8 / static_cast<double>(i % 97 + 1);
+    }
+    EXPECT_EQ(parallel_inner_product_threads(x, y, 3, AccumulationMode::Reproducible),
+              parallel_inner_product_stealing(scheduler, x, y, 20000, AccumulationMode::Reproducible));
+    EXPECT_NEAR(parallel_inner_product_threads(x, y, 1, AccumulationMode::Compensated),
+                parallel_inner_product_stealing(scheduler, x, y, kAutoGrain, AccumulationMode::Compensated),
+                1e-6);
+    EXPECT_THROW(parallel_inner_product_stealing(scheduler, x, std::vector<double>(3)),
+                 std::invalid_argument);
+}
+
+// Contention Test
+// This test verifies that the stealing backend still matches the threads
+// backend and std while a background thread spins and workers lose their
+// core; the timings under contention live in the contended/ benchmarks.
+TEST(WorkStealingTest, MatchesUnderContention) {
+    std::vector<double> a(1 << 18, 1.0), b(a.size(), 0.5), out(a.size());
+    ThreadPool pool(3);
+    WorkStealingScheduler scheduler(3);
+
+    std::atomic<bool> stop{false};
+    std::thread noise([&]() {
+        volatile unsigned long spin = 0;
+        while (!stop.load(std::memory_order_relaxed)) ++spin;
+    });
+    double threads_dot = parallel_inner_product_threads(pool, a, b, 4);
+    double stealing_dot = parallel_inner_product_stealing(scheduler, a, b, 1000);
+    parallel_inclusive_scan_stealing(scheduler, a, out, 1000);
+    stop.store(true);
+    noise.join();
+
+    EXPECT_DOUBLE_EQ(0.5 * static_cast<double>(a.size()), threads_dot);
+    EXPECT_DOUBLE_EQ(threads_dot, stealing_dot);
+    for (size_t i = 0; i < out.size(); ++i) {
+        ASSERT_DOUBLE_EQ(static_cast<double>(i + 1), out[i]) << i;
+    }
+}